@@ -0,0 +1,60 @@
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <cstddef>
+
+// Eigen alloue ses matrices avec malloc (et non avec new), on intercepte
+// donc directement malloc/calloc/realloc. Les versions de la glibc sont
+// appelées ensuite, free n'a donc pas besoin d'être remplacé. Le compteur
+// est propre à chaque thread : les écritures faites en parallèle par le
+// thread de sauvegarde ne sont pas comptées dans la boucle en temps.
+#if defined(DEBUG) && defined(__GLIBC__)
+#define ALLOCATION_COUNTER_ENABLED 1
+
+static thread_local long allocationCount(0);
+
+extern "C"
+{
+  void* __libc_malloc(std::size_t size);
+  void* __libc_calloc(std::size_t n, std::size_t size);
+  void* __libc_realloc(void* ptr, std::size_t size);
+
+  void* malloc(std::size_t size)
+  {
+    ++allocationCount;
+    return __libc_malloc(size);
+  }
+
+  void* calloc(std::size_t n, std::size_t size)
+  {
+    ++allocationCount;
+    return __libc_calloc(n, size);
+  }
+
+  void* realloc(void* ptr, std::size_t size)
+  {
+    ++allocationCount;
+    return __libc_realloc(ptr, size);
+  }
+}
+#else
+#define ALLOCATION_COUNTER_ENABLED 0
+#endif
+
+
+
+long AllocationCounter::getCount()
+{
+#if ALLOCATION_COUNTER_ENABLED
+  return allocationCount;
+#else
+  return 0;
+#endif
+}
+
+
+
+bool AllocationCounter::isEnabled()
+{
+  return ALLOCATION_COUNTER_ENABLED;
+}
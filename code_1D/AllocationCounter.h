@@ -0,0 +1,19 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+
+
+// Compteur des allocations sur le tas. Il n'est actif qu'en mode debug
+// (compilé avec -DDEBUG) et sert à vérifier que la boucle en temps
+// n'alloue pas de mémoire. Hors mode debug, getCount() renvoie toujours 0.
+class AllocationCounter
+{
+public:
+  // Nombre d'allocations effectuées par le thread courant depuis son début
+  static long getCount();
+
+  // Vaut true si le compteur est actif
+  static bool isEnabled();
+};
+
+#endif // ALLOCATION_COUNTER_H
@@ -0,0 +1,195 @@
+#include "Checkpoint.h"
+#include "termcolor.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+
+// En-tête du fichier, à changer à chaque modification de son contenu
+static const char checkpointMagic[8] = {'T', 'E', 'R', '1', 'D', 'C', 'K', 'P'};
+static const std::uint32_t checkpointVersion = 4;
+
+
+
+// Arrête le programme en cas d'erreur sur le fichier
+static void checkpointError(const std::string& message, const std::string& fileName)
+{
+  std::cout << termcolor::red << "ERROR::CHECKPOINT : " << message << " " << fileName << std::endl;
+  std::cout << termcolor::reset;
+  exit(-1);
+}
+
+
+
+Checkpoint::Checkpoint():
+  _position(0)
+{
+}
+
+
+
+void Checkpoint::putBytes(const void* data, std::size_t size)
+{
+  const char* p(static_cast<const char*>(data));
+  _buffer.insert(_buffer.end(), p, p + size);
+}
+
+
+
+void Checkpoint::putString(const std::string& value)
+{
+  put<long long>(value.size());
+  putBytes(value.data(), value.size());
+}
+
+
+
+void Checkpoint::putMatrix(const StateMatrix& matrix)
+{
+  put<long long>(matrix.rows());
+  put<long long>(matrix.cols());
+  put<int>(StateMatrix::IsRowMajor);
+  putBytes(matrix.data(), matrix.size() * sizeof(double));
+}
+
+
+
+void Checkpoint::checkRemaining(std::size_t size) const
+{
+  if (_position + size > _buffer.size())
+    {
+      checkpointError("Truncated checkpoint file", _fileName);
+    }
+}
+
+
+
+void Checkpoint::getBytes(void* data, std::size_t size)
+{
+  checkRemaining(size);
+  std::memcpy(data, _buffer.data() + _position, size);
+  _position += size;
+}
+
+
+
+std::string Checkpoint::getString()
+{
+  std::size_t size(get<long long>());
+  checkRemaining(size);
+  std::string value(_buffer.data() + _position, size);
+  _position += size;
+  return value;
+}
+
+
+
+void Checkpoint::getMatrix(StateMatrix& matrix)
+{
+  long long rows(get<long long>()), cols(get<long long>());
+  int isRowMajor(get<int>());
+  if (cols != matrix.cols() || isRowMajor != StateMatrix::IsRowMajor)
+    {
+      checkpointError("Wrong number of variables or storage layout in", _fileName);
+    }
+  matrix.resize(rows, cols);
+  getBytes(matrix.data(), matrix.size() * sizeof(double));
+}
+
+
+
+void Checkpoint::save(const std::string& fileName) const
+{
+  std::string tmpFileName(fileName + ".tmp");
+  FILE* file(std::fopen(tmpFileName.c_str(), "wb"));
+  if (file == 0)
+    {
+      checkpointError("Unable to open file", tmpFileName);
+    }
+  std::uint64_t size(_buffer.size());
+  bool ok(std::fwrite(checkpointMagic, 1, sizeof(checkpointMagic), file) == sizeof(checkpointMagic));
+  ok = ok && std::fwrite(&checkpointVersion, sizeof(checkpointVersion), 1, file) == 1;
+  ok = ok && std::fwrite(&size, sizeof(size), 1, file) == 1;
+  ok = ok && std::fwrite(_buffer.data(), 1, _buffer.size(), file) == _buffer.size();
+  // Le contenu doit être sur le disque avant le renommage
+  ok = ok && std::fflush(file) == 0 && fsync(fileno(file)) == 0;
+  ok = (std::fclose(file) == 0) && ok;
+  if (!ok || std::rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+    {
+      checkpointError("Unable to write checkpoint", fileName);
+    }
+}
+
+
+
+void Checkpoint::load(const std::string& fileName)
+{
+  _fileName = fileName;
+  FILE* file(std::fopen(fileName.c_str(), "rb"));
+  if (file == 0)
+    {
+      checkpointError("Unable to open file", fileName);
+    }
+  char magic[8];
+  std::uint32_t version(0);
+  std::uint64_t size(0);
+  bool ok(std::fread(magic, 1, sizeof(magic), file) == sizeof(magic) && std::memcmp(magic, checkpointMagic, sizeof(magic)) == 0);
+  if (!ok)
+    {
+      checkpointError("Not a 1D checkpoint file :", fileName);
+    }
+  ok = std::fread(&version, sizeof(version), 1, file) == 1 && version == checkpointVersion;
+  if (!ok)
+    {
+      checkpointError("Unsupported checkpoint version in", fileName);
+    }
+  ok = std::fread(&size, sizeof(size), 1, file) == 1;
+  _buffer.resize(size);
+  ok = ok && std::fread(_buffer.data(), 1, size, file) == size;
+  std::fclose(file);
+  if (!ok)
+    {
+      checkpointError("Truncated checkpoint file", fileName);
+    }
+  _position = 0;
+}
+
+
+
+long long fileSize(const std::string& fileName)
+{
+  struct stat status;
+  if (stat(fileName.c_str(), &status) != 0)
+    return 0;
+  return status.st_size;
+}
+
+
+
+void truncateFile(const std::string& fileName, long long size)
+{
+  if (truncate(fileName.c_str(), size) != 0)
+    {
+      checkpointError("Unable to restore the size of", fileName);
+    }
+}
+
+
+
+unsigned long long stringHash(const std::string& value)
+{
+  unsigned long long hash(14695981039346656037ULL);
+  for (std::size_t i(0) ; i < value.size() ; ++i)
+    {
+      hash ^= static_cast<unsigned char>(value[i]);
+      hash *= 1099511628211ULL;
+    }
+  return hash;
+}
@@ -4,21 +4,34 @@
 #include <sstream>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
 #include <regex>
 
-DataFile::DataFile()
+DataFile::DataFile():
+  _nProbes(0), _probeSampling(0), _outputFormat("Text"), _binaryPrecision(64), _checkpointInterval(0.),
+  _rungeKuttaStages(4), _isAdaptiveTimeStep(false), _boundaryDataInterpolation("Linear")
 {
 }
 
 DataFile::DataFile(const std::string& fileName):
-  _fileName(fileName), _initialCondition("none")
+  _fileName(fileName), _nProbes(0), _probeSampling(0), _outputFormat("Text"), _binaryPrecision(64), _checkpointInterval(0.),
+  _initialCondition("none"), _rungeKuttaStages(4), _isAdaptiveTimeStep(false), _boundaryDataInterpolation("Linear")
 {
 }
 
 void DataFile::Initialize(const std::string& fileName)
 {
   _fileName = fileName;
+  _nProbes = 0;
+  _probeSampling = 0;
+  _outputFormat = "Text";
+  _binaryPrecision = 64;
+  _checkpointInterval = 0.;
+  _restartFile = "";
   _initialCondition = "none";  
+  _rungeKuttaStages = 4;
+  _isAdaptiveTimeStep = false;
+  _boundaryDataInterpolation = "Linear";
 }
 
 std::string DataFile::cleanLine(std::string &line)
@@ -88,6 +101,22 @@ void DataFile::readDataFile()
               dataFile >> _probesReferences[i] >> _probesPositions[i];
             }
         }
+      if (proper_line.find("ProbeSampling") != std::string::npos)
+        {
+          dataFile >> _probeSampling;
+        }
+      if (proper_line.find("OutputFormat") != std::string::npos)
+        {
+          dataFile >> _outputFormat;
+        }
+      if (proper_line.find("BinaryPrecision") != std::string::npos)
+        {
+          dataFile >> _binaryPrecision;
+        }
+      if (proper_line.find("CheckpointInterval") != std::string::npos)
+        {
+          dataFile >> _checkpointInterval;
+        }
       if (proper_line.find("IsTestCase") != std::string::npos)
         {
           dataFile >> _isTestCase;
@@ -136,6 +165,10 @@ void DataFile::readDataFile()
         {
           dataFile >> _timeScheme;
         }
+      if (proper_line.find("RungeKuttaStages") != std::string::npos)
+        {
+          dataFile >> _rungeKuttaStages;
+        }
       if (proper_line.find("InitialTime") != std::string::npos)
         {
           dataFile >> _initialTime;
@@ -152,6 +185,10 @@ void DataFile::readDataFile()
         {
           dataFile >> _CFL;
         }
+      if (proper_line.find("AdaptiveStepping") != std::string::npos)
+        {
+          dataFile >> _isAdaptiveTimeStep;
+        }
       if (proper_line.find("GravityAcceleration") != std::string::npos)
         {
           dataFile >> _g;
@@ -188,6 +225,10 @@ void DataFile::readDataFile()
         {
           dataFile >> _rightBCDataFile;
         }
+      if (proper_line.find("BoundaryDataInterpolation") != std::string::npos)
+        {
+          dataFile >> _boundaryDataInterpolation;
+        }
       if (proper_line.find("IsTopography") != std::string::npos)
         {
           dataFile >> _isTopography;
@@ -213,8 +254,12 @@ void DataFile::readDataFile()
 #endif
   
   system(("mkdir -p ./" +_resultsDir).c_str());
-  system(("rm -f ./" +_resultsDir + "/solution*").c_str());
-  system(("rm -f ./" +_resultsDir + "/probe_*").c_str());
+  // En reprise, les résultats déjà écrits sont gardés
+  if (!isRestart())
+    {
+      system(("rm -f ./" +_resultsDir + "/solution*").c_str());
+      system(("rm -f ./" +_resultsDir + "/probe*").c_str());
+    }
   system(("cp -r ./" + _fileName + " ./" + _resultsDir + "/parameters.txt").c_str());
 
   // Logs
@@ -246,6 +291,9 @@ void DataFile::readDataFile()
   std::cout << termcolor::magenta << "New value : dx = " << _dx << std::endl;
   std::cout << termcolor::reset;
 #endif
+
+  // Conversion des options en énumérations
+  buildRunPlan();
   
   // Logs de succès
 #if VERBOSITY>0
@@ -255,6 +303,173 @@ void DataFile::readDataFile()
 }
 
 
+void DataFile::setScheme(double dx, const std::string& numericalFlux, int schemeOrder)
+{
+  _numericalFlux = numericalFlux;
+  _schemeOrder = schemeOrder;
+  _Nx = int(ceil((_xmax - _xmin)/dx));
+  _dx = (_xmax - _xmin)/_Nx;
+  buildRunPlan();
+}
+
+
+// Arrête le programme si une option a une valeur inconnue
+static void unknownOption(const std::string& option, const std::string& value)
+{
+  std::cout << termcolor::red << "ERROR::DATAFILE : Case not implemented for " << option << " : " << value << std::endl;
+  std::cout << termcolor::reset;
+  exit(-1);
+}
+
+
+
+// Convertit une condition aux limites en énumération
+static BoundaryConditionType boundaryConditionType(const std::string& option, const std::string& value)
+{
+  if (value == "Neumann")
+    return BoundaryConditionType::Neumann;
+  else if (value == "Wall")
+    return BoundaryConditionType::Wall;
+  else if (value == "ImposedConstantHeight")
+    return BoundaryConditionType::ImposedConstantHeight;
+  else if (value == "ImposedConstantDischarge")
+    return BoundaryConditionType::ImposedConstantDischarge;
+  else if (value == "DataFile")
+    return BoundaryConditionType::DataFile;
+  else if (value == "PeriodicWaves")
+    return BoundaryConditionType::PeriodicWaves;
+  unknownOption(option, value);
+  return BoundaryConditionType::Neumann;
+}
+
+
+
+// Construit le plan de la simulation à partir des paramètres lus. Toutes
+// les options sous forme de chaînes de caractères sont vérifiées ici, une
+// seule fois, pour que le solveur n'ait plus à les comparer.
+void DataFile::buildRunPlan()
+{
+  // Numerical flux
+  if (_numericalFlux == "LaxFriedrichs")
+    _runPlan.numericalFlux = NumericalFluxType::LaxFriedrichs;
+  else if (_numericalFlux == "Rusanov")
+    _runPlan.numericalFlux = NumericalFluxType::Rusanov;
+  else if (_numericalFlux == "HLL")
+    _runPlan.numericalFlux = NumericalFluxType::HLL;
+  else
+    unknownOption("NumericalFlux", _numericalFlux);
+
+  // Order
+  if (_schemeOrder != 1 && _schemeOrder != 2)
+    unknownOption("Order", std::to_string(_schemeOrder));
+  _runPlan.schemeOrder = _schemeOrder;
+
+  // Time scheme
+  if (_timeScheme == "ExplicitEuler")
+    _runPlan.timeScheme = TimeSchemeType::ExplicitEuler;
+  else if (_timeScheme == "RK2")
+    _runPlan.timeScheme = TimeSchemeType::RK2;
+  else if (_timeScheme == "SSPRK3")
+    _runPlan.timeScheme = TimeSchemeType::SSPRK3;
+  else if (_timeScheme == "SSPRKs2")
+    _runPlan.timeScheme = TimeSchemeType::SSPRKs2;
+  else
+    unknownOption("TimeScheme", _timeScheme);
+  if (_rungeKuttaStages < 2)
+    unknownOption("RungeKuttaStages", std::to_string(_rungeKuttaStages));
+  _runPlan.rungeKuttaStages = _rungeKuttaStages;
+
+  // Numerical values
+  _runPlan.timeStep = _timeStep;
+  _runPlan.isAdaptiveTimeStep = _isAdaptiveTimeStep;
+  _runPlan.CFL = _CFL;
+  _runPlan.dx = _dx;
+  _runPlan.xmin = _xmin;
+  _runPlan.xmax = _xmax;
+  _runPlan.g = _g;
+  _runPlan.isSaveFinalTimeOnly = _isSaveFinalTimeOnly;
+  _runPlan.saveFrequency = _saveFrequency;
+  _runPlan.probeSampling = (_probeSampling > 0 ? _probeSampling : std::max(1, _saveFrequency/10));
+  if (_nProbes == 0)
+    _runPlan.probeSampling = 0;
+
+  // Output format
+  if (_outputFormat == "Text")
+    _runPlan.outputFormat = OutputFormatType::Text;
+  else if (_outputFormat == "Binary")
+    _runPlan.outputFormat = OutputFormatType::Binary;
+  else
+    unknownOption("OutputFormat", _outputFormat);
+  if (_binaryPrecision != 32 && _binaryPrecision != 64)
+    unknownOption("BinaryPrecision", std::to_string(_binaryPrecision));
+  _runPlan.binaryValueSize = _binaryPrecision/8;
+  _runPlan.checkpointInterval = _checkpointInterval;
+
+  // Test case
+  if (_testCase == "None")
+    _runPlan.testCase = TestCaseType::None;
+  else if (_testCase == "RestingLake")
+    _runPlan.testCase = TestCaseType::RestingLake;
+  else if (_testCase == "SubcriticalFlow")
+    _runPlan.testCase = TestCaseType::SubcriticalFlow;
+  else if (_testCase == "TranscriticalFlowWithoutShock")
+    _runPlan.testCase = TestCaseType::TranscriticalFlowWithoutShock;
+  else if (_testCase == "TranscriticalFlowWithShock")
+    _runPlan.testCase = TestCaseType::TranscriticalFlowWithShock;
+  else if (_testCase == "DamBreakWet")
+    _runPlan.testCase = TestCaseType::DamBreakWet;
+  else if (_testCase == "DamBreakDry")
+    _runPlan.testCase = TestCaseType::DamBreakDry;
+  else if (_testCase == "Thacker")
+    _runPlan.testCase = TestCaseType::Thacker;
+  else
+    unknownOption("WhichTestCase", _testCase);
+
+  // Initial condition
+  if (_initialCondition == "UniformHeightAndDischarge")
+    _runPlan.initialCondition = InitialConditionType::UniformHeightAndDischarge;
+  else if (_initialCondition == "DamBreakWet")
+    _runPlan.initialCondition = InitialConditionType::DamBreakWet;
+  else if (_initialCondition == "DamBreakDry")
+    _runPlan.initialCondition = InitialConditionType::DamBreakDry;
+  else if (_initialCondition == "Thacker")
+    _runPlan.initialCondition = InitialConditionType::Thacker;
+  else if (_initialCondition == "SinePerturbation")
+    _runPlan.initialCondition = InitialConditionType::SinePerturbation;
+  else if (_initialCondition == "File")
+    _runPlan.initialCondition = InitialConditionType::File;
+  else
+    unknownOption("InitialCondition", _initialCondition);
+
+  // Topography
+  if (_topographyType == "FlatBottom")
+    _runPlan.topography = TopographyType::FlatBottom;
+  else if (_topographyType == "Bump")
+    _runPlan.topography = TopographyType::Bump;
+  else if (_topographyType == "Thacker")
+    _runPlan.topography = TopographyType::Thacker;
+  else if (_topographyType == "File")
+    _runPlan.topography = TopographyType::File;
+  else
+    unknownOption("TopographyType", _topographyType);
+
+  // Boundary conditions
+  _runPlan.leftBC = boundaryConditionType("LeftBoundaryCondition", _leftBC);
+  _runPlan.rightBC = boundaryConditionType("RightBoundaryCondition", _rightBC);
+  _runPlan.leftBCImposedHeight = _leftBCImposedHeight;
+  _runPlan.leftBCImposedDischarge = _leftBCImposedDischarge;
+  _runPlan.rightBCImposedHeight = _rightBCImposedHeight;
+  _runPlan.rightBCImposedDischarge = _rightBCImposedDischarge;
+  if (_boundaryDataInterpolation == "Linear")
+    _runPlan.boundaryDataInterpolation = InterpolationType::Linear;
+  else if (_boundaryDataInterpolation == "Cubic")
+    _runPlan.boundaryDataInterpolation = InterpolationType::Cubic;
+  else
+    unknownOption("BoundaryDataInterpolation", _boundaryDataInterpolation);
+}
+
+
+
 // Affiche les paramètres sur le terminal
 void DataFile::printData() const
 {
@@ -282,21 +497,38 @@ void DataFile::printData() const
   std::cout << "Numerical Flux       = " << _numericalFlux << std::endl;
   std::cout << "Order                = " << _schemeOrder << std::endl;
   std::cout << "Time Scheme          = " << _timeScheme << std::endl;
+  if (_timeScheme == "SSPRKs2")
+    std::cout << "  |Stages            = " << _rungeKuttaStages << std::endl;
   std::cout << "Initial time         = " << _initialTime << std::endl;
   std::cout << "Final time           = " << _finalTime << std::endl;
   std::cout << "Time step            = " << _timeStep << std::endl;
+  std::cout << "Adaptive time step   = " << _isAdaptiveTimeStep << std::endl;
+  if (_isAdaptiveTimeStep)
+    std::cout << "   |CFL              = " << _CFL << std::endl;
   std::cout << "Gravity              = " << _g << std::endl;
   std::cout << "Results directory    = " << _resultsDir << std::endl;
   std::cout << "SaveFinalTimeOnly    = " << _isSaveFinalTimeOnly << std::endl;
   if (!_isSaveFinalTimeOnly)
     std::cout << "Save Frequency       = " << _saveFrequency << std::endl;
+  std::cout << "Output format        = " << _outputFormat << std::endl;
+  if (_outputFormat == "Binary")
+    std::cout << "   |Precision        = " << _binaryPrecision << " bits" << std::endl;
+  if (_checkpointInterval > 0)
+    std::cout << "Checkpoint interval  = " << _checkpointInterval << " s" << std::endl;
+  if (isRestart())
+    std::cout << "Restart from         = " << _restartFile << std::endl;
   
   std::cout << "Number of probes     = " << _nProbes << std::endl;
   for (int i(0) ; i < _nProbes ; ++i)
     std::cout << "   |Position probe " << _probesReferences[i] << " = " << _probesPositions[i] << std::endl;
+  if (_nProbes > 0)
+    std::cout << "Probe sampling       = " << (_probeSampling > 0 ? _probeSampling : std::max(1, _saveFrequency/10)) << std::endl;
   std::cout << "LeftBC               = " << _leftBC << std::endl;
   if (_leftBC == "DataFile")
+    {
       std::cout << "   |LeftBCFile       = " << _leftBCDataFile << std::endl;
+      std::cout << "   |Interpolation    = " << _boundaryDataInterpolation << std::endl;
+    }
   if (_leftBC == "ImposedConstantHeight")
     {
       std::cout << "   |ImposedHeight    = " << _leftBCImposedHeight << std::endl;
@@ -309,7 +541,10 @@ void DataFile::printData() const
     }
   std::cout << "RightBC              = " << _rightBC << std::endl;
   if (_rightBC == "DataFile")
-    std::cout << "   |RightBCFile      = " << _rightBCDataFile << std::endl;
+    {
+      std::cout << "   |RightBCFile      = " << _rightBCDataFile << std::endl;
+      std::cout << "   |Interpolation    = " << _boundaryDataInterpolation << std::endl;
+    }
   if (_rightBC == "ImposedConstantHeight")
     {
       std::cout << "   |ImposedHeight    = " << _rightBCImposedHeight << std::endl;
@@ -7,6 +7,65 @@
 
 
 
+// Options du fichier de paramètres, converties une seule fois en
+// énumérations après la lecture du fichier (voir RunPlan).
+enum class NumericalFluxType {LaxFriedrichs, Rusanov, HLL};
+enum class TimeSchemeType {ExplicitEuler, RK2, SSPRK3, SSPRKs2};
+enum class BoundaryConditionType {Neumann, Wall, ImposedConstantHeight, ImposedConstantDischarge, DataFile, PeriodicWaves};
+enum class TopographyType {FlatBottom, Bump, Thacker, File};
+enum class InitialConditionType {UniformHeightAndDischarge, DamBreakWet, DamBreakDry, Thacker, SinePerturbation, File};
+enum class OutputFormatType {Text, Binary};
+enum class InterpolationType {Linear, Cubic};
+enum class TestCaseType {None, RestingLake, SubcriticalFlow, TranscriticalFlowWithoutShock, TranscriticalFlowWithShock, DamBreakWet, DamBreakDry, Thacker};
+
+
+
+// Plan de la simulation : toutes les options sous forme d'énumérations et
+// les valeurs numériques utilisées pendant la boucle en temps. Il est
+// construit une fois par DataFile::readDataFile, puis copié par les objets
+// du solveur qui n'ont ainsi plus besoin de comparer des chaînes de
+// caractères ni d'appeler les getters du DataFile.
+struct RunPlan
+{
+  // Schéma numérique
+  NumericalFluxType numericalFlux;
+  int schemeOrder;
+  TimeSchemeType timeScheme;
+  // Nombre d'étages de SSPRKs2
+  int rungeKuttaStages;
+  double timeStep;
+  bool isAdaptiveTimeStep;
+  double CFL;
+  double dx;
+  double xmin, xmax;
+  double g;
+
+  // Sauvegarde des résultats
+  bool isSaveFinalTimeOnly;
+  int saveFrequency;
+  // Enregistrement des sondes tous les probeSampling pas de temps (0 = jamais)
+  int probeSampling;
+  // Fichiers texte ou fichier binaire unique, taille des valeurs (4 ou 8 octets)
+  OutputFormatType outputFormat;
+  int binaryValueSize;
+  // Point de reprise toutes les checkpointInterval secondes (0 = jamais)
+  double checkpointInterval;
+
+  // Scénario
+  TestCaseType testCase;
+  InitialConditionType initialCondition;
+  TopographyType topography;
+
+  // Conditions aux limites
+  BoundaryConditionType leftBC, rightBC;
+  double leftBCImposedHeight, leftBCImposedDischarge;
+  double rightBCImposedHeight, rightBCImposedDischarge;
+  // Interpolation des données expérimentales (conditions DataFile)
+  InterpolationType boundaryDataInterpolation;
+};
+
+
+
 class DataFile
 {
 private:
@@ -21,6 +80,14 @@ private:
   int _nProbes;
   std::vector<int> _probesReferences;
   std::vector<double> _probesPositions;
+  // Probes sampling (in number of time steps, 0 = max(1, SaveFrequency/10))
+  int _probeSampling;
+  // Output format (Text = one solution_*.txt per save, Binary = a single file)
+  std::string _outputFormat;
+  int _binaryPrecision;
+  // Checkpoints (wall-clock interval in seconds, 0 = none) and restart file
+  double _checkpointInterval;
+  std::string _restartFile;
   
   // Test cases
   bool _isTestCase;
@@ -42,10 +109,13 @@ private:
   
   // Time parameters
   std::string _timeScheme;
+  // Number of stages of SSPRKs2 (s >= 2)
+  int _rungeKuttaStages;
   double _initialTime;
   double _finalTime;
   double _timeStep;
   double _CFL;
+  bool _isAdaptiveTimeStep;
 
   // Gravity Acceleration
   double _g;
@@ -53,12 +123,17 @@ private:
   // Boundary conditions
   std::string _leftBC, _rightBC;
   std::string _leftBCDataFile, _rightBCDataFile;
+  // Interpolation of the experimental data in time (Linear or Cubic)
+  std::string _boundaryDataInterpolation;
   double _leftBCImposedHeight, _leftBCImposedDischarge, _rightBCImposedHeight, _rightBCImposedDischarge;
   
   // Topography
   bool _isTopography;
   std::string _topographyType;
   std::string _topographyFile;
+
+  // Options résolues
+  RunPlan _runPlan;
   
 public:
   // Constructeurs
@@ -71,12 +146,23 @@ public:
   // Initialise l'objet
   void Initialize(const std::string& fileName);
   
+  // Reprise du calcul depuis un point de reprise (avant readDataFile)
+  void setRestartFile(const std::string& restartFile) {_restartFile = restartFile;};
+
   // Lit le fichier
   void readDataFile();
 
   // Nettoyer une ligne du fichier
   std::string cleanLine(std::string &line);
 
+  // Convertit les options en énumérations (appelé par readDataFile)
+  void buildRunPlan();
+
+  // Change le schéma après la lecture du fichier (études de convergence) :
+  // dx est ajusté au domaine comme dans readDataFile et le plan reconstruit
+  void setScheme(double dx, const std::string& numericalFlux, int schemeOrder);
+  void setResultsDirectory(const std::string& resultsDir) {_resultsDir = resultsDir;};
+
   // Getters
   // Data file name
   const std::string& getFileName() const {return _fileName;};
@@ -87,6 +173,12 @@ public:
   int getNumberOfProbes() const {return _nProbes;};
   const std::vector<int>& getProbesReferences() const {return _probesReferences;};
   const std::vector<double>& getProbesPositions() const {return _probesPositions;};
+  int getProbeSampling() const {return _probeSampling;};
+  const std::string& getOutputFormat() const {return _outputFormat;};
+  int getBinaryPrecision() const {return _binaryPrecision;};
+  double getCheckpointInterval() const {return _checkpointInterval;};
+  const std::string& getRestartFile() const {return _restartFile;};
+  bool isRestart() const {return !_restartFile.empty();};
   // Test cases
   bool isTestCase() const {return _isTestCase;};
   const std::string& getTestCase() const {return _testCase;};
@@ -105,10 +197,12 @@ public:
   int getSchemeOrder() const {return _schemeOrder;};
   // Time scheme related
   const std::string& getTimeScheme() const {return _timeScheme;};
+  int getRungeKuttaStages() const {return _rungeKuttaStages;};
   double getInitialTime() const {return _initialTime;};
   double getFinalTime() const {return _finalTime;};
   double getTimeStep() const {return _timeStep;};
   double getCFL() const {return _CFL;};
+  bool isAdaptiveTimeStep() const {return _isAdaptiveTimeStep;};
   // Gravity related
   double getGravityAcceleration() const {return _g;};
   // Boundary conditions related
@@ -116,6 +210,7 @@ public:
   const std::string& getRightBC() const {return _rightBC;};
   const std::string& getLeftBCDataFile() const {return _leftBCDataFile;};
   const std::string& getRightBCDataFile() const {return _rightBCDataFile;};
+  const std::string& getBoundaryDataInterpolation() const {return _boundaryDataInterpolation;};
   double getLeftBCImposedHeight() const {return _leftBCImposedHeight;};
   double getLeftBCImposedDischarge() const {return _leftBCImposedDischarge;};
   double getRightBCImposedHeight() const {return _rightBCImposedHeight;};
@@ -124,6 +219,8 @@ public:
   bool isTopography() const {return _isTopography;};
   const std::string& getTopographyType() const {return _topographyType;};
   const std::string& getTopographyFile() const {return _topographyFile;};
+  // Resolved options
+  const RunPlan& getRunPlan() const {return _runPlan;};
   
   // Affichage des paramètres
   void printData() const;
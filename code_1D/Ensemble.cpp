@@ -0,0 +1,345 @@
+#include "Ensemble.h"
+#include "DataFile.h"
+#include "Mesh.h"
+#include "Physics.h"
+#include "FiniteVolume.h"
+#include "SolutionFile.h"
+#include "TextFormat.h"
+#include "Profiler.h"
+#include "termcolor.h"
+
+#include "Eigen/Eigen/Dense"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+
+Ensemble::Ensemble(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol):
+  _DF(DF), _mesh(mesh), _physics(physics), _finVol(finVol), _plan(DF->getRunPlan()), _nMembers(0), _timeStep(DF->getTimeStep()), _initialTime(DF->getInitialTime()), _finalTime(DF->getFinalTime()), _currentTime(_initialTime)
+{
+  if (_plan.isAdaptiveTimeStep)
+    {
+      std::cout << termcolor::red << "ERROR::ENSEMBLE : The members of an ensemble share the same time step, AdaptiveStepping must be 0." << std::endl;
+      std::cout << termcolor::reset;
+      exit(-1);
+    }
+  if (_plan.outputFormat != OutputFormatType::Text)
+    {
+      std::cout << termcolor::yellow << "WARNING::ENSEMBLE : The solutions of the members are saved as text files (OutputFormat = Text)." << std::endl;
+      std::cout << termcolor::reset;
+    }
+  if (_plan.checkpointInterval > 0)
+    {
+      std::cout << termcolor::yellow << "WARNING::ENSEMBLE : No checkpoint is written for an ensemble run (CheckpointInterval is ignored)." << std::endl;
+      std::cout << termcolor::reset;
+    }
+}
+
+
+
+void Ensemble::readMembers(const std::string& fileName)
+{
+  std::ifstream membersFile(fileName);
+  if (!membersFile.is_open())
+    {
+      std::cout << termcolor::red << "ERROR::ENSEMBLE : Unable to open the members file " << fileName << std::endl;
+      std::cout << termcolor::reset;
+      exit(-1);
+    }
+
+  // En-tête puis une ligne par membre
+  std::vector<std::string> keys;
+  std::vector<std::vector<std::string> > values;
+  std::string line;
+  while (getline(membersFile, line))
+    {
+      std::stringstream lineStream(line);
+      std::vector<std::string> words;
+      std::string word;
+      while (lineStream >> word)
+        words.push_back(word);
+      if (words.empty() || words[0][0] == '#')
+        continue;
+      if (keys.empty())
+        {
+          keys = words;
+          continue;
+        }
+      if (words.size() != keys.size())
+        {
+          std::cout << termcolor::red << "ERROR::ENSEMBLE : Each member needs " << keys.size() << " values in " << fileName << " : " << line << std::endl;
+          std::cout << termcolor::reset;
+          exit(-1);
+        }
+      values.push_back(words);
+    }
+  _nMembers = values.size();
+  if (_nMembers == 0)
+    {
+      std::cout << termcolor::red << "ERROR::ENSEMBLE : No member in " << fileName << std::endl;
+      std::cout << termcolor::reset;
+      exit(-1);
+    }
+
+  // Forçage de chaque membre : celui du fichier de paramètres, modifié par
+  // les valeurs du membre
+  int nCells(_mesh->getNumberOfCells());
+  _state = EnsembleState(nCells, _nMembers, _timeStep);
+  _leftBoundaryData.resize(_nMembers);
+  _rightBoundaryData.resize(_nMembers);
+  _membersDirectories.resize(_nMembers);
+  for (int k(0) ; k < _nMembers ; ++k)
+    {
+      BoundaryForcing& forcing(_state.forcing[k]);
+      forcing = _physics->getBoundaryForcing();
+      for (std::size_t j(0) ; j < keys.size() ; ++j)
+        {
+          const std::string& value(values[k][j]);
+          if (keys[j] == "LeftBoundaryImposedHeight")
+            forcing.leftImposedHeight = atof(value.c_str());
+          else if (keys[j] == "LeftBoundaryImposedDischarge")
+            forcing.leftImposedDischarge = atof(value.c_str());
+          else if (keys[j] == "RightBoundaryImposedHeight")
+            forcing.rightImposedHeight = atof(value.c_str());
+          else if (keys[j] == "RightBoundaryImposedDischarge")
+            forcing.rightImposedDischarge = atof(value.c_str());
+          else if (keys[j] == "LeftBoundaryDataFile")
+            {
+              _physics->readExpBoundaryData(value, _leftBoundaryData[k]);
+              forcing.leftData = &_leftBoundaryData[k];
+            }
+          else if (keys[j] == "RightBoundaryDataFile")
+            {
+              _physics->readExpBoundaryData(value, _rightBoundaryData[k]);
+              forcing.rightData = &_rightBoundaryData[k];
+            }
+          else
+            {
+              std::cout << termcolor::red << "ERROR::ENSEMBLE : Unknown member key " << keys[j] << " in " << fileName << std::endl;
+              std::cout << termcolor::reset;
+              exit(-1);
+            }
+        }
+      _membersDirectories[k] = _DF->getResultsDirectory() + "/member_" + std::to_string(k + 1);
+      system(("mkdir -p ./" + _membersDirectories[k]).c_str());
+      system(("rm -f ./" + _membersDirectories[k] + "/solution* ./" + _membersDirectories[k] + "/probe*").c_str());
+    }
+
+  // Même condition initiale pour tous les membres
+  const StateMatrix& Sol0(_physics->getInitialCondition());
+  _h = Sol0.col(0).replicate(1, _nMembers);
+  _q = Sol0.col(1).replicate(1, _nMembers);
+  _k1H.resize(nCells, _nMembers);
+  _k1Q.resize(nCells, _nMembers);
+  _stageH.resize(nCells, _nMembers);
+  _stageQ.resize(nCells, _nMembers);
+
+#if VERBOSITY>0
+  std::cout << "Ensemble of " << _nMembers << " members read from " << fileName << std::endl;
+#endif
+}
+
+
+
+void Ensemble::oneStep()
+{
+  // Hors flux et terme source (mesurés à part), tout est mise à jour de la solution
+  PROFILE_SCOPE(Update);
+
+  double dt(_timeStep);
+  double dx(_mesh->getSpaceStep());
+
+  // Le terme source de h est nul. Il est tout de même ajouté (+ 0.) pour
+  // que chaque membre donne exactement les mêmes résultats qu'un calcul
+  // seul, jusqu'au signe des zéros.
+  switch (_plan.timeScheme)
+    {
+    case TimeSchemeType::ExplicitEuler:
+      _finVol->buildFluxVector(_currentTime, _h, _q, _state);
+      _physics->buildSourceTerm(_h, _state);
+      _h.array() += dt * (_state.fluxH.array() / dx + 0.);
+      _q.array() += dt * (_state.fluxQ.array() / dx + _state.sourceQ.array());
+      break;
+
+    case TimeSchemeType::RK2:
+      // Calcul de k1
+      _finVol->buildFluxVector(_currentTime, _h, _q, _state);
+      _physics->buildSourceTerm(_h, _state);
+      _k1H.array() = _state.fluxH.array() / dx + 0.;
+      _k1Q.array() = _state.fluxQ.array() / dx + _state.sourceQ.array();
+
+      // Calcul de k2
+      _stageH = _h + dt * _k1H;
+      _stageQ = _q + dt * _k1Q;
+      _physics->buildSourceTerm(_stageH, _state);
+      _finVol->buildFluxVector(_currentTime + dt, _stageH, _stageQ, _state);
+
+      // Mise a jour de la solution
+      _h.array() += 0.5 * dt * (_k1H.array() + (_state.fluxH.array() / dx + 0.));
+      _q.array() += 0.5 * dt * (_k1Q.array() + (_state.fluxQ.array() / dx + _state.sourceQ.array()));
+      break;
+
+    case TimeSchemeType::SSPRK3:
+      sspStage(_currentTime, _h, _q, 0., 1., _stageH, _stageQ);
+      sspStage(_currentTime + dt, _stageH, _stageQ, 0.75, 0.25, _stageH, _stageQ);
+      sspStage(_currentTime + 0.5 * dt, _stageH, _stageQ, 1./3., 2./3., _h, _q);
+      break;
+
+    case TimeSchemeType::SSPRKs2:
+      {
+        int s(_plan.rungeKuttaStages);
+        double subStep(dt / (s - 1));
+        _state.timeStep = subStep;
+        sspStage(_currentTime, _h, _q, 0., 1., _stageH, _stageQ);
+        for (int i(1) ; i < s - 1 ; ++i)
+          {
+            sspStage(_currentTime + i * subStep, _stageH, _stageQ, 0., 1., _stageH, _stageQ);
+          }
+        sspStage(_currentTime + (s - 1) * subStep, _stageH, _stageQ, 1. / s, (s - 1.) / s, _h, _q);
+        _state.timeStep = dt;
+        break;
+      }
+    }
+}
+
+
+
+void Ensemble::sspStage(double t, const EnsembleMatrix& h, const EnsembleMatrix& q, double a, double b, EnsembleMatrix& outH, EnsembleMatrix& outQ)
+{
+  double dt(_state.timeStep);
+  double dx(_mesh->getSpaceStep());
+
+  _physics->buildSourceTerm(h, _state);
+  _finVol->buildFluxVector(t, h, q, _state);
+  if (a == 0.)
+    {
+      outH.array() = b * (h.array() + dt * (_state.fluxH.array() / dx + 0.));
+      outQ.array() = b * (q.array() + dt * (_state.fluxQ.array() / dx + _state.sourceQ.array()));
+    }
+  else
+    {
+      outH.array() = a * _h.array() + b * (h.array() + dt * (_state.fluxH.array() / dx + 0.));
+      outQ.array() = a * _q.array() + b * (q.array() + dt * (_state.fluxQ.array() / dx + _state.sourceQ.array()));
+    }
+}
+
+
+
+void Ensemble::saveCurrentSolution(int nSaves)
+{
+  PROFILE_SCOPE(Output);
+#if VERBOSITY>0
+  std::cout << "Saving solution at t = " << _currentTime << std::endl;
+#endif
+  Eigen::VectorXd h, q;
+  for (int k(0) ; k < _nMembers ; ++k)
+    {
+      h = _h.col(k);
+      q = _q.col(k);
+      std::string fileName(_membersDirectories[k] + "/solution_" + _finVol->getFluxName() + "_" + std::to_string(nSaves) + ".txt");
+      writeSolutionText(fileName, _mesh->getCellCenters(), _physics->getTopography(), h, q, _plan.g);
+    }
+}
+
+
+
+void Ensemble::saveProbes()
+{
+  PROFILE_SCOPE(Output);
+  for (int k(0) ; k < _nMembers ; ++k)
+    _probeRecorders[k].record(_currentTime, _h.col(k), _q.col(k));
+}
+
+
+
+void Ensemble::solve()
+{
+  // Logs de début
+#if VERBOSITY>0
+  std::cout << "====================================================================================================" << std::endl;
+  std::cout << "Time loop (ensemble of " << _nMembers << " members)..." << std::endl;
+#endif
+#if PROFILING>0
+  Profiler::start();
+#endif
+
+  int n(0), nSaves(0);
+  int probesFrequency(_plan.probeSampling);
+
+  // Sauvegarde la condition initiale et la topographie, commune à tous les membres
+  saveCurrentSolution(n);
+  {
+    std::ofstream topoFile(_DF->getResultsDirectory() + "/topography.txt", std::ios::out);
+    std::vector<const double*> topoColumns = {_mesh->getCellCenters().data(), _physics->getTopography().data()};
+    writeColumns(topoFile, topoColumns, _h.rows(), ' ');
+  }
+
+  // Sondes
+  int nProbes(_DF->getNumberOfProbes());
+  if (nProbes != 0)
+    {
+      const std::vector<double>& probesPos(_DF->getProbesPositions());
+      std::vector<double> probesTopography(nProbes);
+      _probesIndices.resize(nProbes);
+      for (int i(0) ; i < nProbes ; ++i)
+        {
+          _probesIndices[i] = _mesh->findNearestCell(probesPos[i]);
+          probesTopography[i] = _physics->getTopography()(_probesIndices[i]);
+        }
+      _probeRecorders.resize(_nMembers);
+      for (int k(0) ; k < _nMembers ; ++k)
+        _probeRecorders[k].Initialize(_membersDirectories[k] + "/probes.csv", _DF->getProbesReferences(), _probesIndices, probesTopography, _plan.g);
+    }
+
+#if PROFILING>0
+  Profiler::beginTimeLoop();
+#endif
+
+  // Boucle en temps, comme celle de TimeScheme::solve à pas de temps fixe
+  while (_currentTime < _finalTime)
+    {
+      oneStep();
+      ++n;
+      _currentTime += _timeStep;
+      nSaves = n/_plan.saveFrequency;
+      if (!_plan.isSaveFinalTimeOnly && n % _plan.saveFrequency == 0)
+        {
+          saveCurrentSolution(nSaves);
+        }
+      if (nProbes != 0 && probesFrequency > 0 && n % probesFrequency == 0)
+        {
+          saveProbes();
+        }
+#if PROFILING>0
+      Profiler::endStep();
+#endif
+    }
+  // End of time loop
+  if (nProbes != 0)
+    {
+      PROFILE_SCOPE(Output);
+      for (int k(0) ; k < _nMembers ; ++k)
+        _probeRecorders[k].flush();
+    }
+  if (_plan.isSaveFinalTimeOnly)
+    {
+      saveCurrentSolution(nSaves);
+    }
+#if PROFILING>0
+  Profiler::stop(_h.size());
+  Profiler::printReport(std::cout);
+#if PROFILING>1
+  Profiler::writeJSON(_DF->getResultsDirectory() + "/profile.json");
+#endif
+#endif
+
+  // Logs de fin
+#if VERBOSITY>0
+  std::cout << termcolor::green << "ENSEMBLE::SUCCESS : Solved 1D St-Venant equations for " << _nMembers << " members successfully !" << std::endl;
+  std::cout << termcolor::reset << "====================================================================================================" << std::endl << std::endl;
+#endif
+}
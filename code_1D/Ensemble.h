@@ -0,0 +1,104 @@
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include "DataFile.h"
+#include "Mesh.h"
+#include "Physics.h"
+#include "FiniteVolume.h"
+#include "Layout.h"
+#include "ProbeRecorder.h"
+#include "SolverState.h"
+#include "Eigen/Eigen/Dense"
+
+#include <string>
+#include <vector>
+
+
+
+// Calcul d'ensemble : plusieurs calculs (les membres) sur le même problème,
+// qui ne diffèrent que par leur forçage aux limites. Chaque membre donne
+// exactement les mêmes résultats que le calcul seul avec ses valeurs dans le
+// fichier de paramètres.
+//
+// Les membres d'une cellule sont contigus en mémoire (EnsembleMatrix) : un
+// seul appel à buildFluxVector/buildSourceTerm fait avancer tous les
+// membres, avec des boucles vectorisées sur les membres, et les flux de
+// toutes les interfaces de tous les membres sont calculés en un seul lot.
+//
+// Usage : ./main parameters.txt --ensemble members.txt
+// Le fichier des membres contient une ligne d'en-tête avec les clés qui
+// changent d'un membre à l'autre, puis une ligne de valeurs par membre
+// (les lignes vides ou commençant par # sont ignorées) :
+//   LeftBoundaryImposedHeight  RightBoundaryImposedHeight
+//   0.10                       1.0
+//   0.12                       1.1
+// Clés possibles : LeftBoundaryImposedHeight, LeftBoundaryImposedDischarge,
+// RightBoundaryImposedHeight, RightBoundaryImposedDischarge,
+// LeftBoundaryDataFile et RightBoundaryDataFile. Les résultats du membre k (à partir de 1) sont
+// écrits dans ResultsDir/member_k.
+//
+// Le pas de temps est le même pour tous les membres : AdaptiveStepping doit
+// valoir 0. Les sauvegardes sont au format texte, sans points de reprise.
+class Ensemble
+{
+private:
+  // Pointeurs vers le problème, partagé par tous les membres
+  const DataFile* _DF;
+  const Mesh* _mesh;
+  const Physics* _physics;
+  const FiniteVolume* _finVol;
+
+  // Options résolues du fichier de paramètres
+  RunPlan _plan;
+
+  // Membres : dossier des résultats et données expérimentales propres
+  // (fichiers Left/RightBoundaryDataFile du membre)
+  int _nMembers;
+  std::vector<std::string> _membersDirectories;
+  std::vector<TimeSeries> _leftBoundaryData, _rightBoundaryData;
+
+  // Solution, une colonne par membre
+  EnsembleMatrix _h, _q;
+
+  // État des membres : forçage, terme source, flux...
+  EnsembleState _state;
+
+  // Étage de RK2 : k1 et Sol + dt * k1 (seule la solution intermédiaire
+  // sert aux schémas SSP)
+  EnsembleMatrix _k1H, _k1Q, _stageH, _stageQ;
+
+  // Paramètres de temps
+  double _timeStep;
+  double _initialTime;
+  double _finalTime;
+  double _currentTime;
+
+  // Sondes, un fichier par membre
+  std::vector<int> _probesIndices;
+  std::vector<ProbeRecorder> _probeRecorders;
+
+  // Étage d'Euler explicite des schémas SSP, comme TimeScheme::sspStage :
+  // out = a * Sol + b * (U + dt * L(U))
+  void sspStage(double t, const EnsembleMatrix& h, const EnsembleMatrix& q, double a, double b, EnsembleMatrix& outH, EnsembleMatrix& outQ);
+
+public:
+  // Constructeur
+  Ensemble(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
+
+  // Lit le fichier des membres et dimensionne l'ensemble
+  void readMembers(const std::string& fileName);
+
+  // Getters
+  int getNumberOfMembers() const {return _nMembers;};
+  const EnsembleMatrix& getHeight() const {return _h;};
+  const EnsembleMatrix& getDischarge() const {return _q;};
+  double getCurrentTime() const {return _currentTime;};
+
+  // Solve and save solution
+  void oneStep();
+  void saveCurrentSolution(int nSaves);
+  void saveProbes();
+  void solve();
+};
+
+#endif // ENSEMBLE_H
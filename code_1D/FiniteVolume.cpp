@@ -2,6 +2,8 @@
 #include "DataFile.h"
 #include "Mesh.h"
 #include "Physics.h"
+#include "FluxKernels.h"
+#include "Profiler.h"
 
 #include "Eigen/Eigen/Dense"
 #include "Eigen/Eigen/Sparse"
@@ -20,51 +22,49 @@ FiniteVolume::FiniteVolume()
 
 
 
-FiniteVolume::FiniteVolume(DataFile* DF, Mesh* mesh, Physics* physics):
-  _DF(DF), _mesh(mesh), _physics(physics), _fluxVector(_mesh->getNumberOfCells(), 2)
+FiniteVolume::FiniteVolume(const DataFile* DF, const Mesh* mesh, const Physics* physics):
+  _DF(DF), _mesh(mesh), _physics(physics), _plan(DF->getRunPlan())
 {
 }
 
 
 
-void FiniteVolume::Initialize(DataFile* DF, Mesh* mesh, Physics* physics)
+void FiniteVolume::Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics)
 {
   _DF = DF;
   _mesh = mesh;
   _physics = physics;
-  _fluxVector.resize(_mesh->getNumberOfCells(), 2);
+  _plan = DF->getRunPlan();
 }
 
 
 
-void FiniteVolume::buildFluxVector(const double t, const Eigen::Matrix<double, Eigen::Dynamic, 2>& Sol)
+void FiniteVolume::buildFluxVector(const double t, const StateMatrix& Sol, SolverState& state) const
 {
-  // Reset the flux
-  _fluxVector.setZero();
+  // Reconstruction, sans les conditions aux limites ni les flux qui sont
+  // mesurés à part
+  PROFILE_SCOPE(Reconstruction);
 
   // Get mesh parameters
   int nCells(_mesh->getNumberOfCells());
   double dx(_mesh->getSpaceStep());
 
-  // Get gravity
-  double g(_DF->getGravityAcceleration());
-
   // Vectors to store the reconstruted values at the left and right of each interface
-  Eigen::Matrix<double, Eigen::Dynamic, 2> SolD, SolG;
-  SolD.resize(nCells + 1, 2);
-  SolG.resize(nCells + 1, 2);
+  // (preallocated in the workspace)
+  Eigen::Matrix<double, Eigen::Dynamic, 2>& SolG(state.workspace.SolG);
+  Eigen::Matrix<double, Eigen::Dynamic, 2>& SolD(state.workspace.SolD);
 
   // Select order of the scheme
-  switch(_DF->getSchemeOrder())
+  switch(_plan.schemeOrder)
     {
       // First order, the reconstructed values are the cell-centered approximations
     case 1:
       // Left boundary
-      SolG.row(0) = _physics->leftBoundaryFunction(t + _DF->getTimeStep(), Sol);
+      SolG.row(0) = _physics->leftBoundaryFunction(t + state.timeStep, Sol, state);
       SolD.row(0) = Sol.row(0);
       // Right boundary
       SolG.row(nCells) = Sol.row(nCells - 1);
-      SolD.row(nCells) = _physics->rightBoundaryFunction(t + _DF->getTimeStep(), Sol);
+      SolD.row(nCells) = _physics->rightBoundaryFunction(t + state.timeStep, Sol, state);
       // Interior edges
       for (int i(1) ; i < nCells ; ++i)
         {
@@ -77,17 +77,16 @@ void FiniteVolume::buildFluxVector(const double t, const Eigen::Matrix<double, E
       // + slope limitation (minmod limiter) to get a TVD scheme.
     case 2:
       // Vector to store the slopes and the limited slopes for the piecewise linear reconstruction
-      Eigen::Matrix<double, Eigen::Dynamic, 2> slopes, limSlopes;
-      slopes.resize(nCells + 1, 2);
-      limSlopes.resize(nCells, 2);
+      Eigen::Matrix<double, Eigen::Dynamic, 2>& slopes(state.workspace.slopes);
+      Eigen::Matrix<double, Eigen::Dynamic, 2>& limSlopes(state.workspace.limSlopes);
       
       // Compute the slopes
       // Left boundary
-      Eigen::Vector2d leftBoundarySol(_physics->leftBoundaryFunction(t + _DF->getTimeStep(), Sol));
+      Eigen::Vector2d leftBoundarySol(_physics->leftBoundaryFunction(t + state.timeStep, Sol, state));
       slopes(0,0) = (Sol(0,0) - leftBoundarySol(0)) / dx;
       slopes(0,1) = (Sol(0,1) - leftBoundarySol(1)) / dx;
       // Right boundary
-      Eigen::Vector2d rightBoundarySol(_physics->rightBoundaryFunction(t + _DF->getTimeStep(), Sol));
+      Eigen::Vector2d rightBoundarySol(_physics->rightBoundaryFunction(t + state.timeStep, Sol, state));
       slopes(nCells, 0) = (rightBoundarySol(0) - Sol(nCells - 1, 0)) / dx;
       slopes(nCells, 1) = (rightBoundarySol(1) - Sol(nCells - 1, 1)) / dx;
       // Interior edges
@@ -97,7 +96,7 @@ void FiniteVolume::buildFluxVector(const double t, const Eigen::Matrix<double, E
         }
 
       // Limit the slopes
-      for (int i(0) ; i < nCells - 1 ; ++i)
+      for (int i(0) ; i < nCells ; ++i)
         {
           limSlopes(i,0) = minmod(slopes(i,0), slopes(i+1,0));
           limSlopes(i,1) = minmod(slopes(i,1), slopes(i+1,1));
@@ -119,18 +118,203 @@ void FiniteVolume::buildFluxVector(const double t, const Eigen::Matrix<double, E
       break;
     }
   
-  // Build the flux vector using the reconstructed values at each edge
-  // Left boundary contribution
-  _fluxVector.row(0) += numFlux(SolG.row(0), SolD.row(0));
-  // Interior fluxes contribution
-  for (int i(1) ; i < nCells; ++i)
+  // Compute the flux through every interface in one batch, and keep track
+  // of the largest wave speed for the CFL condition
+  PROFILE_SCOPE(RiemannFluxes);
+  Eigen::Matrix<double, Eigen::Dynamic, 2>& interfaceFlux(state.workspace.interfaceFlux);
+  state.maxWaveSpeed = interfaceFluxes(SolG, SolD, state.timeStep, interfaceFlux);
+  state.fluxTimeStep = state.timeStep;
+
+  // Build the flux vector : each cell gets the flux through its left
+  // interface minus the flux through its right interface
+  state.fluxVector = interfaceFlux.topRows(nCells) - interfaceFlux.bottomRows(nCells);
+}
+
+
+
+void FiniteVolume::updateFluxTimeStep(const double t, const StateMatrix& Sol, SolverState& state) const
+{
+  if (state.fluxTimeStep == state.timeStep)
+    return;
+
+  PROFILE_SCOPE(Reconstruction);
+  int nCells(_mesh->getNumberOfCells());
+  double dx(_mesh->getSpaceStep());
+  FluxWorkspace& workspace(state.workspace);
+  Eigen::Matrix<double, Eigen::Dynamic, 2>& SolG(workspace.SolG);
+  Eigen::Matrix<double, Eigen::Dynamic, 2>& SolD(workspace.SolD);
+
+  // Lax-Friedrichs diffusion, on every interface
+  double diffusionChange(timeStepDiffusion(state.timeStep) - timeStepDiffusion(state.fluxTimeStep));
+  if (diffusionChange != 0.)
+    {
+      workspace.interfaceFlux -= 0.5 * diffusionChange * (SolD - SolG);
+    }
+
+  // Boundary conditions at t + dt
+  Eigen::Vector2d leftBoundarySol(_physics->leftBoundaryFunction(t + state.timeStep, Sol, state));
+  Eigen::Vector2d rightBoundarySol(_physics->rightBoundaryFunction(t + state.timeStep, Sol, state));
+  switch(_plan.schemeOrder)
     {
-      Eigen::Vector2d flux(numFlux(SolG.row(i), SolD.row(i)));
-      _fluxVector.row(i-1) -= flux;
-      _fluxVector.row(i) += flux;
+    case 1:
+      SolG.row(0) = leftBoundarySol;
+      SolD.row(nCells) = rightBoundarySol;
+      workspaceFluxes(0, 1, state.timeStep, workspace);
+      workspaceFluxes(nCells, 1, state.timeStep, workspace);
+      break;
+
+      // The boundary values change the limited slopes of the first and last
+      // cells, hence the two interfaces of each of these cells
+    case 2:
+      Eigen::Matrix<double, Eigen::Dynamic, 2>& slopes(workspace.slopes);
+      Eigen::Matrix<double, Eigen::Dynamic, 2>& limSlopes(workspace.limSlopes);
+      slopes(0,0) = (Sol(0,0) - leftBoundarySol(0)) / dx;
+      slopes(0,1) = (Sol(0,1) - leftBoundarySol(1)) / dx;
+      slopes(nCells, 0) = (rightBoundarySol(0) - Sol(nCells - 1, 0)) / dx;
+      slopes(nCells, 1) = (rightBoundarySol(1) - Sol(nCells - 1, 1)) / dx;
+      limSlopes(0,0) = minmod(slopes(0,0), slopes(1,0));
+      limSlopes(0,1) = minmod(slopes(0,1), slopes(1,1));
+      limSlopes(nCells - 1,0) = minmod(slopes(nCells - 1,0), slopes(nCells,0));
+      limSlopes(nCells - 1,1) = minmod(slopes(nCells - 1,1), slopes(nCells,1));
+      SolG.row(0) = leftBoundarySol;
+      SolD.row(0) = Sol.row(0) - 0.5 * dx * limSlopes.row(0);
+      SolG.row(1) = Sol.row(0) + 0.5 * dx * limSlopes.row(0);
+      SolD.row(nCells - 1) = Sol.row(nCells - 1) - 0.5 * dx * limSlopes.row(nCells - 1);
+      SolG.row(nCells) = Sol.row(nCells - 1) + 0.5 * dx * limSlopes.row(nCells - 1);
+      SolD.row(nCells) = rightBoundarySol;
+      workspaceFluxes(0, 2, state.timeStep, workspace);
+      workspaceFluxes(nCells - 1, 2, state.timeStep, workspace);
+      break;
     }
-  // Right boundary contribution
-  _fluxVector.row(nCells - 1) -= numFlux(SolG.row(nCells), SolD.row(nCells));
+  state.fluxTimeStep = state.timeStep;
+
+  state.fluxVector = workspace.interfaceFlux.topRows(nCells) - workspace.interfaceFlux.bottomRows(nCells);
+}
+
+
+
+void FiniteVolume::buildFluxVector(const double t, const EnsembleMatrix& h, const EnsembleMatrix& q, EnsembleState& state) const
+{
+  // Même reconstruction que pour un seul calcul, membre par membre pour les
+  // conditions aux limites et sur des lignes entières (tous les membres
+  // d'une cellule) ailleurs
+  PROFILE_SCOPE(Reconstruction);
+
+  int nCells(_mesh->getNumberOfCells());
+  int nMembers(h.cols());
+  double dx(_mesh->getSpaceStep());
+  EnsembleMatrix& hG(state.hG);
+  EnsembleMatrix& qG(state.qG);
+  EnsembleMatrix& hD(state.hD);
+  EnsembleMatrix& qD(state.qD);
+
+  // Boundary conditions of each member, in hG.row(0) and hD.row(nCells)
+  for (int k(0) ; k < nMembers ; ++k)
+    {
+      Eigen::Vector2d leftBoundarySol(_physics->leftBoundaryFunction(t + state.timeStep, h.col(k), q.col(k), state.sourceQ.col(k),
+                                                                     state.timeStep, state.forcing[k]));
+      Eigen::Vector2d rightBoundarySol(_physics->rightBoundaryFunction(t + state.timeStep, h.col(k), q.col(k), state.sourceQ.col(k),
+                                                                       state.timeStep, state.forcing[k]));
+      hG(0,k) = leftBoundarySol(0);
+      qG(0,k) = leftBoundarySol(1);
+      hD(nCells,k) = rightBoundarySol(0);
+      qD(nCells,k) = rightBoundarySol(1);
+    }
+
+  switch(_plan.schemeOrder)
+    {
+    case 1:
+      hG.bottomRows(nCells) = h;
+      qG.bottomRows(nCells) = q;
+      hD.topRows(nCells) = h;
+      qD.topRows(nCells) = q;
+      break;
+
+    case 2:
+      EnsembleMatrix& slopesH(state.slopesH);
+      EnsembleMatrix& slopesQ(state.slopesQ);
+      EnsembleMatrix& limSlopesH(state.limSlopesH);
+      EnsembleMatrix& limSlopesQ(state.limSlopesQ);
+
+      // Compute the slopes
+      slopesH.row(0) = (h.row(0) - hG.row(0)) / dx;
+      slopesQ.row(0) = (q.row(0) - qG.row(0)) / dx;
+      slopesH.row(nCells) = (hD.row(nCells) - h.row(nCells - 1)) / dx;
+      slopesQ.row(nCells) = (qD.row(nCells) - q.row(nCells - 1)) / dx;
+      slopesH.middleRows(1, nCells - 1) = (h.bottomRows(nCells - 1) - h.topRows(nCells - 1)) / dx;
+      slopesQ.middleRows(1, nCells - 1) = (q.bottomRows(nCells - 1) - q.topRows(nCells - 1)) / dx;
+
+      // Limit the slopes
+      for (int i(0) ; i < nCells ; ++i)
+        {
+          for (int k(0) ; k < nMembers ; ++k)
+            {
+              limSlopesH(i,k) = minmod(slopesH(i,k), slopesH(i+1,k));
+              limSlopesQ(i,k) = minmod(slopesQ(i,k), slopesQ(i+1,k));
+            }
+        }
+
+      // Reconstruct the values at each edge
+      hG.bottomRows(nCells) = h + 0.5 * dx * limSlopesH;
+      qG.bottomRows(nCells) = q + 0.5 * dx * limSlopesQ;
+      hD.topRows(nCells) = h - 0.5 * dx * limSlopesH;
+      qD.topRows(nCells) = q - 0.5 * dx * limSlopesQ;
+      break;
+    }
+
+  // Flux through every interface of every member in one batch
+  PROFILE_SCOPE(RiemannFluxes);
+  FluxKernelData data;
+  data.n = (nCells + 1) * nMembers;
+  data.hG = hG.data();
+  data.qG = qG.data();
+  data.hD = hD.data();
+  data.qD = qD.data();
+  data.Fh = state.interfaceFluxH.data();
+  data.Fq = state.interfaceFluxQ.data();
+  state.maxWaveSpeed = batchFluxes(data, state.timeStep);
+
+  // Flux vector
+  state.fluxH = state.interfaceFluxH.topRows(nCells) - state.interfaceFluxH.bottomRows(nCells);
+  state.fluxQ = state.interfaceFluxQ.topRows(nCells) - state.interfaceFluxQ.bottomRows(nCells);
+}
+
+
+
+double FiniteVolume::interfaceFluxes(const Eigen::Matrix<double, Eigen::Dynamic, 2>& SolG, const Eigen::Matrix<double, Eigen::Dynamic, 2>& SolD, double timeStep, Eigen::Matrix<double, Eigen::Dynamic, 2>& flux) const
+{
+  return batchFluxes(kernelData(SolG, SolD, flux), timeStep);
+}
+
+
+
+FluxKernelData FiniteVolume::kernelData(const Eigen::Matrix<double, Eigen::Dynamic, 2>& SolG, const Eigen::Matrix<double, Eigen::Dynamic, 2>& SolD, Eigen::Matrix<double, Eigen::Dynamic, 2>& flux) const
+{
+  FluxKernelData data;
+  data.n = flux.rows();
+  data.hG = SolG.col(0).data();
+  data.qG = SolG.col(1).data();
+  data.hD = SolD.col(0).data();
+  data.qD = SolD.col(1).data();
+  data.Fh = flux.col(0).data();
+  data.Fq = flux.col(1).data();
+  return data;
+}
+
+
+
+// Flux kernel on the interfaces first to first + n - 1 of the workspace
+void FiniteVolume::workspaceFluxes(int first, int n, double timeStep, FluxWorkspace& workspace) const
+{
+  FluxKernelData data(kernelData(workspace.SolG, workspace.SolD, workspace.interfaceFlux));
+  data.n = n;
+  data.hG += first;
+  data.qG += first;
+  data.hD += first;
+  data.qD += first;
+  data.Fh += first;
+  data.Fq += first;
+  batchFluxes(data, timeStep);
 }
 
 
@@ -157,7 +341,7 @@ LaxFriedrichs::LaxFriedrichs():
 
 
 
-LaxFriedrichs::LaxFriedrichs(DataFile* DF, Mesh* mesh, Physics* function):
+LaxFriedrichs::LaxFriedrichs(const DataFile* DF, const Mesh* mesh, const Physics* function):
   FiniteVolume(DF, mesh, function)
 {
   _fluxName = "LF";
@@ -165,24 +349,29 @@ LaxFriedrichs::LaxFriedrichs(DataFile* DF, Mesh* mesh, Physics* function):
 
 
 
-void LaxFriedrichs::Initialize(DataFile* DF, Mesh* mesh, Physics* physics)
+void LaxFriedrichs::Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics)
 {
   _DF = DF;
   _mesh = mesh;
   _physics = physics;
+  _plan = DF->getRunPlan();
   _fluxName = "LF";
-  _fluxVector.resize(_mesh->getNumberOfCells(), 2);
 }
 
 
 
-Eigen::Vector2d LaxFriedrichs::numFlux(const Eigen::Vector2d& SolG, const Eigen::Vector2d& SolD) const
+Eigen::Vector2d LaxFriedrichs::numFlux(const Eigen::Vector2d& SolG, const Eigen::Vector2d& SolD, double timeStep, double* waveSpeed) const
 {
   // Vecteur flux au travers d'une arete
   Eigen::Vector2d flux;
+
+  // Vitesse d'onde (uniquement pour la condition CFL)
+  double lambda1, lambda2;
+  _physics->computeWaveSpeed(SolG, SolD, &lambda1, &lambda2);
+  *waveSpeed = std::max(abs(lambda1),abs(lambda2));
   
   // Recupere dt et dx
-  double dt(_DF->getTimeStep()), dx(_DF->getDx());
+  double dt(timeStep), dx(_plan.dx);
   double b(dx/dt);
 
   // Calcul du flux
@@ -193,6 +382,21 @@ Eigen::Vector2d LaxFriedrichs::numFlux(const Eigen::Vector2d& SolG, const Eigen:
 
 
 
+double LaxFriedrichs::batchFluxes(const FluxKernelData& data, double timeStep) const
+{
+  double dt(timeStep), dx(_plan.dx);
+  return laxFriedrichsFluxes(data, _plan.g, dx/dt);
+}
+
+
+
+double LaxFriedrichs::timeStepDiffusion(double timeStep) const
+{
+  return _plan.dx / timeStep;
+}
+
+
+
 //---------------------------------------------//
 //---------------Flux de Rusanov---------------//
 //---------------------------------------------//
@@ -203,7 +407,7 @@ Rusanov::Rusanov():
 
 
 
-Rusanov::Rusanov(DataFile* DF, Mesh* mesh, Physics* physics):
+Rusanov::Rusanov(const DataFile* DF, const Mesh* mesh, const Physics* physics):
   FiniteVolume(DF, mesh, physics)
 {
   _fluxName = "Rusanov";
@@ -211,18 +415,18 @@ Rusanov::Rusanov(DataFile* DF, Mesh* mesh, Physics* physics):
 
 
 
-void Rusanov::Initialize(DataFile* DF, Mesh* mesh, Physics* physics)
+void Rusanov::Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics)
 {
   _DF = DF;
   _mesh = mesh;
   _physics = physics;
+  _plan = DF->getRunPlan();
   _fluxName = "Rusanov";
-  _fluxVector.resize(_mesh->getNumberOfCells(), 2);
 }
 
 
 
-Eigen::Vector2d Rusanov::numFlux(const Eigen::Vector2d& SolG, const Eigen::Vector2d& SolD) const
+Eigen::Vector2d Rusanov::numFlux(const Eigen::Vector2d& SolG, const Eigen::Vector2d& SolD, double, double* waveSpeed) const
 {
   // Vecteur flux au travers d'une arete
   Eigen::Vector2d flux;
@@ -231,6 +435,7 @@ Eigen::Vector2d Rusanov::numFlux(const Eigen::Vector2d& SolG, const Eigen::Vecto
   double lambda1, lambda2;
   _physics->computeWaveSpeed(SolG, SolD, &lambda1, &lambda2);
   double b(std::max(abs(lambda1),abs(lambda2)));
+  *waveSpeed = b;
 
   // Calcul du flux
   double hg(SolG(0));
@@ -257,6 +462,13 @@ Eigen::Vector2d Rusanov::numFlux(const Eigen::Vector2d& SolG, const Eigen::Vecto
 
 
 
+double Rusanov::batchFluxes(const FluxKernelData& data, double) const
+{
+  return rusanovFluxes(data, _plan.g);
+}
+
+
+
 //--------------------------------------//
 //---------------Flux HLL---------------//
 //--------------------------------------//
@@ -267,7 +479,7 @@ HLL::HLL():
 
 
 
-HLL::HLL(DataFile* DF, Mesh* mesh, Physics* physics):
+HLL::HLL(const DataFile* DF, const Mesh* mesh, const Physics* physics):
   FiniteVolume(DF, mesh, physics)
 {
   _fluxName = "HLL";
@@ -275,18 +487,18 @@ HLL::HLL(DataFile* DF, Mesh* mesh, Physics* physics):
 
 
 
-void HLL::Initialize(DataFile* DF, Mesh* mesh, Physics* physics)
+void HLL::Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics)
 {
   _DF = DF;
   _mesh = mesh;
   _physics = physics;
+  _plan = DF->getRunPlan();
   _fluxName = "HLL";
-  _fluxVector.resize(_mesh->getNumberOfCells(), 2);
 }
 
 
 
-Eigen::Vector2d HLL::numFlux(const Eigen::Vector2d& SolG, const Eigen::Vector2d& SolD) const
+Eigen::Vector2d HLL::numFlux(const Eigen::Vector2d& SolG, const Eigen::Vector2d& SolD, double, double* waveSpeed) const
 {
   // Vecteur flux au travers d'une arete
   Eigen::Vector2d flux;
@@ -294,6 +506,7 @@ Eigen::Vector2d HLL::numFlux(const Eigen::Vector2d& SolG, const Eigen::Vector2d&
   // Calcul de b
   double lambda1, lambda2;
   _physics->computeWaveSpeed(SolG, SolD, &lambda1, &lambda2);
+  *waveSpeed = std::max(abs(lambda1),abs(lambda2));
 
   // Calcul du flux
   double hg(SolG(0));
@@ -326,3 +539,10 @@ Eigen::Vector2d HLL::numFlux(const Eigen::Vector2d& SolG, const Eigen::Vector2d&
   
   return flux;
 }
+
+
+
+double HLL::batchFluxes(const FluxKernelData& data, double) const
+{
+  return hllFluxes(data, _plan.g);
+}
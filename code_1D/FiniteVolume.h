@@ -4,6 +4,9 @@
 #include "DataFile.h"
 #include "Mesh.h"
 #include "Physics.h"
+#include "Layout.h"
+#include "FluxKernels.h"
+#include "SolverState.h"
 
 #include "Eigen/Eigen/Dense"
 #include "Eigen/Eigen/Sparse"
@@ -14,36 +17,60 @@ class FiniteVolume
 {
 protected:
   // Pointeurs vers les trucs importants
-  DataFile* _DF;
-  Mesh* _mesh;
-  Physics* _physics;
+  const DataFile* _DF;
+  const Mesh* _mesh;
+  const Physics* _physics;
+
+  // Options résolues du fichier de paramètres
+  RunPlan _plan;
 
   // Nom du flux numérique
   std::string _fluxName;
-
-  // Vecteur des flux
-  Eigen::Matrix<double, Eigen::Dynamic, 2> _fluxVector;
   
 public:
   // Constructeurs
   FiniteVolume();
-  FiniteVolume(DataFile* DF, Mesh* mesh, Physics* physics);
+  FiniteVolume(const DataFile* DF, const Mesh* mesh, const Physics* physics);
 
   // Destructeur
   virtual ~FiniteVolume() = default;
   
   // Initialisation
-  void Initialize(DataFile* DF, Mesh* mesh, Physics* physics);
+  void Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics);
 
   // Getters
   const std::string& getFluxName() const {return _fluxName;};
-  const Eigen::Matrix<double, Eigen::Dynamic, 2>& getFluxVector() const {return _fluxVector;};
-  
-  // Build the flux vector
-  virtual Eigen::Vector2d numFlux(const Eigen::Vector2d& SolG, const Eigen::Vector2d& SolD) const = 0;
-  void buildFluxVector(const double t, const Eigen::Matrix<double, Eigen::Dynamic, 2>& Sol);
+
+  // Build the flux vector in state.fluxVector, and the largest wave speed in
+  // state.maxWaveSpeed. numFlux also returns the largest wave speed |lambda|
+  // at the interface in waveSpeed. The time step is only used by the
+  // Lax-Friedrichs flux.
+  virtual Eigen::Vector2d numFlux(const Eigen::Vector2d& SolG, const Eigen::Vector2d& SolD, double timeStep, double* waveSpeed) const = 0;
+  void buildFluxVector(const double t, const StateMatrix& Sol, SolverState& state) const;
+  // Adaptive time stepping : the flux vector is built before the time step is
+  // chosen, from the wave speed it returns. Only the parts of state.fluxVector
+  // which depend on the time step are then updated : the boundary conditions
+  // at t + dt (and the interfaces they reach) and the Lax-Friedrichs
+  // diffusion. Nothing is done if the time step did not change.
+  void updateFluxTimeStep(const double t, const StateMatrix& Sol, SolverState& state) const;
+  // Same for all the members of an ensemble at once, in state.fluxH and state.fluxQ
+  void buildFluxVector(const double t, const EnsembleMatrix& h, const EnsembleMatrix& q, EnsembleState& state) const;
+
+  // Same as numFlux for all the interfaces at once, with the batched SIMD
+  // kernels of FluxKernels.h. Returns the largest wave speed.
+  double interfaceFluxes(const Eigen::Matrix<double, Eigen::Dynamic, 2>& SolG, const Eigen::Matrix<double, Eigen::Dynamic, 2>& SolD, double timeStep, Eigen::Matrix<double, Eigen::Dynamic, 2>& flux) const;
+  // Calls the flux kernel on any set of interfaces
+  virtual double batchFluxes(const FluxKernelData& data, double timeStep) const = 0;
+  // Numerical diffusion b of the flux 0.5 * (F(SolD) + F(SolG)) - 0.5 * b * (SolD - SolG)
+  // which depends on the time step (only for the Lax-Friedrichs flux)
+  virtual double timeStepDiffusion(double) const {return 0.;};
 
 protected:
+  // Arguments of the flux kernels (the matrices are column-major, so h and q are contiguous)
+  FluxKernelData kernelData(const Eigen::Matrix<double, Eigen::Dynamic, 2>& SolG, const Eigen::Matrix<double, Eigen::Dynamic, 2>& SolD, Eigen::Matrix<double, Eigen::Dynamic, 2>& flux) const;
+  // Flux through the n interfaces from first of the workspace
+  void workspaceFluxes(int first, int n, double timeStep, FluxWorkspace& workspace) const;
+
   // Minmod slope limiter for the 2nd order MUSCL schemes
   double minmod(double a, double b) const;
 };
@@ -55,13 +82,15 @@ class LaxFriedrichs: public FiniteVolume
 public:
   // Constructeur
   LaxFriedrichs();
-  LaxFriedrichs(DataFile* DF, Mesh* mesh, Physics* physics);
+  LaxFriedrichs(const DataFile* DF, const Mesh* mesh, const Physics* physics);
 
   // Initialisation
-  void Initialize(DataFile* DF, Mesh* mesh, Physics* physics);
+  void Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics);
 
   // Build flux vector
-  Eigen::Vector2d numFlux(const Eigen::Vector2d& SolG, const Eigen::Vector2d& SolD) const;
+  Eigen::Vector2d numFlux(const Eigen::Vector2d& SolG, const Eigen::Vector2d& SolD, double timeStep, double* waveSpeed) const;
+  double batchFluxes(const FluxKernelData& data, double timeStep) const;
+  double timeStepDiffusion(double timeStep) const;
 };
 
 
@@ -71,13 +100,14 @@ class Rusanov: public FiniteVolume
 public:
   // Constructeur
   Rusanov();
-  Rusanov(DataFile* DF, Mesh* mesh, Physics* physics);
+  Rusanov(const DataFile* DF, const Mesh* mesh, const Physics* physics);
 
   // Initialisation
-  void Initialize(DataFile* DF, Mesh* mesh, Physics* physics);
+  void Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics);
 
   // Build flux vector
-  Eigen::Vector2d numFlux(const Eigen::Vector2d& SolG, const Eigen::Vector2d& SolD) const;
+  Eigen::Vector2d numFlux(const Eigen::Vector2d& SolG, const Eigen::Vector2d& SolD, double timeStep, double* waveSpeed) const;
+  double batchFluxes(const FluxKernelData& data, double timeStep) const;
 };
 
 
@@ -87,13 +117,14 @@ class HLL: public FiniteVolume
 public:
   // Constructeur
   HLL();
-  HLL(DataFile* DF, Mesh* mesh, Physics* physics);
+  HLL(const DataFile* DF, const Mesh* mesh, const Physics* physics);
 
   // Initialisation
-  void Initialize(DataFile* DF, Mesh* mesh, Physics* physics);
+  void Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics);
 
   // Build flux vector
-  Eigen::Vector2d numFlux(const Eigen::Vector2d& SolG, const Eigen::Vector2d& SolD) const;
+  Eigen::Vector2d numFlux(const Eigen::Vector2d& SolG, const Eigen::Vector2d& SolD, double timeStep, double* waveSpeed) const;
+  double batchFluxes(const FluxKernelData& data, double timeStep) const;
 };
 
 #endif //FINITE_VOLUME_H
@@ -0,0 +1,211 @@
+#include "FluxKernels.h"
+
+#include <cmath>
+#include <algorithm>
+
+// The SIMD versions need GCC (function-level target pragmas) on x86.
+// They can be disabled with make SIMD=0.
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__)) && !defined(NO_SIMD_KERNELS)
+#define FLUX_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+
+
+//----------------------------------------------//
+//---------------Packs of doubles---------------//
+//----------------------------------------------//
+// A pack holds `width` doubles and provides the few operations needed by
+// the kernels. min/max follow the semantics of std::min/std::max (a NaN in
+// b is dropped), select(m, a, b) returns a where m is true and b elsewhere.
+
+// One double : scalar fallback and end of the SIMD loops
+struct ScalarPack
+{
+  typedef double Real;
+  typedef bool Mask;
+  static const int width = 1;
+
+  static Real load(const double* p) {return *p;};
+  static void store(double* p, Real a) {*p = a;};
+  static Real set(double a) {return a;};
+  static Real add(Real a, Real b) {return a + b;};
+  static Real sub(Real a, Real b) {return a - b;};
+  static Real mul(Real a, Real b) {return a * b;};
+  static Real div(Real a, Real b) {return a / b;};
+  static Real sqrt(Real a) {return std::sqrt(a);};
+  static Real neg(Real a) {return -a;};
+  static Real abs(Real a) {return std::abs(a);};
+  static Real min(Real a, Real b) {return std::min(a, b);};
+  static Real max(Real a, Real b) {return std::max(a, b);};
+  static Mask lt(Real a, Real b) {return a < b;};
+  static Mask le(Real a, Real b) {return a <= b;};
+  static Mask land(Mask a, Mask b) {return a && b;};
+  static Real select(Mask m, Real a, Real b) {return m ? a : b;};
+  static double reduceMax(Real a) {return a;};
+  static double reduceSum(Real a) {return a;};
+};
+
+namespace scalar
+{
+  typedef ScalarPack Pack;
+#include "FluxKernelsBody.h"
+}
+
+
+#ifdef FLUX_KERNELS_X86
+// Four doubles in an AVX register
+#pragma GCC push_options
+#pragma GCC target("avx2")
+struct AVX2Pack
+{
+  typedef __m256d Real;
+  typedef __m256d Mask;
+  static const int width = 4;
+
+  static Real load(const double* p) {return _mm256_loadu_pd(p);};
+  static void store(double* p, Real a) {_mm256_storeu_pd(p, a);};
+  static Real set(double a) {return _mm256_set1_pd(a);};
+  static Real add(Real a, Real b) {return _mm256_add_pd(a, b);};
+  static Real sub(Real a, Real b) {return _mm256_sub_pd(a, b);};
+  static Real mul(Real a, Real b) {return _mm256_mul_pd(a, b);};
+  static Real div(Real a, Real b) {return _mm256_div_pd(a, b);};
+  static Real sqrt(Real a) {return _mm256_sqrt_pd(a);};
+  static Real neg(Real a) {return _mm256_xor_pd(a, _mm256_set1_pd(-0.));};
+  static Real abs(Real a) {return _mm256_andnot_pd(_mm256_set1_pd(-0.), a);};
+  // std::min(a, b) = (b < a) ? b : a and std::max(a, b) = (a < b) ? b : a
+  static Real min(Real a, Real b) {return _mm256_min_pd(b, a);};
+  static Real max(Real a, Real b) {return _mm256_max_pd(b, a);};
+  static Mask lt(Real a, Real b) {return _mm256_cmp_pd(a, b, _CMP_LT_OQ);};
+  static Mask le(Real a, Real b) {return _mm256_cmp_pd(a, b, _CMP_LE_OQ);};
+  static Mask land(Mask a, Mask b) {return _mm256_and_pd(a, b);};
+  static Real select(Mask m, Real a, Real b) {return _mm256_blendv_pd(b, a, m);};
+  static double reduceMax(Real a)
+  {
+    double lanes[4];
+    _mm256_storeu_pd(lanes, a);
+    return std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+  };
+  static double reduceSum(Real a)
+  {
+    double lanes[4];
+    _mm256_storeu_pd(lanes, a);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  };
+};
+
+namespace avx2
+{
+  typedef AVX2Pack Pack;
+#include "FluxKernelsBody.h"
+}
+#pragma GCC pop_options
+
+
+// Eight doubles in an AVX-512 register, with mask registers for the blends
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+struct AVX512Pack
+{
+  typedef __m512d Real;
+  typedef __mmask8 Mask;
+  static const int width = 8;
+
+  static Real load(const double* p) {return _mm512_loadu_pd(p);};
+  static void store(double* p, Real a) {_mm512_storeu_pd(p, a);};
+  static Real set(double a) {return _mm512_set1_pd(a);};
+  static Real add(Real a, Real b) {return _mm512_add_pd(a, b);};
+  static Real sub(Real a, Real b) {return _mm512_sub_pd(a, b);};
+  static Real mul(Real a, Real b) {return _mm512_mul_pd(a, b);};
+  static Real div(Real a, Real b) {return _mm512_div_pd(a, b);};
+  static Real sqrt(Real a) {return _mm512_sqrt_pd(a);};
+  static Real neg(Real a)
+  {
+    return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(a), _mm512_set1_epi64(0x8000000000000000LL)));
+  };
+  static Real abs(Real a) {return _mm512_abs_pd(a);};
+  static Real min(Real a, Real b) {return _mm512_min_pd(b, a);};
+  static Real max(Real a, Real b) {return _mm512_max_pd(b, a);};
+  static Mask lt(Real a, Real b) {return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ);};
+  static Mask le(Real a, Real b) {return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ);};
+  static Mask land(Mask a, Mask b) {return a & b;};
+  static Real select(Mask m, Real a, Real b) {return _mm512_mask_blend_pd(m, b, a);};
+  static double reduceMax(Real a)
+  {
+    double lanes[8];
+    _mm512_storeu_pd(lanes, a);
+    double res(lanes[0]);
+    for (int i(1) ; i < 8 ; ++i)
+      res = std::max(res, lanes[i]);
+    return res;
+  };
+  static double reduceSum(Real a) {return _mm512_reduce_add_pd(a);};
+};
+
+namespace avx512
+{
+  typedef AVX512Pack Pack;
+#include "FluxKernelsBody.h"
+}
+#pragma GCC pop_options
+#endif // FLUX_KERNELS_X86
+
+
+
+//--------------------------------------------------//
+//---------------Run-time dispatching---------------//
+//--------------------------------------------------//
+struct FluxKernelsTable
+{
+  double (*laxFriedrichs)(const FluxKernelData&, double, double);
+  double (*rusanov)(const FluxKernelData&, double);
+  double (*hll)(const FluxKernelData&, double);
+  const char* name;
+};
+
+// Pick the widest instruction set supported by the processor
+static FluxKernelsTable selectFluxKernels()
+{
+#ifdef FLUX_KERNELS_X86
+  if (__builtin_cpu_supports("avx512f"))
+    {
+      FluxKernelsTable table = {avx512::laxFriedrichsFluxes, avx512::rusanovFluxes, avx512::hllFluxes, "AVX-512"};
+      return table;
+    }
+  if (__builtin_cpu_supports("avx2"))
+    {
+      FluxKernelsTable table = {avx2::laxFriedrichsFluxes, avx2::rusanovFluxes, avx2::hllFluxes, "AVX2"};
+      return table;
+    }
+#endif
+  FluxKernelsTable table = {scalar::laxFriedrichsFluxes, scalar::rusanovFluxes, scalar::hllFluxes, "scalar"};
+  return table;
+}
+
+static const FluxKernelsTable& fluxKernels()
+{
+  static const FluxKernelsTable table(selectFluxKernels());
+  return table;
+}
+
+
+
+double laxFriedrichsFluxes(const FluxKernelData& data, double g, double b)
+{
+  return fluxKernels().laxFriedrichs(data, g, b);
+}
+
+double rusanovFluxes(const FluxKernelData& data, double g)
+{
+  return fluxKernels().rusanov(data, g);
+}
+
+double hllFluxes(const FluxKernelData& data, double g)
+{
+  return fluxKernels().hll(data, g);
+}
+
+const char* fluxKernelsInstructionSet()
+{
+  return fluxKernels().name;
+}
@@ -0,0 +1,37 @@
+#ifndef FLUX_KERNELS_H
+#define FLUX_KERNELS_H
+
+
+
+// Batched numerical fluxes of the 1D St-Venant equations.
+//
+// The kernels compute the flux at n interfaces at once, from the left and
+// right states stored as separate contiguous h/q arrays, and return the
+// largest wave speed |lambda| met. They give exactly the same results as
+// LaxFriedrichs/Rusanov/HLL::numFlux. The AVX-512 or AVX2 version is chosen
+// at run time according to the processor, with a scalar fallback.
+struct FluxKernelData
+{
+  // Number of interfaces
+  int n;
+  // States at the left and at the right of each interface
+  const double* hG;
+  const double* qG;
+  const double* hD;
+  const double* qD;
+  // Fluxes through each interface
+  double* Fh;
+  double* Fq;
+};
+
+// Lax-Friedrichs flux with numerical viscosity b = dx/dt
+double laxFriedrichsFluxes(const FluxKernelData& data, double g, double b);
+// Rusanov flux
+double rusanovFluxes(const FluxKernelData& data, double g);
+// HLL flux
+double hllFluxes(const FluxKernelData& data, double g);
+
+// Instruction set used by the kernels ("AVX-512", "AVX2" or "scalar")
+const char* fluxKernelsInstructionSet();
+
+#endif // FLUX_KERNELS_H
@@ -0,0 +1,203 @@
+// Body of the batched flux kernels, written once for a generic pack type P
+// holding P::width doubles (see FluxKernels.cpp for the available packs).
+//
+// This file has no include guard on purpose : FluxKernels.cpp includes it
+// once per instruction set, inside a namespace compiled for that instruction
+// set. Do not include it anywhere else.
+//
+// Every branch of numFlux is computed and the right one is picked with
+// masked blends. The operations are done in the same order as in numFlux so
+// that the results are bitwise identical.
+
+
+
+// Physical flux (see Physics::physicalFlux)
+template<class P>
+inline void physicalFlux(typename P::Real h, typename P::Real q, typename P::Real halfG,
+                         typename P::Real& F0, typename P::Real& F1)
+{
+  typedef typename P::Real Real;
+  Real zero(P::set(0.));
+  q = P::select(P::le(h, zero), zero, q);
+  F0 = q;
+  F1 = P::add(P::div(P::mul(q, q), h), P::mul(P::mul(halfG, h), h));
+}
+
+
+
+// Eigenvalues of the flux jacobian (see Physics::computeWaveSpeed)
+template<class P>
+inline void waveSpeeds(typename P::Real hG, typename P::Real qG, typename P::Real hD, typename P::Real qD,
+                       typename P::Real g, typename P::Real& lambda1, typename P::Real& lambda2)
+{
+  typedef typename P::Real Real;
+  Real zero(P::set(0.)), small(P::set(1e-6));
+  Real uG(P::select(P::lt(hG, small), zero, P::div(qG, hG)));
+  Real uD(P::select(P::lt(hD, small), zero, P::div(qD, hD)));
+  Real cG(P::sqrt(P::mul(g, hG))), cD(P::sqrt(P::mul(g, hD)));
+  lambda1 = P::min(P::sub(uG, cG), P::sub(uD, cD));
+  lambda2 = P::max(P::add(uG, cG), P::add(uD, cD));
+}
+
+
+
+struct LaxFriedrichsFlux
+{
+  double g, halfG, b;
+
+  template<class P>
+  typename P::Real compute(typename P::Real hG, typename P::Real qG, typename P::Real hD, typename P::Real qD,
+                           typename P::Real& Fh, typename P::Real& Fq) const
+  {
+    typedef typename P::Real Real;
+    Real half(P::set(0.5)), B(P::set(b));
+    Real lambda1, lambda2;
+    waveSpeeds<P>(hG, qG, hD, qD, P::set(g), lambda1, lambda2);
+
+    Real FG0, FG1, FD0, FD1;
+    physicalFlux<P>(hG, qG, P::set(halfG), FG0, FG1);
+    physicalFlux<P>(hD, qD, P::set(halfG), FD0, FD1);
+    Fh = P::mul(half, P::sub(P::add(FD0, FG0), P::mul(B, P::sub(hD, hG))));
+    Fq = P::mul(half, P::sub(P::add(FD1, FG1), P::mul(B, P::sub(qD, qG))));
+
+    return P::max(P::abs(lambda1), P::abs(lambda2));
+  }
+};
+
+
+
+struct RusanovFlux
+{
+  double g, halfG;
+
+  template<class P>
+  typename P::Real compute(typename P::Real hG, typename P::Real qG, typename P::Real hD, typename P::Real qD,
+                           typename P::Real& Fh, typename P::Real& Fq) const
+  {
+    typedef typename P::Real Real;
+    typedef typename P::Mask Mask;
+    Real zero(P::set(0.)), half(P::set(0.5)), small(P::set(1e-6));
+    Real lambda1, lambda2;
+    waveSpeeds<P>(hG, qG, hD, qD, P::set(g), lambda1, lambda2);
+    Real b(P::max(P::abs(lambda1), P::abs(lambda2)));
+
+    Real FG0, FG1, FD0, FD1;
+    physicalFlux<P>(hG, qG, P::set(halfG), FG0, FG1);
+    physicalFlux<P>(hD, qD, P::set(halfG), FD0, FD1);
+
+    // Wet/wet, dry/wet, wet/dry, dry/dry
+    Mask wetG(P::lt(small, hG)), wetD(P::lt(small, hD));
+    Mask dryG(P::lt(hG, small)), dryD(P::lt(hD, small));
+    Mask wetWet(P::land(wetG, wetD)), dryWet(P::land(dryG, wetD)), wetDry(P::land(dryD, wetG));
+    Fh = P::select(wetWet, P::mul(half, P::sub(P::add(FD0, FG0), P::mul(b, P::sub(hD, hG)))),
+         P::select(dryWet, P::mul(half, P::sub(FD0, P::mul(b, hD))),
+         P::select(wetDry, P::mul(half, P::add(FG0, P::mul(b, hG))), zero)));
+    Fq = P::select(wetWet, P::mul(half, P::sub(P::add(FD1, FG1), P::mul(b, P::sub(qD, qG)))),
+         P::select(dryWet, P::mul(half, P::sub(FD1, P::mul(b, qD))),
+         P::select(wetDry, P::mul(half, P::add(FG1, P::mul(b, qG))), zero)));
+
+    return b;
+  }
+};
+
+
+
+struct HLLFlux
+{
+  double g, halfG;
+
+  template<class P>
+  typename P::Real compute(typename P::Real hG, typename P::Real qG, typename P::Real hD, typename P::Real qD,
+                           typename P::Real& Fh, typename P::Real& Fq) const
+  {
+    typedef typename P::Real Real;
+    typedef typename P::Mask Mask;
+    Real zero(P::set(0.)), small(P::set(1e-6));
+    Real lambda1, lambda2;
+    waveSpeeds<P>(hG, qG, hD, qD, P::set(g), lambda1, lambda2);
+
+    Real FG0, FG1, FD0, FD1;
+    physicalFlux<P>(hG, qG, P::set(halfG), FG0, FG1);
+    physicalFlux<P>(hD, qD, P::set(halfG), FD0, FD1);
+
+    Mask wetG(P::lt(small, hG)), wetD(P::lt(small, hD));
+    Mask dryG(P::lt(hG, small)), dryD(P::lt(hD, small));
+
+    // 0 <= lambda1 : upwind flux from the left
+    Mask right(P::le(zero, lambda1));
+    Real FhRight(P::select(dryG, zero, FG0)), FqRight(P::select(dryG, zero, FG1));
+
+    // lambda1 < 0 < lambda2 : HLL average
+    Mask star(P::land(P::lt(lambda1, zero), P::lt(zero, lambda2)));
+    Real dLambda(P::sub(lambda2, lambda1)), lambda21(P::mul(lambda2, lambda1));
+    Mask wetWet(P::land(wetG, wetD)), dryWet(P::land(dryG, wetD)), wetDry(P::land(dryD, wetG));
+    Real FhStar(P::select(wetWet, P::div(P::add(P::sub(P::mul(lambda2, FG0), P::mul(lambda1, FD0)), P::mul(lambda21, P::sub(hD, hG))), dLambda),
+                P::select(dryWet, P::div(P::add(P::mul(P::neg(lambda1), FD0), P::mul(lambda21, hD)), dLambda),
+                P::select(wetDry, P::div(P::add(P::mul(lambda2, FG0), P::mul(lambda21, P::neg(hG))), dLambda), zero))));
+    Real FqStar(P::select(wetWet, P::div(P::add(P::sub(P::mul(lambda2, FG1), P::mul(lambda1, FD1)), P::mul(lambda21, P::sub(qD, qG))), dLambda),
+                P::select(dryWet, P::div(P::add(P::mul(P::neg(lambda1), FD1), P::mul(lambda21, qD)), dLambda),
+                P::select(wetDry, P::div(P::add(P::mul(lambda2, FG1), P::mul(lambda21, P::neg(qG))), dLambda), zero))));
+
+    // lambda2 <= 0 : upwind flux from the right
+    Mask left(P::le(lambda2, zero));
+    Real FhLeft(P::select(dryD, zero, FD0)), FqLeft(P::select(dryD, zero, FD1));
+
+    Fh = P::select(right, FhRight, P::select(star, FhStar, P::select(left, FhLeft, zero)));
+    Fq = P::select(right, FqRight, P::select(star, FqStar, P::select(left, FqLeft, zero)));
+
+    return P::max(P::abs(lambda1), P::abs(lambda2));
+  }
+};
+
+
+
+// Run a flux over all the interfaces, P::width at a time, the last ones
+// one at a time. Returns the largest wave speed, or NaN if one of them is
+// NaN : max drops them, so they are caught by the sum of the wave speeds.
+template<class P, class Flux>
+double runFluxKernel(const FluxKernelData& data, const Flux& flux)
+{
+  typedef typename P::Real Real;
+  Real maxWaveSpeeds(P::set(0.)), sumWaveSpeeds(P::set(0.));
+  int i(0);
+  for ( ; i + P::width <= data.n ; i += P::width)
+    {
+      Real Fh, Fq;
+      Real waveSpeed(flux.template compute<P>(P::load(data.hG + i), P::load(data.qG + i),
+                                              P::load(data.hD + i), P::load(data.qD + i), Fh, Fq));
+      P::store(data.Fh + i, Fh);
+      P::store(data.Fq + i, Fq);
+      maxWaveSpeeds = P::max(maxWaveSpeeds, waveSpeed);
+      sumWaveSpeeds = P::add(sumWaveSpeeds, waveSpeed);
+    }
+  double maxWaveSpeed(P::reduceMax(maxWaveSpeeds)), sumWaveSpeed(P::reduceSum(sumWaveSpeeds));
+  for ( ; i < data.n ; ++i)
+    {
+      double waveSpeed(flux.template compute<ScalarPack>(data.hG[i], data.qG[i], data.hD[i], data.qD[i],
+                                                          data.Fh[i], data.Fq[i]));
+      maxWaveSpeed = std::max(maxWaveSpeed, waveSpeed);
+      sumWaveSpeed += waveSpeed;
+    }
+  return (std::isnan(sumWaveSpeed) ? sumWaveSpeed : maxWaveSpeed);
+}
+
+
+
+// Entry points for this instruction set
+double laxFriedrichsFluxes(const FluxKernelData& data, double g, double b)
+{
+  LaxFriedrichsFlux flux = {g, 0.5*g, b};
+  return runFluxKernel<Pack>(data, flux);
+}
+
+double rusanovFluxes(const FluxKernelData& data, double g)
+{
+  RusanovFlux flux = {g, 0.5*g};
+  return runFluxKernel<Pack>(data, flux);
+}
+
+double hllFluxes(const FluxKernelData& data, double g)
+{
+  HLLFlux flux = {g, 0.5*g};
+  return runFluxKernel<Pack>(data, flux);
+}
@@ -0,0 +1,44 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include "Eigen/Eigen/Dense"
+
+
+
+// Storage layouts of the matrices with one row per cell and one column per
+// conserved variable (solution, flux vector and source term).
+//   - SoALayout : column-major, each variable is contiguous (structure of arrays)
+//   - AoSLayout : row-major, the variables of a cell are contiguous (array of structures)
+// The layout is chosen at compile time with the LAYOUT variable of the Makefile.
+struct SoALayout
+{
+  static const int storageOrder = Eigen::ColMajor;
+};
+
+struct AoSLayout
+{
+  static const int storageOrder = Eigen::RowMajor;
+};
+
+template<class Layout, int nVariables>
+using CellMatrix = Eigen::Matrix<double, Eigen::Dynamic, nVariables, Layout::storageOrder>;
+
+#ifdef AOS_LAYOUT
+typedef AoSLayout StateLayout;
+#else
+typedef SoALayout StateLayout;
+#endif
+
+// Conserved variables (h, q) on each cell
+typedef CellMatrix<StateLayout, 2> StateMatrix;
+
+// One variable on each cell, whatever the layout : a column of a StateMatrix,
+// or the column of one member in an EnsembleMatrix
+typedef Eigen::Ref<const Eigen::VectorXd, 0, Eigen::InnerStride<> > CellValues;
+
+// One variable for all the members of an ensemble run (see Ensemble.h) : one
+// row per cell and one column per member, so that the members of a cell are
+// contiguous and the loops over the members are vectorized
+typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> EnsembleMatrix;
+
+#endif // LAYOUT_H
@@ -5,6 +5,7 @@
 #include "DataFile.h"
 #include "termcolor.h"
 #include <fstream>
+#include <cmath>
 
 Mesh::Mesh()
 {
@@ -36,6 +37,7 @@ void Mesh::Initialize()
     {
       _cellCenters(i) = _xmin + (i + 0.5) * _dx;
     }
+  _locator.Initialize(_cellCenters);
 #if VERBOSITY>0
   std::cout << termcolor::green << "SUCCESS::MESH : Mesh generated succesfully !" << std::endl;
   std::cout << termcolor::reset << "====================================================================================================" << std::endl << std::endl;
@@ -4,6 +4,7 @@
 #include "Eigen/Eigen/Dense"
 #include "Eigen/Eigen/Sparse"
 #include "DataFile.h"
+#include "MeshLocator.h"
 #include <fstream>
 
 
@@ -20,6 +21,8 @@ private:
   double _dx;
   int _numberOfCells;
   Eigen::VectorXd _cellCenters;
+  // Localisation d'un point dans le maillage
+  MeshLocator _locator;
 
 public:
   // Constructeurs
@@ -39,6 +42,11 @@ public:
   double getSpaceStep() const {return _dx;};
   double getxMin() const {return _xmin;};
   double getxMax() const {return _xmax;};
+
+  // Indice de la cellule dont le centre est le plus proche de x
+  int findNearestCell(double x) const {return _locator.findNearest(x);};
+  // Indice i tel que x est entre les centres des cellules i et i+1
+  int findCellInterval(double x) const {return _locator.findInterval(x);};
 };
 
 
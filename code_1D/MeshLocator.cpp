@@ -0,0 +1,80 @@
+#include "MeshLocator.h"
+#include "termcolor.h"
+
+#include <iostream>
+#include <algorithm>
+
+
+
+MeshLocator::MeshLocator():
+  _x0(0.), _dx(1.), _isUniform(true)
+{
+}
+
+
+
+void MeshLocator::Initialize(const Eigen::VectorXd& nodes)
+{
+  int n(nodes.size());
+  _nodes = nodes;
+  _x0 = (n > 0 ? nodes(0) : 0.);
+  _dx = 1.;
+  _isUniform = true;
+  if (n < 2)
+    return;
+
+  // Plus petit et plus grand écart entre deux noeuds
+  double minStep(nodes(1) - nodes(0)), maxStep(minStep);
+  for (int i(1) ; i < n - 1 ; ++i)
+    {
+      minStep = std::min(minStep, nodes(i+1) - nodes(i));
+      maxStep = std::max(maxStep, nodes(i+1) - nodes(i));
+    }
+  if (!(minStep > 0.))
+    {
+      std::cout << termcolor::red << "ERROR::LOCATOR : The nodes must be strictly increasing." << std::endl;
+      std::cout << termcolor::reset;
+      exit(-1);
+    }
+  _isUniform = (maxStep - minStep <= 1e-9 * maxStep);
+  _dx = (nodes(n - 1) - nodes(0)) / (n - 1);
+}
+
+
+
+int MeshLocator::findInterval(double x) const
+{
+  int n(_nodes.size());
+  if (n < 2)
+    return 0;
+
+  int i(0);
+  if (_isUniform)
+    {
+      double s((x - _x0) / _dx);
+      if (!(s > 0.))
+        return 0;
+      i = (s < n - 1 ? static_cast<int>(s) : n - 2);
+      // Arrondi de s sur un noeud
+      if (i < n - 2 && x >= _nodes(i+1))
+        ++i;
+      else if (i > 0 && x < _nodes(i))
+        --i;
+    }
+  else
+    {
+      i = std::upper_bound(_nodes.data(), _nodes.data() + n, x) - _nodes.data() - 1;
+    }
+  return std::min(std::max(i, 0), n - 2);
+}
+
+
+
+int MeshLocator::findNearest(double x) const
+{
+  if (_nodes.size() < 2)
+    return 0;
+
+  int i(findInterval(x));
+  return (x - _nodes(i) <= _nodes(i+1) - x ? i : i + 1);
+}
@@ -0,0 +1,41 @@
+#ifndef MESH_LOCATOR_H
+#define MESH_LOCATOR_H
+
+#include "Eigen/Eigen/Dense"
+
+
+
+// Localise un point x parmi des noeuds triés (centres des cellules du
+// maillage, abscisses d'un fichier de topographie...).
+//
+// Si les noeuds sont régulièrement espacés, l'indice est calculé
+// directement à partir de x, en O(1). Sinon, il est trouvé par dichotomie,
+// en O(log n).
+class MeshLocator
+{
+private:
+  // Noeuds, strictement croissants
+  Eigen::VectorXd _nodes;
+  // Premier noeud et pas, noeuds régulièrement espacés
+  double _x0, _dx;
+  bool _isUniform;
+
+public:
+  // Constructeur
+  MeshLocator();
+
+  // Initialisation à partir des noeuds
+  void Initialize(const Eigen::VectorXd& nodes);
+
+  // Getters
+  bool isUniform() const {return _isUniform;};
+  int getNumberOfNodes() const {return _nodes.size();};
+
+  // Indice i de l'intervalle [x_i, x_i+1[ qui contient x. En dehors des
+  // noeuds, le premier ou le dernier intervalle (extrapolation).
+  int findInterval(double x) const;
+  // Indice du noeud le plus proche de x
+  int findNearest(double x) const;
+};
+
+#endif // MESH_LOCATOR_H
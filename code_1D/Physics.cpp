@@ -1,11 +1,14 @@
 #include "Physics.h"
 #include "DataFile.h"
 #include "termcolor.h"
+#include "Profiler.h"
 #include "Eigen/Eigen/Dense"
 #include "Eigen/Eigen/Sparse"
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <vector>
 #include <regex>
 #include <cmath>
 #include <algorithm>
@@ -22,8 +25,8 @@ Physics::Physics()
 
 
 
-Physics::Physics(DataFile* DF, Mesh* mesh):
-  _DF(DF), _mesh(mesh), _xmin(mesh->getxMin()), _xmax(mesh->getxMax()), _g(_DF->getGravityAcceleration()), _nCells(mesh->getNumberOfCells()), _i(0)
+Physics::Physics(const DataFile* DF, const Mesh* mesh):
+  _DF(DF), _mesh(mesh), _plan(DF->getRunPlan()), _xmin(mesh->getxMin()), _xmax(mesh->getxMax()), _g(_DF->getGravityAcceleration()), _nCells(mesh->getNumberOfCells())
 {
 }
 
@@ -32,14 +35,14 @@ Physics::Physics(DataFile* DF, Mesh* mesh):
 //--------------------------------------------//
 //---------------Initialization---------------//
 //--------------------------------------------//
-void Physics::Initialize(DataFile* DF, Mesh* mesh)
+void Physics::Initialize(const DataFile* DF, const Mesh* mesh)
 {
   _DF = DF;
   _mesh = mesh;
+  _plan = DF->getRunPlan();
   _xmin = mesh->getxMin();
   _xmax = mesh->getxMax();
   _g = DF->getGravityAcceleration();
-  _i = 0;
   _nCells = mesh->getNumberOfCells();
   this->Initialize();
 }
@@ -55,10 +58,10 @@ void Physics::Initialize()
 #endif
 
   // Build
-  _source.resize(_nCells, 2);
   buildTopography();
+  buildSourceCoefficient();
   buildInitialCondition();
-  if (_DF->getLeftBC() == "DataFile" || _DF->getRightBC() == "DataFile")
+  if (_plan.leftBC == BoundaryConditionType::DataFile || _plan.rightBC == BoundaryConditionType::DataFile)
     buildExpBoundaryData();
 
   // Logs
@@ -79,15 +82,15 @@ void Physics::buildTopography()
   const Eigen::VectorXd& cellCenters(_mesh->getCellCenters());
   
   // Flat botttom
-  if (_DF->getTopographyType() == "FlatBottom")
+  if (_plan.topography == TopographyType::FlatBottom)
     {
       _topography.setZero();
     }
   // Thacker test case topography
-  else if (_DF->getTopographyType() == "Thacker")
+  else if (_plan.topography == TopographyType::Thacker)
     {
       _topography.setZero();
-      double xmin(_DF->getXmin()), xmax(_DF->getXmax()), L(xmax - xmin);
+      double xmin(_plan.xmin), xmax(_plan.xmax), L(xmax - xmin);
       double a(1.), h0(0.5);
       for (int i(0) ; i < _nCells ; ++i)
         {
@@ -96,7 +99,7 @@ void Physics::buildTopography()
         }
     }
   // Bump topography
-  else if (_DF->getTopographyType() == "Bump")
+  else if (_plan.topography == TopographyType::Bump)
     {
       _topography.setZero();
       for (int i(0) ; i < _nCells ; ++i)
@@ -107,12 +110,12 @@ void Physics::buildTopography()
         }
     }
  // Read the topography in a data file
-  else if (_DF->getTopographyType() == "File")
+  else if (_plan.topography == TopographyType::File)
     {
       const std::string topoFile(_DF->getTopographyFile());
       std::ifstream topoStream(topoFile);
       std::string line, properLine;
-      double size;
+      int size(0);
       int i(0);
       if (!topoStream.is_open())
         {
@@ -127,30 +130,31 @@ void Physics::buildTopography()
         }
 #endif
       topoStream >> size;
-      _fileTopography.resize(size + 1, 2);
-      while(getline(topoStream, line))
+      _fileTopography.resize(size, 2);
+      while(getline(topoStream, line) && i < size)
         {
           properLine = regex_replace(line, std::regex(",") , std::string(" "));
           std::stringstream ss(properLine);
-          ss >> _fileTopography(i,0) >> _fileTopography(i,1);
-          ++i;
+          if (ss >> _fileTopography(i,0) >> _fileTopography(i,1))
+            ++i;
+        }
+      _fileTopography.conservativeResize(i, 2);
+      if (i < 2)
+        {
+          std::cout << termcolor::red << "ERROR::TOPOGRAPHY : At least two points are needed in the topography file : " << topoFile << std::endl;
+          std::cout << termcolor::reset << "====================================================================================================" << std::endl;
+          exit(-1);
         }
 
       // Ajuste la topographie au domaine (interpolation lineaire)
-      double x1(_fileTopography(0,0)), z1(_fileTopography(0,1));
-      double x2(_fileTopography(1,0)), z2(_fileTopography(1,1));
-      int j(0);
+      MeshLocator fileLocator;
+      fileLocator.Initialize(_fileTopography.col(0));
       for (int k(0) ; k < _nCells ; ++k)
         {
           double x(cellCenters(k));
-          while (!(x1 < x && x <= x2))
-            {
-              ++j;
-              x1 = _fileTopography(j,0);
-              x2 = _fileTopography(j+1,0);
-            }
-          z1 = _fileTopography(j,1);
-          z2 = _fileTopography(j+1,1);
+          int j(fileLocator.findInterval(x));
+          double x1(_fileTopography(j,0)), z1(_fileTopography(j,1));
+          double x2(_fileTopography(j+1,0)), z2(_fileTopography(j+1,1));
           _topography(k) = z1 + (x - x1) * (z2 - z1) / (x2 - x1);
         }
 
@@ -182,7 +186,7 @@ void Physics::buildInitialCondition()
 {
   _Sol0.resize(_nCells, 2);
   const Eigen::VectorXd& cellCenters(_mesh->getCellCenters());
-  if (_DF->getInitialCondition() == "UniformHeightAndDischarge")
+  if (_plan.initialCondition == InitialConditionType::UniformHeightAndDischarge)
     {
       double H0(_DF->getInitialHeight()), q0(_DF->getInitialDischarge());
       for (int i(0) ; i < _nCells ; ++i)
@@ -191,7 +195,7 @@ void Physics::buildInitialCondition()
           _Sol0(i,1) = q0;
         }
     }
-  else if (_DF->getInitialCondition() == "DamBreakWet")
+  else if (_plan.initialCondition == InitialConditionType::DamBreakWet)
     {
       _Sol0.col(1).setZero();
       double Hl(2.), Hr(1.);
@@ -207,7 +211,7 @@ void Physics::buildInitialCondition()
             }
         }
     }
-  else if (_DF->getInitialCondition() == "DamBreakDry")
+  else if (_plan.initialCondition == InitialConditionType::DamBreakDry)
     {
       _Sol0.col(1).setZero();
       double Hl(2.), Hr(0.);
@@ -223,10 +227,10 @@ void Physics::buildInitialCondition()
             }
         }
     }
-  else if (_DF->getInitialCondition() == "Thacker")
+  else if (_plan.initialCondition == InitialConditionType::Thacker)
     {
       _Sol0.col(1).setZero();
-      double xmin(_DF->getXmin()), xmax(_DF->getXmax()), L(xmax - xmin);
+      double xmin(_plan.xmin), xmax(_plan.xmax), L(xmax - xmin);
       double a(1.), h0(0.5);
       double x1(- 0.5 - a + 0.5 * L), x2(- 0.5 + a + 0.5 * L);
       for (int i(0) ; i < _nCells ; ++i)
@@ -240,7 +244,7 @@ void Physics::buildInitialCondition()
             _Sol0(i,0) = 0.;
         }
     }
-  else if (_DF->getInitialCondition() == "SinePerturbation")
+  else if (_plan.initialCondition == InitialConditionType::SinePerturbation)
     {
       _Sol0.col(1).setZero();
       double H(2.);
@@ -257,7 +261,7 @@ void Physics::buildInitialCondition()
             }
         }
     }
-  else if (_DF->getInitialCondition() == "File")
+  else if (_plan.initialCondition == InitialConditionType::File)
     {
       const std::string initFile(_DF->getInitFile());
       std::ifstream initStream(initFile);
@@ -291,11 +295,19 @@ void Physics::buildInitialCondition()
 //---------------Build Experimental Boundary Data---------------//
 //--------------------------------------------------------------//
 void Physics::buildExpBoundaryData()
-{  
-  const std::string expDataFile(_DF->getLeftBCDataFile());
+{
+  if (_plan.leftBC == BoundaryConditionType::DataFile)
+    readExpBoundaryData(_DF->getLeftBCDataFile(), _leftBoundaryData);
+  if (_plan.rightBC == BoundaryConditionType::DataFile)
+    readExpBoundaryData(_DF->getRightBCDataFile(), _rightBoundaryData);
+}
+
+
+
+void Physics::readExpBoundaryData(const std::string& expDataFile, TimeSeries& expData) const
+{
   std::ifstream expDataStream(expDataFile);
-  std::string line, properLine;
-  int i(0);
+  std::string line;
   if (!expDataStream.is_open())
     {
       std::cout << termcolor::red << "ERROR::EXPDATA : Unable to open the experimental data file : " << expDataFile << std::endl;
@@ -309,20 +321,41 @@ void Physics::buildExpBoundaryData()
     }
 #endif
   
-  // First line indicates the number of experimental values
-  getline(expDataStream, line);
-  int size(0);
-  std::stringstream ss(line);
-  ss >> size;
-  _expBoundaryData.resize(size,2);
-  
-  // Then we read the data
+  // One measure (t, h) per line, separated by commas or spaces. Other
+  // columns are ignored, and so is a first line with only the number of
+  // experimental values
+  std::vector<double> times, values;
+  bool isFirstLine(true);
   while(getline(expDataStream, line))
     {
-      properLine = regex_replace(line, std::regex(",") , std::string(" "));
-      std::stringstream ss(properLine);
-      ss >> _expBoundaryData(i,0) >> _expBoundaryData(i,1);
-      ++i;
+      std::replace(line.begin(), line.end(), ',', ' ');
+      std::stringstream ss(line);
+      double time, value;
+      if (!(ss >> time))
+        continue;
+      if (!(ss >> value))
+        {
+          if (isFirstLine)
+            {
+              isFirstLine = false;
+              continue;
+            }
+          std::cout << termcolor::red << "ERROR::EXPDATA : Missing value at t = " << time << " in " << expDataFile << std::endl;
+          std::cout << termcolor::reset << "====================================================================================================" << std::endl;
+          exit(-1);
+        }
+      isFirstLine = false;
+      times.push_back(time);
+      values.push_back(value);
+    }
+  int size(times.size());
+  expData.Initialize(Eigen::Map<Eigen::VectorXd>(times.data(), size), Eigen::Map<Eigen::VectorXd>(values.data(), size),
+                     _plan.boundaryDataInterpolation);
+  if (expData.getFinalTime() < _DF->getFinalTime())
+    {
+      std::cout << termcolor::yellow << "WARNING::EXPDATA : The data of " << expDataFile << " stops at t = " << expData.getFinalTime()
+                << ", its last value is kept until the final time." << std::endl;
+      std::cout << termcolor::reset;
     }
 #if VERBOSITY>0
   std::cout << termcolor::green << "SUCCESS::EXPDATA : Experimental data was successsfully built." << std::endl;
@@ -331,50 +364,67 @@ void Physics::buildExpBoundaryData()
 }
 
 
+
+BoundaryForcing Physics::getBoundaryForcing() const
+{
+  BoundaryForcing forcing;
+  forcing.leftImposedHeight = _plan.leftBCImposedHeight;
+  forcing.leftImposedDischarge = _plan.leftBCImposedDischarge;
+  forcing.rightImposedHeight = _plan.rightBCImposedHeight;
+  forcing.rightImposedDischarge = _plan.rightBCImposedDischarge;
+  forcing.leftData = &_leftBoundaryData;
+  forcing.rightData = &_rightBoundaryData;
+  return forcing;
+}
+
+
 //-----------------------------------------------//
 //---------------Build Source Term---------------//
 //-----------------------------------------------//
-void Physics::buildSourceTerm(const Eigen::Matrix<double, Eigen::Dynamic, 2>& Sol)
+// Coefficient du terme source de q, -g dz/dx dans chaque cellule. La
+// topographie ne change pas : il est calculé une fois pour toutes et le
+// terme source n'est plus qu'un produit avec h à chaque pas de temps.
+void Physics::buildSourceCoefficient()
 {
-  // Construit le terme source en fonction de la topographie.
-  _source.setZero();
   const Eigen::VectorXd& cellCenters(_mesh->getCellCenters());
+  _sourceCoefficient.resize(_nCells);
+  _sourceCoefficient.setZero();
   // Flat bottom
-  if (_DF->getTopographyType() == "FlatBottom")
+  if (_plan.topography == TopographyType::FlatBottom)
     {
       // Do nothing
     }
   // Bump topography
-  else if (_DF->getTopographyType() == "Bump")
+  else if (_plan.topography == TopographyType::Bump)
     {
       for (int i(0) ; i < _nCells ; ++i)
         {
           double x(cellCenters(i));
           if (8 < x  && x < 12)
-            _source(i,1) = _g * Sol(i,0) * 0.05 * 2. * (x - 10.);
+            _sourceCoefficient(i) = _g * 0.05 * 2. * (x - 10.);
         }
     }
   // Thacker test case topography
-  else if (_DF->getTopographyType() == "Thacker")
+  else if (_plan.topography == TopographyType::Thacker)
     {
+      double xmin(_plan.xmin), xmax(_plan.xmax), L(xmax - xmin);
+      double a(1.), h0(0.5);
       for (int i(0) ; i < _nCells ; ++i)
         {
-          double xmin(_DF->getXmin()), xmax(_DF->getXmax()), L(xmax - xmin);
-          double a(1.), h0(0.5);
           double x(cellCenters(i));
-          _source(i,1) = - _g * Sol(i,0) * h0 * (2. / pow(a,2) * (x - 0.5 * L));
+          _sourceCoefficient(i) = - _g * h0 * (2. / pow(a,2) * (x - 0.5 * L));
         }
     }
   // Topography file
-  else if (_DF->getTopographyType() == "File")
+  else if (_plan.topography == TopographyType::File)
     {
       double dx(_mesh->getSpaceStep());
-      _source(0,1) = - _g * Sol(0,0) * (-_topography(2) + 4.*_topography(1) - 3.*_topography(0))/(2.*dx);
+      _sourceCoefficient(0) = - _g * (-_topography(2) + 4.*_topography(1) - 3.*_topography(0))/(2.*dx);
       for (int i(1) ; i < _nCells - 1 ; ++i)
         {
-          _source(i,1) = - _g * Sol(i,0) * (_topography(i+1) - _topography(i-1))/(2. * dx);
+          _sourceCoefficient(i) = - _g * (_topography(i+1) - _topography(i-1))/(2. * dx);
         }
-      _source(_nCells - 1, 1) = - _g * Sol(_nCells - 1,0) * (3.*_topography(_nCells - 1) - 4.*_topography(_nCells - 2) + _topography(_nCells - 3))/(2.*dx);
+      _sourceCoefficient(_nCells - 1) = - _g * (3.*_topography(_nCells - 1) - 4.*_topography(_nCells - 2) + _topography(_nCells - 3))/(2.*dx);
     }
   // Not implemented
   else
@@ -387,27 +437,59 @@ void Physics::buildSourceTerm(const Eigen::Matrix<double, Eigen::Dynamic, 2>& So
 
 
 
+void Physics::buildSourceTerm(const StateMatrix& Sol, SolverState& state) const
+{
+  PROFILE_SCOPE(SourceTerm);
+  // Seule la composante q du terme source est non nulle
+  StateMatrix& source(state.source);
+  if (_plan.topography == TopographyType::FlatBottom)
+    {
+      source.setZero();
+      return;
+    }
+  source.col(0).setZero();
+  source.col(1) = _sourceCoefficient.cwiseProduct(Sol.col(0));
+}
+
+
+
+// Les membres d'une cellule sont contigus en mémoire : le produit par la
+// matrice diagonale est vectorisé sur les membres
+void Physics::buildSourceTerm(const EnsembleMatrix& h, EnsembleState& state) const
+{
+  PROFILE_SCOPE(SourceTerm);
+  if (_plan.topography == TopographyType::FlatBottom)
+    {
+      state.sourceQ.setZero();
+      return;
+    }
+  state.sourceQ.noalias() = _sourceCoefficient.asDiagonal() * h;
+}
+
+
+
 //--------------------------------------------------//
 //---------------Build Exact Solution---------------//
 //--------------------------------------------------//
-void Physics::buildExactSolution(double t)
+void Physics::buildExactSolution(double t, SolverState& state) const
 {
-  _exactSol.resize(_nCells, 2);
-  const std::string& testCase(_DF->getTestCase());
+  Eigen::Matrix<double, Eigen::Dynamic, 2>& exactSol(state.exactSol);
+  exactSol.resize(_nCells, 2);
+  const TestCaseType testCase(_plan.testCase);
   const Eigen::VectorXd& cellCenters(_mesh->getCellCenters());
   // Resting lake solutions
-  if (testCase == "RestingLake")
+  if (testCase == TestCaseType::RestingLake)
     {
       for (int i(0) ; i < _nCells ; ++i)
         {
-          _exactSol(i,0) = std::max(_DF->getLeftBCImposedHeight() - _topography(i), 0.);
-          _exactSol(i,1) = 0.;
+          exactSol(i,0) = std::max(_plan.leftBCImposedHeight - _topography(i), 0.);
+          exactSol(i,1) = 0.;
         }
     }
-  else if (testCase == "DamBreakWet" || testCase == "DamBreakDry")
+  else if (testCase == TestCaseType::DamBreakWet || testCase == TestCaseType::DamBreakDry)
     {
       // Mesh parameters
-      double xmin(_DF->getXmin()), xmax(_DF->getXmax());
+      double xmin(_plan.xmin), xmax(_plan.xmax);
       double xdam(0.5 * (xmax - xmin));
       // Parameters for the dichotomy
       double eps(1e-6);
@@ -422,12 +504,12 @@ void Physics::buildExactSolution(double t)
       // Velocity of the shock wave
       double v(0.);
       // Dam break on a wet domain
-      if (testCase == "DamBreakWet")
+      if (testCase == TestCaseType::DamBreakWet)
         {
           hG = 2.; hD = 1.;
         }
       // Dam break on a dry domain
-      else if (testCase == "DamBreakDry")
+      else if (testCase == TestCaseType::DamBreakDry)
         {
           hG = 2.; hD = 0.;
         }
@@ -468,30 +550,30 @@ void Physics::buildExactSolution(double t)
           double x(cellCenters(i));
           if (x <= xdam - cG * t)
             {
-              _exactSol(i,0) = hG;
-              _exactSol(i,1) = 0.;
+              exactSol(i,0) = hG;
+              exactSol(i,1) = 0.;
             }
           else if (x <= xdam + (2. * cG - 3. * cMid) * t)
             {
-              _exactSol(i,0) = 4. / (9. * _g) * pow(sqrt(_g * hG) - 0.5 * (x - xdam) / t, 2);
-              _exactSol(i,1) = _exactSol(i,0) * 2. / 3. * ((x - xdam) / t + sqrt(_g * hG));
+              exactSol(i,0) = 4. / (9. * _g) * pow(sqrt(_g * hG) - 0.5 * (x - xdam) / t, 2);
+              exactSol(i,1) = exactSol(i,0) * 2. / 3. * ((x - xdam) / t + sqrt(_g * hG));
             }
           else if (x <= xdam + v * t)
             {
-              _exactSol(i,0) = hMid;
-              _exactSol(i,1) = qMid;
+              exactSol(i,0) = hMid;
+              exactSol(i,1) = qMid;
             }
           else
             {
-              _exactSol(i,0) = hD;
-              _exactSol(i,1) = 0.;
+              exactSol(i,0) = hD;
+              exactSol(i,1) = 0.;
             }
         }
     }
   // Thacker test case
-  else if (testCase == "Thacker")
+  else if (testCase == TestCaseType::Thacker)
     {
-      double xmax(_DF->getXmax()), xmin(_DF->getXmin());
+      double xmax(_plan.xmax), xmin(_plan.xmin);
       double L(xmax - xmin);
       double a(1.);
       double h0(0.5);
@@ -502,22 +584,22 @@ void Physics::buildExactSolution(double t)
           double x(cellCenters(i));
           if (x1 <= x && x <= x2)
             {
-              _exactSol(i,0) = - h0 * (pow(1. / a * (x - 0.5 * L) + 1. / (2. * a) * cos(sqrt(2. * _g * h0) * t / a), 2) - 1);
-              _exactSol(i,1) = sqrt(2. * _g * h0) / (2. * a) * sin(sqrt(2. * _g * h0) * t / a);
+              exactSol(i,0) = - h0 * (pow(1. / a * (x - 0.5 * L) + 1. / (2. * a) * cos(sqrt(2. * _g * h0) * t / a), 2) - 1);
+              exactSol(i,1) = sqrt(2. * _g * h0) / (2. * a) * sin(sqrt(2. * _g * h0) * t / a);
             }
           else
             {
-              _exactSol(i,0) = 0.;
-              _exactSol(i,1) = 0.;
+              exactSol(i,0) = 0.;
+              exactSol(i,1) = 0.;
             }
         }
     }
   // Non hydrostatic stationnary solutions
-  else if (testCase == "SubcriticalFlow" || testCase == "TranscriticalFlowWithoutShock" || testCase == "TranscriticalFlowWithShock")
+  else if (testCase == TestCaseType::SubcriticalFlow || testCase == TestCaseType::TranscriticalFlowWithoutShock || testCase == TestCaseType::TranscriticalFlowWithShock)
     {
       double epsilon(1.0 / _nCells);
-      double qIn(_DF->getLeftBCImposedDischarge());
-      double hOut(_DF->getRightBCImposedHeight());
+      double qIn(_plan.leftBCImposedDischarge);
+      double hOut(_plan.rightBCImposedHeight);
       double hMiddle(pow(pow(qIn,2)/_g, 1./3.)); // = critical height
       double hMax(3.), zMax(0.2);
       double a(0.), b(0.), c(0.), d(0.);
@@ -525,10 +607,10 @@ void Physics::buildExactSolution(double t)
       // Discharge must be constant in the whole domain
       for (int i(0) ; i < _nCells ; ++i)
         {
-          _exactSol(i,1) = qIn;
+          exactSol(i,1) = qIn;
         }
       // Subcritical flow
-      if (testCase == "SubcriticalFlow")
+      if (testCase == TestCaseType::SubcriticalFlow)
         {
           for (int i(_nCells - 1) ; i >= 0  ; --i)
             {
@@ -540,11 +622,11 @@ void Physics::buildExactSolution(double t)
               if (i == _nCells - 1)
                 hnear = hOut;
               else
-                hnear = _exactSol(i+1, 0);
-              _exactSol(i,0) = exactHeight(p, q, a, b, hnear, hMax);
+                hnear = exactSol(i+1, 0);
+              exactSol(i,0) = exactHeight(p, q, a, b, hnear, hMax);
             }
         }
-      else if (testCase == "TranscriticalFlowWithoutShock")
+      else if (testCase == TestCaseType::TranscriticalFlowWithoutShock)
         {
           // Subcritical part (before the bump)
           for (int i(2. * _nCells / 5. - 1) ; i >= 0 ; --i)
@@ -557,24 +639,25 @@ void Physics::buildExactSolution(double t)
               if (i == 2. * _nCells / 5. - 1)
                 hnear = hMiddle;
               else
-                hnear = _exactSol(i+1, 0);
-              _exactSol(i,0) = exactHeight(p, q, a, b, hnear*(1+epsilon), hMax);
+                hnear = exactSol(i+1, 0);
+              exactSol(i,0) = exactHeight(p, q, a, b, hnear*(1+epsilon), hMax);
             }
           // Critical part (middle of the bump)
-          double z(_topography(2. * _nCells / 5.));
+          const int iMiddle(2. * _nCells / 5.);
+          double z(_topography(iMiddle));
           computeCoeffabcd(qIn, hMiddle, z, zMax, &a, &b, &c, &d);
           p = cardanP(a, b, c); q = cardanQ(a, b, c, d);
-          _exactSol(2. * _nCells / 5., 0) = exactHeight(p, q, a, b, hMiddle, hMax);
+          exactSol(iMiddle, 0) = exactHeight(p, q, a, b, hMiddle, hMax);
           // Supercritical part (after the bump)
           for (int i(2. * _nCells / 5. + 1) ; i < _nCells ; ++i)
             {
               double z(_topography(i));
               computeCoeffabcd(qIn, hMiddle, z, zMax, &a, &b, &c, &d);
               p = cardanP(a, b, c); q = cardanQ(a, b, c, d);
-              _exactSol(i,0) = exactHeight(p, q, a, b, _exactSol(i-1, 0)*(1-epsilon), hMax);
+              exactSol(i,0) = exactHeight(p, q, a, b, exactSol(i-1, 0)*(1-epsilon), hMax);
             }
         }
-      else if (testCase == "TranscriticalFlowWithShock")
+      else if (testCase == TestCaseType::TranscriticalFlowWithShock)
         {
           // Search for the limit between sub-super-sub
           double test(100.);
@@ -595,14 +678,14 @@ void Physics::buildExactSolution(double t)
               test = RHJump(hplus, hminus, qIn);
               ++abslim;
             }
-          _exactSol(abslim, 0) = hminus;
+          exactSol(abslim, 0) = hminus;
 
           for (int i(abslim - 1) ; i >= 0 ; --i)
             {
               computeCoeffabcd(qIn, hMiddle, _topography(i), zMax, &a, &b, &c, &d);
               p = cardanP(a, b, c);
               q = cardanQ(a, b, c, d);
-              _exactSol(i,0) = exactHeight(p, q, a, b, _exactSol(i+1,0) + epsilon, hMax);
+              exactSol(i,0) = exactHeight(p, q, a, b, exactSol(i+1,0) + epsilon, hMax);
             }
           for (int i(_nCells - 1) ; i > abslim ; --i)
             {
@@ -613,8 +696,8 @@ void Physics::buildExactSolution(double t)
               if (i == _nCells - 1)
                 hnear = hOut;
               else
-                hnear = _exactSol(i+1,0);
-              _exactSol(i,0) = exactHeight(p, q, a, b, hnear, hMax);
+                hnear = exactSol(i+1,0);
+              exactSol(i,0) = exactHeight(p, q, a, b, hnear, hMax);
             }
         }
     }
@@ -628,7 +711,7 @@ double Physics::damBreakFunc(double x, double vG, double vD) const
 }
 
 // Methode de cardan
-void Physics::computeCoeffabcd(double qIn, double hOut, double z, double zEnd, double* a, double* b, double* c, double *d)
+void Physics::computeCoeffabcd(double qIn, double hOut, double z, double zEnd, double* a, double* b, double* c, double *d) const
 {
   *a = 1.;
   *b = - (qIn * qIn / (2. * _g * hOut * hOut) + hOut - (z - zEnd));
@@ -706,22 +789,23 @@ double Physics::exactHeight(double p, double q, double a, double b, double hnear
 
 
 // Save the exact solution in a file
-void Physics::saveExactSolution(std::string& fileName) const
+void Physics::saveExactSolution(std::string& fileName, const SolverState& state) const
 {
+  const Eigen::Matrix<double, Eigen::Dynamic, 2>& exactSol(state.exactSol);
 #if VERBOSITY>0
   std::cout << "Saving exact solution" << std::endl;
 #endif
   std::ofstream outputFile(fileName, std::ios::out);
   const Eigen::VectorXd& cellCenters(_mesh->getCellCenters());
   outputFile << "# x  H=h+z   h       u       q       Fr=|u|/sqrt(gh)" << std::endl;
-  for (int i(0) ; i < _exactSol.rows() ; ++i)
+  for (int i(0) ; i < exactSol.rows() ; ++i)
     {
       outputFile << cellCenters(i) << " " <<
-        _exactSol(i,0) + _topography(i) << " " <<
-        _exactSol(i,0) << " " <<
-        _exactSol(i,1)/_exactSol(i,0) << " " <<
-        _exactSol(i,1) << " " <<
-        abs(_exactSol(i,1)/_exactSol(i,0))/sqrt(_g * _exactSol(i,0)) << std::endl;
+        exactSol(i,0) + _topography(i) << " " <<
+        exactSol(i,0) << " " <<
+        exactSol(i,1)/exactSol(i,0) << " " <<
+        exactSol(i,1) << " " <<
+        abs(exactSol(i,1)/exactSol(i,0))/sqrt(_g * exactSol(i,0)) << std::endl;
     }
 }
 
@@ -760,53 +844,62 @@ void Physics::computeWaveSpeed(const Eigen::Vector2d& SolG, const Eigen::Vector2
 //------------------------------------------------------//
 //---------------Left Boundary Conditions---------------//
 //------------------------------------------------------//
-Eigen::Vector2d Physics::leftBoundaryFunction(double t, const Eigen::Matrix<double, Eigen::Dynamic, 2>& Sol)
+Eigen::Vector2d Physics::leftBoundaryFunction(double t, const StateMatrix& Sol, SolverState& state) const
 {
+  return leftBoundaryFunction(t, Sol.col(0), Sol.col(1), state.source.col(1), state.timeStep, state.forcing);
+}
+
+
+
+Eigen::Vector2d Physics::leftBoundaryFunction(double t, const CellValues& hCells, const CellValues& qCells, const CellValues& sourceQ,
+                                              double timeStep, const BoundaryForcing& forcing) const
+{
+  PROFILE_SCOPE(Boundary);
   Eigen::Vector2d SolG(0.,0.);
 
   // Calcul du nombre de Froude au bord
-  double h(Sol(0,0)), q(Sol(0,1));
+  double h(hCells(0)), q(qCells(0));
   double Fr(abs(q)/(h * sqrt(_g * h)));
   
   // Choix entre les differentes CL
-  if (_DF->getLeftBC() == "Neumann")
+  if (_plan.leftBC == BoundaryConditionType::Neumann)
     {
-      SolG(0) = Sol(0,0);
-      SolG(1) = Sol(0,1);
+      SolG(0) = hCells(0);
+      SolG(1) = qCells(0);
     }
-  else if (_DF->getLeftBC() == "Wall")
+  else if (_plan.leftBC == BoundaryConditionType::Wall)
     {
-      SolG(0) = Sol(0,0);
+      SolG(0) = hCells(0);
       SolG(1) = 0.;
     }
-  else if (_DF->getLeftBC() == "ImposedConstantDischarge")
+  else if (_plan.leftBC == BoundaryConditionType::ImposedConstantDischarge)
     {
       // Entrée/sortie fluviale
       if (Fr < 1)
         {
-          SolG(0) = Sol(0,0);
-          SolG(1) = _DF->getLeftBCImposedDischarge();
+          SolG(0) = hCells(0);
+          SolG(1) = forcing.leftImposedDischarge;
         }
       // Sortie torrentielle (sortie libre, on n'impose rien)
       else if (Fr > 1 && q < 0)
         {
-          SolG(0) = Sol(0,0);
-          SolG(1) = Sol(0,1);
+          SolG(0) = hCells(0);
+          SolG(1) = qCells(0);
         }
       // Entrée torrentielle (on impose une hauteur et un debit)
       else if (Fr > 1 && q > 0)
         {
-          SolG(0) = _DF->getLeftBCImposedHeight();
-          SolG(1) = _DF->getLeftBCImposedDischarge();
+          SolG(0) = forcing.leftImposedHeight;
+          SolG(1) = forcing.leftImposedDischarge;
         }
     }
-  else if (_DF->getLeftBC() == "PeriodicWaves" || _DF->getLeftBC() == "DataFile" || _DF->getLeftBC() == "ImposedConstantHeight")
+  else if (_plan.leftBC == BoundaryConditionType::PeriodicWaves || _plan.leftBC == BoundaryConditionType::DataFile || _plan.leftBC == BoundaryConditionType::ImposedConstantHeight)
     {
       // Recupere la solution dans les mailles de centre x1 et x2 ainsi que dx et dt
-      double h1(Sol(0,0)), h2(Sol(1,0));
-      double u1(Sol(0,1)/h1), u2(Sol(1,1)/h2);
-      double dx(_DF->getDx()), dt(_DF->getTimeStep());
-      double x1(_DF->getXmin() + 0.5*dx);
+      double h1(hCells(0)), h2(hCells(1));
+      double u1(qCells(0)/h1), u2(qCells(1)/h2);
+      double dx(_plan.dx), dt(timeStep);
+      double x1(_plan.xmin + 0.5*dx);
       double a(pow(1 + dt/dx * (u2 - u1), 2));
       double b(2*dt*(u1 - x1/dx * (u2 - u1)) * (1 + dt/dx * (u2 - u1)) - dt*dt*_g*(h2 - h1)/dx);
       double c(pow(dt*u1 - dt/dx * x1 * (u2 - u1), 2) - dt*dt * _g * (h1 - x1/dx * (h2 - h1)));
@@ -815,55 +908,39 @@ Eigen::Vector2d Physics::leftBoundaryFunction(double t, const Eigen::Matrix<doub
       // std::cout << xe << std::endl;
       double uXe(u1 + (xe - x1)*(u2 - u1)/dx);
       double hXe(h1 + (xe - x1)*(h2 - h1)/dx);
-      double source_terme_xe(FindSourceX(xe));
+      double source_terme_xe(FindSourceX(xe, sourceQ));
       double beta_moins_xe_tn(uXe - 2*sqrt(_g*hXe));
       double beta_moins_0_tnplus1(beta_moins_xe_tn - _g*dt*source_terme_xe);
-      if (_DF->getLeftBC() == "ImposedConstantHeight")
+      if (_plan.leftBC == BoundaryConditionType::ImposedConstantHeight)
         {
           // Entrée/sortie fluviale
           if (Fr < 1)
             {
-              SolG(0) = _DF->getLeftBCImposedHeight();
+              SolG(0) = forcing.leftImposedHeight;
               SolG(1) = SolG(0)*(beta_moins_0_tnplus1 + 2*sqrt(_g*SolG(0)));
             }
           // Sortie torrentielle (sortie libre, on n'impose rien)
           else if (Fr > 1 && q < 0)
             {
-              SolG(0) = Sol(0,0);
-              SolG(1) = Sol(0,1);
+              SolG(0) = hCells(0);
+              SolG(1) = qCells(0);
             }
           // Entrée torrentielle (on impose une hauteur et un debit)
           else if (Fr > 1 && q > 0)
             {
-              SolG(0) = _DF->getLeftBCImposedHeight();
-              SolG(1) = _DF->getLeftBCImposedDischarge();
+              SolG(0) = forcing.leftImposedHeight;
+              SolG(1) = forcing.leftImposedDischarge;
             }
         }
-      if (_DF->getLeftBC() == "PeriodicWaves")
+      if (_plan.leftBC == BoundaryConditionType::PeriodicWaves)
         {
           SolG(0) = 3. + 0.1*sin(5 * M_PI * t);
           SolG(1) = SolG(0)*(beta_moins_0_tnplus1 + 2*sqrt(_g*SolG(0)));
         }
-      else if (_DF->getLeftBC() == "DataFile")
+      else if (_plan.leftBC == BoundaryConditionType::DataFile)
         {
-          int i_max;
-          i_max = _expBoundaryData.rows();
-          double temps1(_expBoundaryData(_i,0)), temps2(_expBoundaryData(_i+1,0));
-          double hauteur1(_expBoundaryData(_i,1)), hauteur2(_expBoundaryData(_i+1,1));
-          while ((!(temps1 < t && t <= temps2)) && (_i < i_max)) // On cherche a trouver les temps connus des capteurs tq temps1 < t <= temps2
-            {
-              _i++;
-              temps1 = _expBoundaryData(_i,0);
-              temps2 = _expBoundaryData(_i+1,0);
-            }
-          if (_i == i_max)
-            {
-              std::cout << "Aucun pas de temps ne correspond --> pas trop eleve ?" << std::endl;
-              return SolG;
-            }
-          hauteur1 = _expBoundaryData(_i,1);
-          hauteur2 = _expBoundaryData(_i+1,1);
-          SolG(0) = hauteur1 + (t - temps1)*(hauteur2 - hauteur1)/(temps2 - temps1);
+          // Hauteur mesurée par le capteur à l'instant t (accès direct)
+          SolG(0) = forcing.leftData->value(t);
           SolG(1) = SolG(0)*(beta_moins_0_tnplus1 + 2*sqrt(_g*SolG(0)));
         }
     }
@@ -875,96 +952,89 @@ Eigen::Vector2d Physics::leftBoundaryFunction(double t, const Eigen::Matrix<doub
 //-------------------------------------------------------//
 //---------------Right Boundary Conditions---------------//
 //-------------------------------------------------------//
-Eigen::Vector2d Physics::rightBoundaryFunction(double t, const Eigen::Matrix<double, Eigen::Dynamic, 2>& Sol)
+Eigen::Vector2d Physics::rightBoundaryFunction(double t, const StateMatrix& Sol, SolverState& state) const
 {
+  return rightBoundaryFunction(t, Sol.col(0), Sol.col(1), state.source.col(1), state.timeStep, state.forcing);
+}
+
+
+
+Eigen::Vector2d Physics::rightBoundaryFunction(double t, const CellValues& hCells, const CellValues& qCells, const CellValues&,
+                                               double, const BoundaryForcing& forcing) const
+{
+  PROFILE_SCOPE(Boundary);
   Eigen::Vector2d SolD(0.,0.);
 
   // Calcul du nombre de Froude au bord
-  double h(Sol(_nCells - 1,0)), q(Sol(_nCells - 1,1));
+  double h(hCells(_nCells - 1)), q(qCells(_nCells - 1));
   double Fr(abs(q)/(h * sqrt(_g * h)));
   
   // Choix entre les differentes CL
-  if (_DF->getRightBC() == "Neumann")
+  if (_plan.rightBC == BoundaryConditionType::Neumann)
     {
-      SolD(0) = Sol(_nCells - 1,0);
-      SolD(1) = Sol(_nCells - 1,1);
+      SolD(0) = hCells(_nCells - 1);
+      SolD(1) = qCells(_nCells - 1);
     }
-  else if (_DF->getRightBC() == "Wall")
+  else if (_plan.rightBC == BoundaryConditionType::Wall)
     {
-      SolD(0) = Sol(_nCells - 1,0);
+      SolD(0) = hCells(_nCells - 1);
       SolD(1) = 0.;
     }
-  else if (_DF->getRightBC() == "ImposedConstantDischarge")
+  else if (_plan.rightBC == BoundaryConditionType::ImposedConstantDischarge)
     {
       // Entrée/sortie fluviale
       if (Fr < 1)
         {
-          SolD(0) = Sol(_nCells - 1,0);
-          SolD(1) = _DF->getRightBCImposedDischarge();
+          SolD(0) = hCells(_nCells - 1);
+          SolD(1) = forcing.rightImposedDischarge;
         }
       // Sortie torrentielle (sortie libre, on n'impose rien)
       else if (Fr > 1 && q > 0)
         {
-          SolD(0) = Sol(_nCells - 1,0);
-          SolD(1) = Sol(_nCells - 1,1);
+          SolD(0) = hCells(_nCells - 1);
+          SolD(1) = qCells(_nCells - 1);
         }
       // Entrée torrentielle (on impose une hauteur et un debit)
       else if (Fr > 1 && q < 0)
         {
-          SolD(0) = _DF->getRightBCImposedHeight() - _topography(_nCells - 1);
-          SolD(1) = _DF->getRightBCImposedDischarge();
+          SolD(0) = forcing.rightImposedHeight - _topography(_nCells - 1);
+          SolD(1) = forcing.rightImposedDischarge;
         }
     }
-  else if (_DF->getRightBC() == "PeriodicWaves" || _DF->getRightBC() == "DataFile" || _DF->getRightBC() == "ImposedConstantHeight")
+  else if (_plan.rightBC == BoundaryConditionType::PeriodicWaves || _plan.rightBC == BoundaryConditionType::DataFile || _plan.rightBC == BoundaryConditionType::ImposedConstantHeight)
     {
       // Recupere la solution dans la maille de bord
-      double h1(Sol(_nCells - 1,0)), u1(Sol(_nCells - 1,1)/h1);
-      if (_DF->getRightBC() == "ImposedConstantHeight")
+      double h1(hCells(_nCells - 1)), u1(qCells(_nCells - 1)/h1);
+      if (_plan.rightBC == BoundaryConditionType::ImposedConstantHeight)
         {
           // Entrée/sortie fluviale
           if (Fr < 1)
             {
-              SolD(0) = _DF->getRightBCImposedHeight() - _topography(_nCells - 1);
+              SolD(0) = forcing.rightImposedHeight - _topography(_nCells - 1);
               SolD(1) = SolD(0) * (u1 + 2. * sqrt(_g * h1) - 2. * sqrt(_g * SolD(0)));
             }
           // Sortie torrentielle (sortie libre, on n'impose rien)
           else if (Fr > 1 && q > 0)
             {
-              SolD(0) = Sol(_nCells - 1,0);
-              SolD(1) = Sol(_nCells - 1,1);
+              SolD(0) = hCells(_nCells - 1);
+              SolD(1) = qCells(_nCells - 1);
             }
           // Entrée torrentielle (on impose une hauteur et un debit)
           else if (Fr > 1 && q < 0)
             {
-              SolD(0) = _DF->getRightBCImposedHeight() - _topography(_nCells - 1);
-              SolD(1) = _DF->getRightBCImposedDischarge();
+              SolD(0) = forcing.rightImposedHeight - _topography(_nCells - 1);
+              SolD(1) = forcing.rightImposedDischarge;
             }
         }
-      else if (_DF->getRightBC() == "PeriodicWaves")
+      else if (_plan.rightBC == BoundaryConditionType::PeriodicWaves)
         {
           SolD(0) = 3. + 0.1*sin(5 * M_PI * t);
           SolD(1) = SolD(0) * (u1 + 2. * sqrt(_g * h1) - 2. * sqrt(_g * SolD(0)));
         }
-      else if (_DF->getRightBC() == "DataFile")
+      else if (_plan.rightBC == BoundaryConditionType::DataFile)
         {
-          int i_max;
-          i_max = _expBoundaryData.size() - _i;
-          double temps1(_expBoundaryData(_i,0)), temps2(_expBoundaryData(_i+1,0));
-          double hauteur1(_expBoundaryData(_i,1)), hauteur2(_expBoundaryData(_i+1,1));
-          while ((!(temps1 < t <= temps2)) && (_i < i_max)) // On cherche a trouver les temps connus des capteurs tq temps1 < t <= temps2
-            {
-              _i++;
-              temps1 = _expBoundaryData(_i,0);
-              temps2 = _expBoundaryData(_i+1,0);
-            }
-          if (_i == i_max)
-            {
-              std::cout << "Aucun pas de temps ne correspond --> pas trop eleve ?" << std::endl;
-              return SolD;
-            }
-          hauteur1 = _expBoundaryData(_i,1);
-          hauteur2 = _expBoundaryData(_i+1,1);
-          SolD(0) = (t - temps1)*(hauteur2 - hauteur1)/(temps2 - temps1) - hauteur1;
+          // Hauteur mesurée par le capteur à l'instant t (accès direct)
+          SolD(0) = forcing.rightData->value(t);
           SolD(1) = SolD(0) * (u1 + 2. * sqrt(_g * h1) - 2. * sqrt(_g * SolD(0)));
         }
     }
@@ -974,7 +1044,7 @@ Eigen::Vector2d Physics::rightBoundaryFunction(double t, const Eigen::Matrix<dou
 
 
 // Other
-double Physics::FindRacine(double a, double b, double c)
+double Physics::FindRacine(double a, double b, double c) const
 {
   double delta;
   delta = b*b - 4*a*c;
@@ -999,21 +1069,30 @@ double Physics::FindRacine(double a, double b, double c)
 
 
 
+void Physics::writeCheckpoint(Checkpoint& checkpoint, const SolverState& state) const
+{
+  checkpoint.putMatrix(state.source);
+}
+
+
+
+void Physics::readCheckpoint(Checkpoint& checkpoint, SolverState& state) const
+{
+  checkpoint.getMatrix(state.source);
+}
+
+
+
 // Donne le terme source en x par interpolation
-double Physics::FindSourceX(double x)
+double Physics::FindSourceX(double x, const CellValues& sourceQ) const
 {
-  int i(0);
-  double dx(_DF->getDx());
-  double x1(_xmin + (i + 0.5) * dx), x2(x1 + dx);
+  // Centres des cellules i et i+1 qui encadrent x
+  int i(_mesh->findCellInterval(x));
+  const Eigen::VectorXd& cellCenters(_mesh->getCellCenters());
+  double x1(cellCenters(i)), x2(cellCenters(i+1));
   double source1, source2, source;
-  while (x1 < x)
-    {
-      ++i;
-      x1 += dx;
-    }
-  x2 = x1 + dx;
-  source1 = _source(i,1);
-  source2 = _source(i+1,1);
+  source1 = sourceQ(i);
+  source2 = sourceQ(i+1);
   source = source1 + (x - x1)*(source2 - source1)/(x2 - x1);
   return source;
 }
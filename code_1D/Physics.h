@@ -4,6 +4,10 @@
 #include "DataFile.h"
 #include "Mesh.h"
 #include "termcolor.h"
+#include "Layout.h"
+#include "Checkpoint.h"
+#include "SolverState.h"
+#include "TimeSeries.h"
 #include "Eigen/Eigen/Dense"
 #include "Eigen/Eigen/Sparse"
 
@@ -14,57 +18,74 @@ class Physics
 private:
   // Pointeur vers le fichier de paramètres pour récupérer les
   // conditions initiales, aux limites et le fichier de topographie (terme source).
-  DataFile* _DF;
-  Mesh* _mesh;
+  const DataFile* _DF;
+  const Mesh* _mesh;
+
+  // Options résolues du fichier de paramètres
+  RunPlan _plan;
 
   // Variables pratiques
   double _xmin, _xmax;
   double _g;
   int _nCells;
 
-  // Variables utiles pour les donnees experimentales
-  Eigen::Matrix<double, Eigen::Dynamic, 2> _expBoundaryData;
-  int _i;
+  // Données expérimentales des conditions aux limites DataFile
+  TimeSeries _leftBoundaryData, _rightBoundaryData;
 
   // Condition initiale
-  Eigen::Matrix<double, Eigen::Dynamic, 2> _Sol0;
+  StateMatrix _Sol0;
 
   // Topographie pour le terme source.
   Eigen::Matrix<double, Eigen::Dynamic, 2> _fileTopography;
   Eigen::VectorXd _topography;
-
-  // Terme source
-  Eigen::Matrix<double, Eigen::Dynamic, 2> _source;
-
-  // Exact solution
-  Eigen::Matrix<double, Eigen::Dynamic, 2> _exactSol;
+  // Coefficient du terme source de q (-g dz/dx), calculé une seule fois :
+  // le terme source vaut _sourceCoefficient * h
+  Eigen::VectorXd _sourceCoefficient;
   
 public:
   // Constructeur
   Physics();
-  Physics(DataFile* DF, Mesh* mesh);
+  Physics(const DataFile* DF, const Mesh* mesh);
 
-  // Initialisation
+  // Initialisation. Ensuite, Physics ne change plus : tout ce qui évolue
+  // avec le temps est dans le SolverState passé aux méthodes ci-dessous.
   void Initialize();
-  void Initialize(DataFile* DF, Mesh* mesh);
+  void Initialize(const DataFile* DF, const Mesh* mesh);
 
   // Getters
-  const Eigen::Matrix<double, Eigen::Dynamic, 2>& getExperimentalBoundaryData() const {return _expBoundaryData;};
-  const Eigen::Matrix<double, Eigen::Dynamic, 2>& getInitialCondition() const {return _Sol0;};
+  const TimeSeries& getLeftBoundaryData() const {return _leftBoundaryData;};
+  const TimeSeries& getRightBoundaryData() const {return _rightBoundaryData;};
+  const StateMatrix& getInitialCondition() const {return _Sol0;};
   const Eigen::VectorXd& getTopography() const {return _topography;};
-  const Eigen::Matrix<double, Eigen::Dynamic, 2>& getSourceTerm() const {return _source;};
-  const Eigen::Matrix<double, Eigen::Dynamic, 2>& getExactSolution() const {return _exactSol;};
-  
-  // Construit le terme source
-  void buildSourceTerm(const Eigen::Matrix<double, Eigen::Dynamic, 2>& Sol);
 
-  // Construit/Sauvegarde la solution exacte
-  void buildExactSolution(double t);
-  void saveExactSolution(std::string& fileName) const;
+  // Forçage aux limites du fichier de paramètres
+  BoundaryForcing getBoundaryForcing() const;
+  // Lit un fichier de données expérimentales (t, h) pour la condition aux limites DataFile
+  void readExpBoundaryData(const std::string& fileName, TimeSeries& expData) const;
+
+  // État qui évolue avec le temps (points de reprise) : dernier terme
+  // source, utilisé par les conditions aux limites
+  void writeCheckpoint(Checkpoint& checkpoint, const SolverState& state) const;
+  void readCheckpoint(Checkpoint& checkpoint, SolverState& state) const;
+  
+  // Construit le terme source dans state.source
+  void buildSourceTerm(const StateMatrix& Sol, SolverState& state) const;
+  // Même chose pour tous les membres d'un ensemble, dans state.sourceQ
+  void buildSourceTerm(const EnsembleMatrix& h, EnsembleState& state) const;
+
+  // Construit/Sauvegarde la solution exacte (state.exactSol)
+  void buildExactSolution(double t, SolverState& state) const;
+  void saveExactSolution(std::string& fileName, const SolverState& state) const;
   
   // Conditions aux limites
-  Eigen::Vector2d leftBoundaryFunction(double t, const Eigen::Matrix<double, Eigen::Dynamic, 2>& Sol);
-  Eigen::Vector2d rightBoundaryFunction(double t, const Eigen::Matrix<double, Eigen::Dynamic, 2>& Sol);
+  Eigen::Vector2d leftBoundaryFunction(double t, const StateMatrix& Sol, SolverState& state) const;
+  Eigen::Vector2d rightBoundaryFunction(double t, const StateMatrix& Sol, SolverState& state) const;
+  // Les mêmes à partir de h, q et du terme source de q d'un calcul (un
+  // membre d'un ensemble par exemple), avec son forçage aux limites
+  Eigen::Vector2d leftBoundaryFunction(double t, const CellValues& h, const CellValues& q, const CellValues& sourceQ,
+                                       double timeStep, const BoundaryForcing& forcing) const;
+  Eigen::Vector2d rightBoundaryFunction(double t, const CellValues& h, const CellValues& q, const CellValues& sourceQ,
+                                        double timeStep, const BoundaryForcing& forcing) const;
   
   // Compute the physical flux of the 1D SWE
   Eigen::Vector2d physicalFlux(const Eigen::Vector2d& Sol) const;
@@ -73,20 +94,21 @@ public:
   
 protected:
   void buildTopography();
+  void buildSourceCoefficient();
   void buildInitialCondition();
   void buildExpBoundaryData();
 
   // Boundary conditions
 
   // Resolution equation second ordre
-  double FindRacine(double a, double b, double c);
+  double FindRacine(double a, double b, double c) const;
   // On cherche le terme source en x (pour x dans le domaine)
-  double FindSourceX(double x);
+  double FindSourceX(double x, const CellValues& sourceQ) const;
 
   // Exact solution
   
   // Stationnary flows over a bump test cases.
-  void computeCoeffabcd(double qIn, double hOut, double z, double zEnd, double* a, double* b, double* c, double *d);
+  void computeCoeffabcd(double qIn, double hOut, double z, double zEnd, double* a, double* b, double* c, double *d) const;
   double cardanP(double a, double b, double c) const;
   double cardanQ(double a, double b, double c, double d) const;
   double cardanDet(double p, double q) const;
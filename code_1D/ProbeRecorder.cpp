@@ -0,0 +1,147 @@
+#include "ProbeRecorder.h"
+#include "TextFormat.h"
+#include "Checkpoint.h"
+#include "termcolor.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cmath>
+
+
+
+ProbeRecorder::ProbeRecorder():
+  _g(0.), _blockSize(16384)
+{
+}
+
+
+
+ProbeRecorder::ProbeRecorder(const std::string& fileName, const std::vector<int>& references, const std::vector<int>& cells,
+                             const std::vector<double>& topography, double g):
+  _blockSize(16384)
+{
+  Initialize(fileName, references, cells, topography, g);
+}
+
+
+
+void ProbeRecorder::setProbes(const std::string& fileName, const std::vector<int>& references, const std::vector<int>& cells,
+                              const std::vector<double>& topography, double g)
+{
+  _fileName = fileName;
+  _references = references;
+  _cells = cells;
+  _topography = topography;
+  _g = g;
+  _times.clear();
+  _h.assign(_cells.size(), std::vector<double>());
+  _q.assign(_cells.size(), std::vector<double>());
+  _times.reserve(_blockSize);
+  for (std::size_t i(0) ; i < _cells.size() ; ++i)
+    {
+      _h[i].reserve(_blockSize);
+      _q[i].reserve(_blockSize);
+    }
+}
+
+
+
+void ProbeRecorder::Initialize(const std::string& fileName, const std::vector<int>& references, const std::vector<int>& cells,
+                               const std::vector<double>& topography, double g)
+{
+  setProbes(fileName, references, cells, topography, g);
+
+  // En-tête (commentaire gnuplot)
+  std::ofstream outputFile(_fileName, std::ios::out);
+  if (!outputFile.is_open())
+    {
+      std::cout << termcolor::red << "ERROR::PROBES : Unable to open file " << _fileName << std::endl;
+      std::cout << termcolor::reset;
+      exit(-1);
+    }
+  outputFile << "# t";
+  for (std::size_t i(0) ; i < _references.size() ; ++i)
+    {
+      int ref(_references[i]);
+      outputFile << ",H_" << ref << ",h_" << ref << ",u_" << ref << ",q_" << ref << ",Fr_" << ref;
+    }
+  outputFile << "\n";
+}
+
+
+
+void ProbeRecorder::Resume(const std::string& fileName, const std::vector<int>& references, const std::vector<int>& cells,
+                           const std::vector<double>& topography, double g, long long size)
+{
+  setProbes(fileName, references, cells, topography, g);
+  truncateFile(_fileName, size);
+}
+
+
+
+void ProbeRecorder::record(double t, const StateMatrix& Sol)
+{
+  record(t, Sol.col(0), Sol.col(1));
+}
+
+
+
+void ProbeRecorder::record(double t, const CellValues& h, const CellValues& q)
+{
+  _times.push_back(t);
+  for (std::size_t i(0) ; i < _cells.size() ; ++i)
+    {
+      _h[i].push_back(h(_cells[i]));
+      _q[i].push_back(q(_cells[i]));
+    }
+  if (_times.size() >= _blockSize)
+    {
+      flush();
+    }
+}
+
+
+
+// Les grandeurs dérivées (H, u, Fr) ne sont calculées qu'ici, au moment
+// d'écrire le bloc
+void ProbeRecorder::flush()
+{
+  if (_times.size() == 0)
+    return;
+
+  // Colonnes du bloc : t puis H, h, u, q, Fr pour chaque sonde
+  int nSamples(_times.size());
+  std::vector<std::vector<double> > derived(3 * _cells.size(), std::vector<double>(nSamples));
+  std::vector<const double*> columns(1, _times.data());
+  for (std::size_t i(0) ; i < _cells.size() ; ++i)
+    {
+      std::vector<double>& H(derived[3*i]);
+      std::vector<double>& u(derived[3*i+1]);
+      std::vector<double>& Fr(derived[3*i+2]);
+      const std::vector<double>& h(_h[i]);
+      const std::vector<double>& q(_q[i]);
+      for (int n(0) ; n < nSamples ; ++n)
+        {
+          H[n] = h[n] + _topography[i];
+          u[n] = q[n]/h[n];
+          Fr[n] = std::abs(u[n])/sqrt(_g * h[n]);
+        }
+      columns.push_back(H.data());
+      columns.push_back(h.data());
+      columns.push_back(u.data());
+      columns.push_back(q.data());
+      columns.push_back(Fr.data());
+    }
+
+  std::ofstream outputFile(_fileName, std::ios::app);
+  writeColumns(outputFile, columns, nSamples, ',');
+
+  _times.clear();
+  for (std::size_t i(0) ; i < _cells.size() ; ++i)
+    {
+      _h[i].clear();
+      _q[i].clear();
+    }
+}
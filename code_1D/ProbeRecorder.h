@@ -0,0 +1,71 @@
+#ifndef PROBE_RECORDER_H
+#define PROBE_RECORDER_H
+
+#include "Layout.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+
+
+// Enregistrement des sondes. Les valeurs de h et q de chaque sonde sont
+// gardées en mémoire (une colonne par sonde) et écrites par blocs dans un
+// seul fichier CSV, une ligne par instant :
+//   t,H_1,h_1,u_1,q_1,Fr_1,H_2,h_2,...
+// Un échantillon ne coûte ainsi que quelques copies, ce qui permet
+// d'enregistrer les sondes à chaque pas de temps.
+class ProbeRecorder
+{
+private:
+  // Fichier de sortie
+  std::string _fileName;
+
+  // Sondes : références, cellules et topographie dans ces cellules
+  std::vector<int> _references;
+  std::vector<int> _cells;
+  std::vector<double> _topography;
+  double _g;
+
+  // Échantillons pas encore écrits
+  std::vector<double> _times;
+  std::vector<std::vector<double> > _h;
+  std::vector<std::vector<double> > _q;
+
+  // Nombre d'échantillons gardés avant d'écrire un bloc
+  std::size_t _blockSize;
+
+  // Garde les sondes et vide les échantillons
+  void setProbes(const std::string& fileName, const std::vector<int>& references, const std::vector<int>& cells,
+                 const std::vector<double>& topography, double g);
+  
+public:
+  // Constructeurs
+  ProbeRecorder();
+  ProbeRecorder(const std::string& fileName, const std::vector<int>& references, const std::vector<int>& cells,
+                const std::vector<double>& topography, double g);
+
+  // Destructeur
+  ~ProbeRecorder() = default;
+
+  // Initialise l'objet et écrit l'en-tête du fichier
+  void Initialize(const std::string& fileName, const std::vector<int>& references, const std::vector<int>& cells,
+                  const std::vector<double>& topography, double g);
+
+  // Reprise d'un calcul : comme Initialize, mais le fichier existant est
+  // ramené à size octets au lieu d'être réécrit
+  void Resume(const std::string& fileName, const std::vector<int>& references, const std::vector<int>& cells,
+              const std::vector<double>& topography, double g, long long size);
+
+  // Nombre de sondes
+  int getNumberOfProbes() const {return _cells.size();};
+
+  // Ajoute un échantillon à l'instant t
+  void record(double t, const StateMatrix& Sol);
+  void record(double t, const CellValues& h, const CellValues& q);
+
+  // Écrit les échantillons en attente à la fin du fichier
+  void flush();
+};
+
+#endif // PROBE_RECORDER_H
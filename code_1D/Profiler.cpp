@@ -0,0 +1,209 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "termcolor.h"
+
+// Les temps par pas de temps sont rangés dans un histogramme à échelle
+// logarithmique (50 classes par décade, de 1 ns à 1000 s) : la mémoire ne
+// dépend pas du nombre de pas de temps et le 99e centile est connu à 5 %
+// près. Les pas de temps où une phase n'a rien fait (sauvegardes...) sont
+// comptés dans la classe 0.
+static const int binsPerDecade(50);
+static const int nDecades(12);
+static const int nBins(binsPerDecade * nDecades + 1);
+static const int nPhases(static_cast<int>(ProfilePhase::Count));
+
+static const char* phaseNames[nPhases] = {"Boundary", "Reconstruction", "RiemannFluxes", "SourceTerm", "Update", "Output"};
+
+static Profiler::Clock::time_point wallStart;
+static double wallTime(0.);
+static long nSteps(0);
+static long nCellsProfiled(0);
+static Profiler::Clock::duration stepTime[nPhases];
+static Profiler::Clock::duration totalTime[nPhases];
+static long nCalls[nPhases];
+static std::vector<long> histogram[nPhases];
+static std::vector<long> stepHistogram;
+
+ProfileScope* ProfileScope::_current(nullptr);
+
+
+
+static int binIndex(Profiler::Clock::duration duration)
+{
+  double ns(std::chrono::duration<double, std::nano>(duration).count());
+  if (ns < 1.)
+    return 0;
+  int bin(1 + static_cast<int>(std::log10(ns) * binsPerDecade));
+  return std::min(bin, nBins - 1);
+}
+
+
+
+// Borne supérieure (en secondes) de la classe contenant le 99e centile
+static double percentile99(const std::vector<long>& bins)
+{
+  if (nSteps == 0)
+    return 0.;
+  long rank(static_cast<long>(std::ceil(0.99 * nSteps))), count(0);
+  int bin(0);
+  for ( ; bin < nBins - 1 ; ++bin)
+    {
+      count += bins[bin];
+      if (count >= rank)
+        break;
+    }
+  if (bin == 0)
+    return 0.;
+  return 1e-9 * std::pow(10., static_cast<double>(bin) / binsPerDecade);
+}
+
+
+
+static double seconds(Profiler::Clock::duration duration)
+{
+  return std::chrono::duration<double>(duration).count();
+}
+
+
+
+void Profiler::start()
+{
+  for (int p(0) ; p < nPhases ; ++p)
+    {
+      stepTime[p] = Clock::duration(0);
+      totalTime[p] = Clock::duration(0);
+      nCalls[p] = 0;
+      histogram[p].assign(nBins, 0);
+    }
+  stepHistogram.assign(nBins, 0);
+  nSteps = 0;
+  wallTime = 0.;
+  wallStart = Clock::now();
+}
+
+
+
+void Profiler::beginTimeLoop()
+{
+  for (int p(0) ; p < nPhases ; ++p)
+    stepTime[p] = Clock::duration(0);
+}
+
+
+
+void Profiler::add(ProfilePhase phase, Clock::duration duration)
+{
+  int p(static_cast<int>(phase));
+  stepTime[p] += duration;
+  totalTime[p] += duration;
+  ++nCalls[p];
+}
+
+
+
+void Profiler::endStep()
+{
+  Clock::duration step(0);
+  for (int p(0) ; p < nPhases ; ++p)
+    {
+      ++histogram[p][binIndex(stepTime[p])];
+      step += stepTime[p];
+      stepTime[p] = Clock::duration(0);
+    }
+  ++stepHistogram[binIndex(step)];
+  ++nSteps;
+}
+
+
+
+void Profiler::stop(long nCells)
+{
+  wallTime = seconds(Clock::now() - wallStart);
+  nCellsProfiled = nCells;
+}
+
+
+
+void Profiler::printReport(std::ostream& out)
+{
+  double measured(0.);
+  for (int p(0) ; p < nPhases ; ++p)
+    measured += seconds(totalTime[p]);
+  long steps(std::max(nSteps, 1L));
+
+  out << "Profiling of the time loop : " << nSteps << " time steps, " << nCellsProfiled << " cells, wall time "
+      << wallTime << " s" << std::endl;
+  out << std::left << std::setw(16) << "Phase" << std::right
+      << std::setw(12) << "Total (s)" << std::setw(18) << "Mean/step (us)"
+      << std::setw(17) << "p99/step (us)" << std::setw(10) << "% wall" << std::endl;
+  for (int p(0) ; p < nPhases ; ++p)
+    {
+      // Phases sans objet pour ce calcul
+      if (nCalls[p] == 0)
+        continue;
+      double total(seconds(totalTime[p]));
+      out << std::left << std::setw(16) << phaseNames[p] << std::right << std::fixed
+          << std::setw(12) << std::setprecision(4) << total
+          << std::setw(18) << std::setprecision(2) << 1e6 * total / steps
+          << std::setw(17) << std::setprecision(2) << 1e6 * percentile99(histogram[p])
+          << std::setw(10) << std::setprecision(1) << 100. * total / wallTime << std::endl;
+    }
+  // Le reste : calcul du pas de temps, boucle en temps, initialisation...
+  double other(std::max(wallTime - measured, 0.));
+  out << std::left << std::setw(16) << "Other" << std::right
+      << std::setw(12) << std::setprecision(4) << other
+      << std::setw(18) << std::setprecision(2) << 1e6 * other / steps
+      << std::setw(17) << "-"
+      << std::setw(10) << std::setprecision(1) << 100. * other / wallTime << std::endl;
+  out << std::left << std::setw(16) << "All phases" << std::right
+      << std::setw(12) << std::setprecision(4) << measured
+      << std::setw(18) << std::setprecision(2) << 1e6 * measured / steps
+      << std::setw(17) << std::setprecision(2) << 1e6 * percentile99(stepHistogram)
+      << std::setw(10) << std::setprecision(1) << 100. * measured / wallTime << std::endl;
+  out << std::defaultfloat << std::setprecision(6);
+  out << "Throughput : " << nCellsProfiled * static_cast<double>(nSteps) / wallTime << " cells.steps/s" << std::endl;
+}
+
+
+
+void Profiler::writeJSON(const std::string& fileName)
+{
+  std::ofstream file(fileName);
+  if (!file)
+    {
+      std::cout << termcolor::yellow << "WARNING::PROFILER : Unable to write " << fileName << std::endl;
+      std::cout << termcolor::reset;
+      return;
+    }
+  long steps(std::max(nSteps, 1L));
+  file << std::setprecision(9);
+  file << "{" << std::endl;
+  file << "  \"steps\": " << nSteps << "," << std::endl;
+  file << "  \"cells\": " << nCellsProfiled << "," << std::endl;
+  file << "  \"wallTime\": " << wallTime << "," << std::endl;
+  file << "  \"throughput\": " << nCellsProfiled * static_cast<double>(nSteps) / wallTime << "," << std::endl;
+  file << "  \"stepP99\": " << percentile99(stepHistogram) << "," << std::endl;
+  file << "  \"phases\": [";
+  bool first(true);
+  for (int p(0) ; p < nPhases ; ++p)
+    {
+      if (nCalls[p] == 0)
+        continue;
+      double total(seconds(totalTime[p]));
+      file << (first ? "" : ",") << std::endl;
+      file << "    {\"name\": \"" << phaseNames[p] << "\", \"calls\": " << nCalls[p]
+           << ", \"total\": " << total << ", \"meanPerStep\": " << total / steps
+           << ", \"p99PerStep\": " << percentile99(histogram[p])
+           << ", \"wallFraction\": " << total / wallTime << "}";
+      first = false;
+    }
+  file << std::endl << "  ]" << std::endl;
+  file << "}" << std::endl;
+}
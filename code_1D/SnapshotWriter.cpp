@@ -0,0 +1,110 @@
+#include "SnapshotWriter.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+
+SnapshotWriter::SnapshotWriter():
+  _stop(false)
+{
+}
+
+
+
+SnapshotWriter::~SnapshotWriter()
+{
+  finish();
+}
+
+
+
+void SnapshotWriter::start(const std::function<void(const Snapshot&)>& write, int capacity)
+{
+  finish();
+  _write = write;
+  _buffers.resize(capacity);
+  _pending.clear();
+  _free.clear();
+  for (int i(capacity-1) ; i >= 0 ; --i)
+    {
+      _free.push_back(i);
+    }
+  _stop = false;
+  _thread = std::thread(&SnapshotWriter::run, this);
+}
+
+
+
+void SnapshotWriter::push(const std::string& fileName, double time, const StateMatrix& Sol)
+{
+  // Attend un buffer libre
+  std::unique_lock<std::mutex> lock(_mutex);
+  _condition.wait(lock, [this] {return !_free.empty();});
+  int i(_free.back());
+  _free.pop_back();
+  lock.unlock();
+
+  // Copie de la solution (sans réallocation si la taille ne change pas)
+  _buffers[i].fileName = fileName;
+  _buffers[i].time = time;
+  _buffers[i].Sol = Sol;
+
+  lock.lock();
+  _pending.push_back(i);
+  lock.unlock();
+  _condition.notify_all();
+}
+
+
+
+void SnapshotWriter::run()
+{
+  while (true)
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _condition.wait(lock, [this] {return _stop || !_pending.empty();});
+      if (_pending.empty())
+        {
+          return;
+        }
+      int i(_pending.front());
+      lock.unlock();
+
+      _write(_buffers[i]);
+
+      // Le buffer n'est rendu qu'une fois écrit
+      lock.lock();
+      _pending.pop_front();
+      _free.push_back(i);
+      lock.unlock();
+      _condition.notify_all();
+    }
+}
+
+
+
+void SnapshotWriter::wait()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  _condition.wait(lock, [this] {return _pending.empty();});
+}
+
+
+
+void SnapshotWriter::finish()
+{
+  if (!_thread.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _condition.notify_all();
+  _thread.join();
+}
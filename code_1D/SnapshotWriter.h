@@ -0,0 +1,75 @@
+#ifndef SNAPSHOT_WRITER_H
+#define SNAPSHOT_WRITER_H
+
+#include "Layout.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+
+
+// Une sauvegarde de la solution : copie de la solution à l'instant time
+struct Snapshot
+{
+  std::string fileName;
+  double time;
+  StateMatrix Sol;
+};
+
+
+
+// Écriture des sauvegardes de la solution dans un thread séparé, pour que
+// la boucle en temps continue pendant l'écriture des fichiers.
+//
+// push copie la solution dans un des `capacity` buffers de la file (ils
+// sont réutilisés d'une sauvegarde à l'autre) et rend la main tout de
+// suite. Si tous les buffers attendent d'être écrits, push attend que le
+// thread d'écriture en libère un. Les sauvegardes sont écrites dans
+// l'ordre, par la fonction donnée à start. finish attend que toutes les
+// sauvegardes soient écrites puis arrête le thread.
+class SnapshotWriter
+{
+private:
+  // Fonction d'écriture d'une sauvegarde (appelée par le thread d'écriture)
+  std::function<void(const Snapshot&)> _write;
+
+  // Buffers, indices des sauvegardes à écrire et des buffers libres
+  std::vector<Snapshot> _buffers;
+  std::deque<int> _pending;
+  std::vector<int> _free;
+
+  // Thread d'écriture et synchronisation
+  std::thread _thread;
+  std::mutex _mutex;
+  std::condition_variable _condition;
+  bool _stop;
+
+  // Boucle du thread d'écriture
+  void run();
+  
+public:
+  // Constructeur
+  SnapshotWriter();
+
+  // Destructeur (appelle finish)
+  ~SnapshotWriter();
+
+  // Démarre le thread d'écriture
+  void start(const std::function<void(const Snapshot&)>& write, int capacity = 2);
+
+  // Ajoute une sauvegarde à la file
+  void push(const std::string& fileName, double time, const StateMatrix& Sol);
+
+  // Attend que les sauvegardes en attente soient écrites
+  void wait();
+
+  // Écrit les sauvegardes en attente et arrête le thread
+  void finish();
+};
+
+#endif // SNAPSHOT_WRITER_H
@@ -0,0 +1,248 @@
+#include "SolutionFile.h"
+#include "TextFormat.h"
+#include "Checkpoint.h"
+#include "termcolor.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+
+
+// Version du format, à changer à chaque modification du contenu du fichier
+static const std::uint32_t solutionFileVersion = 1;
+static const char solutionFileMagic[8] = {'T', 'E', 'R', '1', 'D', 'S', 'O', 'L'};
+static const std::uint32_t solutionFileByteOrder = 0x01020304;
+
+
+
+// Arrête le programme en cas d'erreur sur le fichier
+static void solutionFileError(const std::string& message, const std::string& fileName)
+{
+  std::cout << termcolor::red << "ERROR::SOLUTIONFILE : " << message << " " << fileName << std::endl;
+  std::cout << termcolor::reset;
+  exit(-1);
+}
+
+
+
+SolutionFileWriter::SolutionFileWriter():
+  _valueSize(8)
+{
+}
+
+
+
+void SolutionFileWriter::Initialize(const std::string& fileName, const std::string& parameters, const Eigen::VectorXd& cellCenters,
+                                    const Eigen::VectorXd& topography, double g, int valueSize)
+{
+  _file.close();
+  _file.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!_file.is_open())
+    {
+      solutionFileError("Unable to open file", fileName);
+    }
+  _valueSize = valueSize;
+
+  std::int64_t nCells(cellCenters.size());
+  SolutionFileHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, solutionFileMagic, sizeof(header.magic));
+  header.version = solutionFileVersion;
+  header.byteOrder = solutionFileByteOrder;
+  header.valueSize = _valueSize;
+  header.nCells = nCells;
+  header.parametersSize = parameters.size();
+  header.dataOffset = sizeof(header) + header.parametersSize + 2 * nCells * sizeof(double);
+  header.recordSize = sizeof(double) + 2 * nCells * _valueSize;
+  header.g = g;
+
+  _file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  _file.write(parameters.data(), parameters.size());
+  _file.write(reinterpret_cast<const char*>(cellCenters.data()), nCells * sizeof(double));
+  _file.write(reinterpret_cast<const char*>(topography.data()), nCells * sizeof(double));
+  _file.flush();
+
+  _record.resize(header.recordSize);
+}
+
+
+
+void SolutionFileWriter::Resume(const std::string& fileName, int nCells, int valueSize, long long size)
+{
+  _file.close();
+  truncateFile(fileName, size);
+  _file.open(fileName, std::ios::out | std::ios::binary | std::ios::app);
+  if (!_file.is_open())
+    {
+      solutionFileError("Unable to open file", fileName);
+    }
+  _valueSize = valueSize;
+  _record.resize(sizeof(double) + 2 * std::size_t(nCells) * _valueSize);
+}
+
+
+
+// Copie une colonne de la solution dans le buffer, en double ou en float
+template<class Real>
+static char* packColumn(char* p, const StateMatrix& Sol, int j)
+{
+  for (int i(0) ; i < Sol.rows() ; ++i)
+    {
+      Real value(Sol(i,j));
+      std::memcpy(p, &value, sizeof(Real));
+      p += sizeof(Real);
+    }
+  return p;
+}
+
+
+
+void SolutionFileWriter::append(double t, const StateMatrix& Sol)
+{
+  char* p(_record.data());
+  std::memcpy(p, &t, sizeof(double));
+  p += sizeof(double);
+  for (int j(0) ; j < 2 ; ++j)
+    {
+      if (_valueSize == sizeof(float))
+        p = packColumn<float>(p, Sol, j);
+      else
+        p = packColumn<double>(p, Sol, j);
+    }
+  // Le fichier reste lisible pendant le calcul
+  _file.write(_record.data(), _record.size());
+  _file.flush();
+}
+
+
+
+SolutionFileReader::SolutionFileReader():
+  _nRecords(0)
+{
+  std::memset(&_header, 0, sizeof(_header));
+}
+
+
+
+SolutionFileReader::SolutionFileReader(const std::string& fileName):
+  _nRecords(0)
+{
+  Initialize(fileName);
+}
+
+
+
+void SolutionFileReader::Initialize(const std::string& fileName)
+{
+  _fileName = fileName;
+  _file.close();
+  _file.open(fileName, std::ios::in | std::ios::binary);
+  if (!_file.is_open())
+    {
+      solutionFileError("Unable to open file", fileName);
+    }
+
+  // Vérifications de l'en-tête
+  _file.read(reinterpret_cast<char*>(&_header), sizeof(_header));
+  if (!_file || std::memcmp(_header.magic, solutionFileMagic, sizeof(_header.magic)) != 0)
+    {
+      solutionFileError("Not a 1D solution file :", fileName);
+    }
+  if (_header.byteOrder != solutionFileByteOrder)
+    {
+      solutionFileError("The byte order of this machine differs from the one of", fileName);
+    }
+  if (_header.version != solutionFileVersion)
+    {
+      solutionFileError("Unsupported version " + std::to_string(_header.version) + " of", fileName);
+    }
+  if (_header.valueSize != sizeof(float) && _header.valueSize != sizeof(double))
+    {
+      solutionFileError("Invalid value size in", fileName);
+    }
+
+  // Paramètres, maillage et topographie
+  _parameters.resize(_header.parametersSize);
+  _file.read(&_parameters[0], _header.parametersSize);
+  _cellCenters.resize(_header.nCells);
+  _topography.resize(_header.nCells);
+  _file.read(reinterpret_cast<char*>(_cellCenters.data()), _header.nCells * sizeof(double));
+  _file.read(reinterpret_cast<char*>(_topography.data()), _header.nCells * sizeof(double));
+  if (!_file)
+    {
+      solutionFileError("Truncated header in", fileName);
+    }
+
+  // Nombre de sauvegardes complètes (la dernière peut être en cours d'écriture)
+  _file.seekg(0, std::ios::end);
+  std::int64_t fileSize(_file.tellg());
+  _nRecords = std::max<std::int64_t>(0, (fileSize - _header.dataOffset) / _header.recordSize);
+  _record.resize(_header.recordSize);
+}
+
+
+
+// Copie une colonne du buffer dans v, depuis des double ou des float
+template<class Real>
+static const char* unpackColumn(const char* p, Eigen::VectorXd& v)
+{
+  for (int i(0) ; i < v.size() ; ++i)
+    {
+      Real value;
+      std::memcpy(&value, p, sizeof(Real));
+      v(i) = value;
+      p += sizeof(Real);
+    }
+  return p;
+}
+
+
+
+void SolutionFileReader::readRecord(int k, double& t, Eigen::VectorXd& h, Eigen::VectorXd& q)
+{
+  if (k < 0 || k >= _nRecords)
+    {
+      solutionFileError("Record " + std::to_string(k) + " out of range (" + std::to_string(_nRecords) + " records) in", _fileName);
+    }
+  _file.clear();
+  _file.seekg(_header.dataOffset + k * _header.recordSize);
+  _file.read(_record.data(), _record.size());
+
+  const char* p(_record.data());
+  std::memcpy(&t, p, sizeof(double));
+  p += sizeof(double);
+  h.resize(_header.nCells);
+  q.resize(_header.nCells);
+  if (_header.valueSize == sizeof(float))
+    {
+      p = unpackColumn<float>(p, h);
+      p = unpackColumn<float>(p, q);
+    }
+  else
+    {
+      p = unpackColumn<double>(p, h);
+      p = unpackColumn<double>(p, q);
+    }
+}
+
+
+
+void writeSolutionText(const std::string& fileName, const Eigen::VectorXd& cellCenters, const Eigen::VectorXd& topography,
+                       const Eigen::VectorXd& h, const Eigen::VectorXd& q, double g)
+{
+  std::ofstream outputFile(fileName, std::ios::out);
+
+  // Grandeurs dérivées, calculées en une passe sur toutes les cellules
+  Eigen::VectorXd H(h + topography);
+  Eigen::VectorXd u(q.array() / h.array());
+  Eigen::VectorXd Fr(u.array().abs() / (g * h.array()).sqrt());
+
+  // Gnuplot comments for the user
+  outputFile << "# x  H=h+z   h       u       q       Fr=|u|/sqrt(gh)" << "\n";
+  std::vector<const double*> columns = {cellCenters.data(), H.data(), h.data(), u.data(), q.data(), Fr.data()};
+  writeColumns(outputFile, columns, h.size(), ' ');
+}
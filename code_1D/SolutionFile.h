@@ -0,0 +1,110 @@
+#ifndef SOLUTION_FILE_H
+#define SOLUTION_FILE_H
+
+#include "Layout.h"
+#include "Eigen/Eigen/Dense"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+
+// Fichier binaire contenant toutes les sauvegardes de la solution
+// (OutputFormat = Binary), à la place des fichiers solution_*.txt.
+//
+// Contenu du fichier, dans l'ordre :
+//   - l'en-tête SolutionFileHeader ;
+//   - le fichier de paramètres de la simulation (texte, parametersSize octets) ;
+//   - les centres des cellules puis la topographie (nCells double chacun) ;
+//   - les sauvegardes, toutes de la même taille : t (double) puis h et q
+//     (nCells valeurs chacun, en double ou en float selon valueSize).
+// La sauvegarde numéro k est donc à la position dataOffset + k * recordSize,
+// et le nombre de sauvegardes se déduit de la taille du fichier. Les
+// nombres sont écrits dans l'ordre des octets de la machine (voir byteOrder).
+struct SolutionFileHeader
+{
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byteOrder;
+  std::uint32_t valueSize;
+  std::uint32_t reserved;
+  std::int64_t nCells;
+  std::int64_t parametersSize;
+  std::int64_t dataOffset;
+  std::int64_t recordSize;
+  double g;
+};
+
+
+
+// Écriture du fichier, une sauvegarde après l'autre
+class SolutionFileWriter
+{
+private:
+  std::ofstream _file;
+  std::uint32_t _valueSize;
+  // Buffer d'une sauvegarde
+  std::vector<char> _record;
+
+public:
+  // Constructeur
+  SolutionFileWriter();
+
+  // Crée le fichier et écrit l'en-tête, le maillage et la topographie
+  void Initialize(const std::string& fileName, const std::string& parameters, const Eigen::VectorXd& cellCenters,
+                  const Eigen::VectorXd& topography, double g, int valueSize);
+
+  // Reprise d'un calcul : rouvre le fichier existant, ramené à size octets
+  void Resume(const std::string& fileName, int nCells, int valueSize, long long size);
+
+  // Ajoute la solution à l'instant t à la fin du fichier
+  void append(double t, const StateMatrix& Sol);
+};
+
+
+
+// Lecture du fichier, avec accès direct à n'importe quelle sauvegarde
+class SolutionFileReader
+{
+private:
+  std::string _fileName;
+  std::ifstream _file;
+  SolutionFileHeader _header;
+  std::string _parameters;
+  Eigen::VectorXd _cellCenters;
+  Eigen::VectorXd _topography;
+  int _nRecords;
+  // Buffer d'une sauvegarde
+  std::vector<char> _record;
+
+public:
+  // Constructeurs
+  SolutionFileReader();
+  SolutionFileReader(const std::string& fileName);
+
+  // Ouvre le fichier et lit l'en-tête
+  void Initialize(const std::string& fileName);
+
+  // Getters
+  int getNumberOfCells() const {return _header.nCells;};
+  int getNumberOfRecords() const {return _nRecords;};
+  int getValueSize() const {return _header.valueSize;};
+  double getGravityAcceleration() const {return _header.g;};
+  const std::string& getParameters() const {return _parameters;};
+  const Eigen::VectorXd& getCellCenters() const {return _cellCenters;};
+  const Eigen::VectorXd& getTopography() const {return _topography;};
+
+  // Lit la sauvegarde numéro k (0 <= k < getNumberOfRecords())
+  void readRecord(int k, double& t, Eigen::VectorXd& h, Eigen::VectorXd& q);
+};
+
+
+
+// Écrit une solution au format texte des fichiers solution_*.txt :
+// x, H = h+z, h, u, q et Fr = |u|/sqrt(gh), une ligne par cellule
+void writeSolutionText(const std::string& fileName, const Eigen::VectorXd& cellCenters, const Eigen::VectorXd& topography,
+                       const Eigen::VectorXd& h, const Eigen::VectorXd& q, double g);
+
+#endif // SOLUTION_FILE_H
@@ -0,0 +1,92 @@
+#include "SolverState.h"
+
+
+
+//--------------------------------------------//
+//---------------Flux workspace---------------//
+//--------------------------------------------//
+void FluxWorkspace::resize(int nCells)
+{
+  SolG.resize(nCells + 1, 2);
+  SolD.resize(nCells + 1, 2);
+  slopes.resize(nCells + 1, 2);
+  limSlopes.resize(nCells, 2);
+  interfaceFlux.resize(nCells + 1, 2);
+}
+
+
+//----------------------------------------------//
+//---------------Boundary forcing---------------//
+//----------------------------------------------//
+BoundaryForcing::BoundaryForcing():
+  leftImposedHeight(0.), leftImposedDischarge(0.), rightImposedHeight(0.), rightImposedDischarge(0.), leftData(nullptr), rightData(nullptr)
+{
+}
+
+
+//------------------------------------------//
+//---------------Solver state---------------//
+//------------------------------------------//
+SolverState::SolverState():
+  timeStep(0.), maxWaveSpeed(0.), fluxTimeStep(0.)
+{
+}
+
+
+
+SolverState::SolverState(int nCells, double timeStep):
+  timeStep(timeStep), maxWaveSpeed(0.), fluxTimeStep(timeStep)
+{
+  resize(nCells);
+}
+
+
+
+void SolverState::resize(int nCells)
+{
+  // Le terme source du pas de temps précédent sert aux conditions aux
+  // limites dès le premier pas de temps
+  source.setZero(nCells, 2);
+  fluxVector.resize(nCells, 2);
+  workspace.resize(nCells);
+}
+
+
+
+//--------------------------------------------//
+//---------------Ensemble state---------------//
+//--------------------------------------------//
+EnsembleState::EnsembleState():
+  timeStep(0.), maxWaveSpeed(0.)
+{
+}
+
+
+
+EnsembleState::EnsembleState(int nCells, int nMembers, double timeStep):
+  timeStep(timeStep), forcing(nMembers), maxWaveSpeed(0.)
+{
+  resize(nCells, nMembers);
+}
+
+
+
+void EnsembleState::resize(int nCells, int nMembers)
+{
+  forcing.resize(nMembers);
+  // Comme pour SolverState, le terme source sert aux conditions aux limites
+  // dès le premier pas de temps
+  sourceQ.setZero(nCells, nMembers);
+  fluxH.resize(nCells, nMembers);
+  fluxQ.resize(nCells, nMembers);
+  hG.resize(nCells + 1, nMembers);
+  qG.resize(nCells + 1, nMembers);
+  hD.resize(nCells + 1, nMembers);
+  qD.resize(nCells + 1, nMembers);
+  slopesH.resize(nCells + 1, nMembers);
+  slopesQ.resize(nCells + 1, nMembers);
+  limSlopesH.resize(nCells, nMembers);
+  limSlopesQ.resize(nCells, nMembers);
+  interfaceFluxH.resize(nCells + 1, nMembers);
+  interfaceFluxQ.resize(nCells + 1, nMembers);
+}
@@ -0,0 +1,120 @@
+#ifndef SOLVER_STATE_H
+#define SOLVER_STATE_H
+
+#include "Layout.h"
+#include "TimeSeries.h"
+#include "Eigen/Eigen/Dense"
+
+#include <vector>
+
+
+
+// Buffers used by buildFluxVector. They are sized once with the solver state and
+// reused at every call, so that the time loop does not allocate any memory.
+struct FluxWorkspace
+{
+  // Reconstructed values at the left and right of each interface
+  Eigen::Matrix<double, Eigen::Dynamic, 2> SolG, SolD;
+  // Slopes and limited slopes for the MUSCL reconstruction
+  Eigen::Matrix<double, Eigen::Dynamic, 2> slopes, limSlopes;
+  // Numerical flux through each interface
+  Eigen::Matrix<double, Eigen::Dynamic, 2> interfaceFlux;
+
+  // Resize the buffers for a mesh of nCells cells
+  void resize(int nCells);
+};
+
+
+
+// Forçage aux limites d'un calcul : valeurs imposées et données
+// expérimentales (condition aux limites DataFile). Ce sont par défaut celles
+// du fichier de paramètres (Physics::getBoundaryForcing), chaque membre d'un
+// ensemble a les siennes.
+struct BoundaryForcing
+{
+  // Valeurs imposées (conditions ImposedConstantHeight/Discharge)
+  double leftImposedHeight, leftImposedDischarge;
+  double rightImposedHeight, rightImposedDischarge;
+  // Données expérimentales h(t) à gauche et à droite, lues en O(1) à
+  // n'importe quel instant (voir TimeSeries.h)
+  const TimeSeries* leftData;
+  const TimeSeries* rightData;
+
+  BoundaryForcing();
+};
+
+
+
+// État d'un calcul : tout ce qui change pendant la boucle en temps.
+//
+// Le problème (DataFile, Mesh, Physics et FiniteVolume) ne change plus une
+// fois initialisé : ses méthodes sont const et reçoivent l'état du calcul
+// en argument. Plusieurs calculs peuvent ainsi partager le même problème,
+// chacun dans son thread avec son propre TimeScheme, qui possède l'état.
+// Seule exception : le profiler (PROFILING > 0) est global au processus,
+// un seul calcul à la fois doit alors tourner (voir Profiler.h).
+struct SolverState
+{
+  // Pas de temps courant (pas de temps adaptatif)
+  double timeStep;
+  // Forçage aux limites
+  BoundaryForcing forcing;
+
+  // Terme source
+  StateMatrix source;
+  // Vecteur des flux
+  StateMatrix fluxVector;
+  // Plus grande vitesse d'onde |lambda| rencontrée lors du dernier calcul du flux
+  double maxWaveSpeed;
+  // Pas de temps avec lequel fluxVector a été construit (conditions aux
+  // limites en t + dt et flux de Lax-Friedrichs)
+  double fluxTimeStep;
+  // Espace de travail pour la reconstruction
+  FluxWorkspace workspace;
+
+  // Solution exacte (cas tests)
+  Eigen::Matrix<double, Eigen::Dynamic, 2> exactSol;
+
+  // Constructeurs
+  SolverState();
+  SolverState(int nCells, double timeStep);
+
+  // Dimensionne les tableaux pour un maillage de nCells cellules
+  void resize(int nCells);
+};
+
+
+
+// État d'un ensemble de calculs qui ne diffèrent que par leur forçage aux
+// limites (voir Ensemble.h). Chaque tableau a une ligne par cellule (ou par
+// interface) et une colonne par membre.
+struct EnsembleState
+{
+  // Pas de temps, le même pour tous les membres
+  double timeStep;
+  // Forçage aux limites de chaque membre
+  std::vector<BoundaryForcing> forcing;
+
+  // Terme source de q (celui de h est nul)
+  EnsembleMatrix sourceQ;
+  // Vecteur des flux
+  EnsembleMatrix fluxH, fluxQ;
+  // Plus grande vitesse d'onde, tous membres confondus
+  double maxWaveSpeed;
+
+  // Espace de travail pour la reconstruction et les flux aux interfaces
+  EnsembleMatrix hG, qG, hD, qD;
+  EnsembleMatrix slopesH, slopesQ, limSlopesH, limSlopesQ;
+  EnsembleMatrix interfaceFluxH, interfaceFluxQ;
+
+  // Constructeurs
+  EnsembleState();
+  EnsembleState(int nCells, int nMembers, double timeStep);
+
+  int getNumberOfMembers() const {return sourceQ.cols();};
+
+  // Dimensionne les tableaux pour nMembers membres sur nCells cellules
+  void resize(int nCells, int nMembers);
+};
+
+#endif // SOLVER_STATE_H
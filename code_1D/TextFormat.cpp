@@ -0,0 +1,92 @@
+#include "TextFormat.h"
+
+#include <ostream>
+#include <vector>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <cstdio>
+
+#if __cplusplus >= 201703L && defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+
+
+// Nombre de lignes formatées par bloc
+static const int rowsPerBlock = 32768;
+
+
+
+char* formatDouble(char* first, double x)
+{
+#if defined(__cpp_lib_to_chars)
+  return std::to_chars(first, first + maxDoubleLength, x, std::chars_format::general, 6).ptr;
+#else
+  return first + std::snprintf(first, maxDoubleLength, "%g", x);
+#endif
+}
+
+
+
+// Formate les lignes [begin, end) dans buffer, qui est redimensionné
+static void formatRows(const std::vector<const double*>& columns, int begin, int end, char separator,
+                       std::vector<char>& buffer)
+{
+  int nColumns(columns.size());
+  buffer.resize(std::size_t(end - begin) * nColumns * (maxDoubleLength + 1));
+  char* p(buffer.data());
+  for (int i(begin) ; i < end ; ++i)
+    {
+      for (int j(0) ; j < nColumns ; ++j)
+        {
+          if (j > 0)
+            *p++ = separator;
+          p = formatDouble(p, columns[j][i]);
+        }
+      *p++ = '\n';
+    }
+  buffer.resize(p - buffer.data());
+}
+
+
+
+void writeColumns(std::ostream& out, const std::vector<const double*>& columns, int nRows, char separator)
+{
+  int nBlocks((nRows + rowsPerBlock - 1) / rowsPerBlock);
+  int nThreads(std::min<int>(std::thread::hardware_concurrency(), nBlocks));
+
+  // Petit tableau ou une seule unité de calcul : pas de thread
+  if (nThreads <= 1)
+    {
+      std::vector<char> buffer;
+      for (int b(0) ; b < nBlocks ; ++b)
+        {
+          formatRows(columns, b * rowsPerBlock, std::min(nRows, (b + 1) * rowsPerBlock), separator, buffer);
+          out.write(buffer.data(), buffer.size());
+        }
+      return;
+    }
+
+  // Les blocs sont traités par vagues de nThreads, le thread t formatant le
+  // bloc numéro t de la vague. Les buffers sont écrits dans l'ordre.
+  std::vector<std::vector<char> > buffers(nThreads);
+  std::vector<std::thread> threads(nThreads);
+  for (int wave(0) ; wave < nBlocks ; wave += nThreads)
+    {
+      int nActive(std::min(nThreads, nBlocks - wave));
+      for (int t(0) ; t < nActive ; ++t)
+        {
+          int b(wave + t);
+          threads[t] = std::thread(formatRows, std::cref(columns), b * rowsPerBlock, std::min(nRows, (b + 1) * rowsPerBlock),
+                                   separator, std::ref(buffers[t]));
+        }
+      for (int t(0) ; t < nActive ; ++t)
+        {
+          threads[t].join();
+          out.write(buffers[t].data(), buffers[t].size());
+        }
+    }
+}
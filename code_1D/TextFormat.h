@@ -0,0 +1,26 @@
+#ifndef TEXT_FORMAT_H
+#define TEXT_FORMAT_H
+
+#include <ostream>
+#include <vector>
+
+
+
+// Écriture rapide de nombres en texte, au même format que operator<< avec
+// les réglages par défaut d'un flux (printf "%g", 6 chiffres significatifs).
+// Les nombres sont formatés avec std::to_chars (C++17) ou, à défaut, avec
+// snprintf, dans un grand buffer écrit d'un seul coup.
+
+// Nombre maximal de caractères écrits par formatDouble
+const int maxDoubleLength = 32;
+
+// Écrit x dans [first, first + maxDoubleLength) et renvoie la fin du texte
+char* formatDouble(char* first, double x);
+
+// Écrit un tableau de nRows lignes, la colonne j étant columns[j][0..nRows).
+// Les valeurs d'une ligne sont séparées par separator et chaque ligne finit
+// par "\n". Pour les grands tableaux, les blocs de lignes sont formatés en
+// parallèle puis écrits dans l'ordre.
+void writeColumns(std::ostream& out, const std::vector<const double*>& columns, int nRows, char separator);
+
+#endif // TEXT_FORMAT_H
@@ -3,6 +3,10 @@
 #include "Mesh.h"
 #include "Physics.h"
 #include "FiniteVolume.h"
+#include "AllocationCounter.h"
+#include "TextFormat.h"
+#include "Checkpoint.h"
+#include "Profiler.h"
 
 #include "Eigen/Eigen/Dense"
 #include "Eigen/Eigen/Sparse"
@@ -12,32 +16,40 @@
 #include <string>
 #include <cmath>
 #include <vector>
+#include <algorithm>
+#include <iterator>
+#include <chrono>
 
 
 
 //----------------------------------------------------------//
 //------------------Time Scheme base class------------------//
 //----------------------------------------------------------//
-TimeScheme::TimeScheme()
+TimeScheme::TimeScheme():
+  _isSolFluxBuilt(false), _parametersHash(0), _log(&std::cout)
 {
 }
 
 
 
-TimeScheme::TimeScheme(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol):
-  _DF(DF), _mesh(mesh), _physics(physics), _finVol(finVol), _Sol(_physics->getInitialCondition()), _timeStep(DF->getTimeStep()), _initialTime(DF->getInitialTime()), _finalTime(DF->getFinalTime()), _currentTime(_initialTime), _nProbes(_DF->getNumberOfProbes()), _probesRef(_DF->getProbesReferences()), _probesPos(_DF->getProbesPositions()), _probesIndices(_nProbes, 0)
+TimeScheme::TimeScheme(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol):
+  _DF(DF), _mesh(mesh), _physics(physics), _finVol(finVol), _plan(DF->getRunPlan()), _Sol(_physics->getInitialCondition()), _state(mesh->getNumberOfCells(), DF->getTimeStep()), _isSolFluxBuilt(false), _timeStep(DF->getTimeStep()), _initialTime(DF->getInitialTime()), _finalTime(DF->getFinalTime()), _currentTime(_initialTime), _nProbes(_DF->getNumberOfProbes()), _probesRef(_DF->getProbesReferences()), _probesPos(_DF->getProbesPositions()), _probesIndices(_nProbes, 0), _parametersHash(0), _log(&std::cout)
 {
+  _state.forcing = _physics->getBoundaryForcing();
 }
 
 
 
-void TimeScheme::Initialize(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol)
+void TimeScheme::Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol)
 {
   _DF = DF;
   _mesh = mesh;
   _physics = physics;
   _finVol = finVol;
+  _plan = DF->getRunPlan();
   _Sol = _physics->getInitialCondition();
+  _state = SolverState(mesh->getNumberOfCells(), DF->getTimeStep());
+  _state.forcing = physics->getBoundaryForcing();
   _timeStep = DF->getTimeStep();
   _initialTime = DF->getInitialTime();
   _finalTime = DF->getFinalTime();
@@ -52,71 +64,272 @@ void TimeScheme::Initialize(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVo
 
 void TimeScheme::buildProbesCellIndices()
 {
-  int nbCells(_mesh->getNumberOfCells());
-  const Eigen::VectorXd& cellCenters(_mesh->getCellCenters());
   for (int i(0) ; i < _nProbes ; ++i)
     {
-      double pos(_probesPos[i]);
-      int index(0);
-      double distMin(abs(pos - cellCenters(0))), dist;
-      for (int k(0) ; k < nbCells ; ++k)
-        {
-          double x(cellCenters(k));
-          dist = abs(pos - x);
-          if (dist < distMin)
-            {
-              distMin = dist;
-              index = k;
-            }
-        }
-      _probesIndices[i] = index;
+      _probesIndices[i] = _mesh->findNearestCell(_probesPos[i]);
     }
 }
 
 
 
-void TimeScheme::saveCurrentSolution(std::string& fileName) const
+void TimeScheme::setTimeStep(double timeStep)
+{
+  _timeStep = timeStep;
+  _state.timeStep = timeStep;
+}
+
+
+
+void TimeScheme::saveCurrentSolution(std::string& fileName)
 {
+  PROFILE_SCOPE(Output);
 #if VERBOSITY>0
-  std::cout << "Saving solution at t = " << _currentTime << std::endl;
+  *_log << "Saving solution at t = " << _currentTime << std::endl;
 #endif
-  std::ofstream outputFile(fileName, std::ios::out);
-  const Eigen::VectorXd& cellCenters(_mesh->getCellCenters());
-  double g(_DF->getGravityAcceleration());
-  // Gnuplot comments for the user
-  outputFile << "# x  H=h+z   h       u       q       Fr=|u|/sqrt(gh)" << std::endl;
-  for (int i(0) ; i < _Sol.rows() ; ++i)
+  // Copie de la solution, le fichier est écrit par le thread de sauvegarde
+  _snapshotWriter.push(fileName, _currentTime, _Sol);
+}
+
+
+
+// Écrit une sauvegarde dans le format choisi (appelé par le thread de sauvegarde)
+void TimeScheme::writeSolution(const Snapshot& snapshot)
+{
+  switch (_plan.outputFormat)
     {
-      outputFile << cellCenters(i) << " " <<
-        _Sol(i,0) + _physics->getTopography()(i) << " " <<
-        _Sol(i,0) << " " <<
-        _Sol(i,1)/_Sol(i,0) << " " <<
-        _Sol(i,1) << " " <<
-        abs(_Sol(i,1)/_Sol(i,0))/sqrt(g * _Sol(i,0)) << std::endl;
+    case OutputFormatType::Text:
+      {
+        Eigen::VectorXd h(snapshot.Sol.col(0)), q(snapshot.Sol.col(1));
+        writeSolutionText(snapshot.fileName, _mesh->getCellCenters(), _physics->getTopography(), h, q, _plan.g);
+        break;
+      }
+    case OutputFormatType::Binary:
+      _solutionFile.append(snapshot.time, snapshot.Sol);
+      break;
     }
 }
 
 
 
-void TimeScheme::saveProbes() const
+void TimeScheme::saveProbes()
 {
-  // Get the probes parameters
-  int nbProbes(_DF->getNumberOfProbes());
-  double g(_DF->getGravityAcceleration());
-  // Loop on each probe and save the wanted quantities
-  for (int i(0) ; i < nbProbes ; ++i)
+  PROFILE_SCOPE(Output);
+  _probeRecorder.record(_currentTime, _Sol);
+}
+
+
+
+void TimeScheme::openTimeStepHistory(long long size)
+{
+  std::string fileName(_DF->getResultsDirectory() + "/time_steps.txt");
+  if (size > 0)
+    {
+      // Reprise : le fichier tel qu'il était au point de reprise
+      truncateFile(fileName, size);
+      _timeStepFile.open(fileName, std::ios::out | std::ios::app);
+    }
+  else
     {
-      std::string fileName(_DF->getResultsDirectory() + "/probe_" + std::to_string(_probesRef[i]) + ".txt");
-      std::ofstream outputFile(fileName, std::ios::app);
-      int index(_probesIndices[i]);
+      _timeStepFile.open(fileName, std::ios::out | std::ios::trunc);
       // Gnuplot comments for the user
-      outputFile << _currentTime << "," <<
-        _Sol(index,0) + _physics->getTopography()(index) << "," <<
-        _Sol(index,0) << "," <<
-        _Sol(index,1)/_Sol(index,0) << "," <<
-        _Sol(index,1) << "," <<
-        abs(_Sol(index,1)/_Sol(index,0))/sqrt(g * _Sol(index,0)) << std::endl;
+      _timeStepFile << "# n  t       dt" << std::endl;
+    }
+}
+
+
+
+void TimeScheme::recordTimeStep()
+{
+  PROFILE_SCOPE(Output);
+  ++_nAdaptiveSteps;
+  _dtMin = (_nAdaptiveSteps == 1 ? _timeStep : std::min(_dtMin, _timeStep));
+  _dtMax = std::max(_dtMax, _timeStep);
+  _dtSum += _timeStep;
+  _timeStepFile << _nAdaptiveSteps << " " << _currentTime << " " << _timeStep << "\n";
+}
+
+
+
+void TimeScheme::closeTimeStepHistory()
+{
+  _timeStepFile.close();
+
+  // Petit résumé
+  if (_nAdaptiveSteps == 0)
+    return;
+  *_log << "Adaptive time step : " << _nAdaptiveSteps << " steps, dt min = " << _dtMin << ", dt max = " << _dtMax << ", dt mean = " << _dtSum / _nAdaptiveSteps << std::endl;
+}
+
+
+
+std::vector<double> TimeScheme::getProbesTopography() const
+{
+  std::vector<double> probesTopography(_nProbes);
+  for (int i(0) ; i < _nProbes ; ++i)
+    probesTopography[i] = _physics->getTopography()(_probesIndices[i]);
+  return probesTopography;
+}
+
+
+
+// Le terme source est construit avant le flux : les conditions aux limites
+// utilisent celui de l'étage en cours. Au premier étage, ceux de _Sol peuvent
+// déjà avoir été construits par solve() (pas de temps adaptatif). Comme pour
+// RK2, la mise à jour est faite sur les tableaux à plat, par blocs qui
+// tiennent dans le cache L1, et out peut être U ou _Sol (opérations terme à
+// terme).
+void TimeScheme::sspStage(double t, const StateMatrix& U, double a, double b, StateMatrix& out)
+{
+  typedef Eigen::Map<Eigen::ArrayXd> FlatArray;
+  typedef Eigen::Map<const Eigen::ArrayXd> ConstFlatArray;
+  const int blockSize(512);
+  int size(_Sol.size());
+  double dt(_state.timeStep);
+  double dx(_mesh->getSpaceStep());
+
+  if (&U == &_Sol && _isSolFluxBuilt)
+    {
+      _finVol->updateFluxTimeStep(t, U, _state);
+    }
+  else
+    {
+      _physics->buildSourceTerm(U, _state);
+      _finVol->buildFluxVector(t, U, _state);
+    }
+  for (int begin(0) ; begin < size ; begin += blockSize)
+    {
+      int n(std::min(blockSize, size - begin));
+      ConstFlatArray fluxVector(_state.fluxVector.data() + begin, n), source(_state.source.data() + begin, n);
+      ConstFlatArray Ublock(U.data() + begin, n);
+      FlatArray outBlock(out.data() + begin, n);
+      if (a == 0.)
+        {
+          outBlock = b * (Ublock + dt * (fluxVector / dx + source));
+        }
+      else
+        {
+          ConstFlatArray Sol(_Sol.data() + begin, n);
+          outBlock = a * Sol + b * (Ublock + dt * (fluxVector / dx + source));
+        }
+    }
+}
+
+
+
+// Avec le pas de temps adaptatif, le terme source et le flux de _Sol ont été
+// construits par solve() avant de choisir le pas de temps : seules les parties
+// du flux qui dépendent du pas de temps sont refaites
+void TimeScheme::buildSolFluxAndSource()
+{
+  if (_isSolFluxBuilt)
+    {
+      _finVol->updateFluxTimeStep(_currentTime, _Sol, _state);
+    }
+  else
+    {
+      _finVol->buildFluxVector(_currentTime, _Sol, _state);
+      _physics->buildSourceTerm(_Sol, _state);
+    }
+}
+
+
+
+// Écrit un point de reprise avec tout l'état de la boucle en temps. Les
+// sauvegardes en attente et les sondes sont d'abord écrites, pour que la
+// taille des fichiers de sortie enregistrée corresponde à cet état.
+void TimeScheme::writeCheckpoint(int n, int nSaves, int nProbesSaves)
+{
+  PROFILE_SCOPE(Output);
+  std::string resultsDir(_DF->getResultsDirectory());
+  _snapshotWriter.wait();
+  if (_nProbes != 0)
+    {
+      _probeRecorder.flush();
     }
+
+  Checkpoint checkpoint;
+  checkpoint.put<long long>(_Sol.rows());
+  checkpoint.put(_parametersHash);
+  checkpoint.put<int>(static_cast<int>(_plan.outputFormat));
+  checkpoint.put(_plan.binaryValueSize);
+  checkpoint.put(_currentTime);
+  checkpoint.put(_timeStep);
+  checkpoint.put(n);
+  checkpoint.put(nSaves);
+  checkpoint.put(nProbesSaves);
+  checkpoint.putMatrix(_Sol);
+  _timeStepFile.flush();
+  checkpoint.put(_nAdaptiveSteps);
+  checkpoint.put(_dtMin);
+  checkpoint.put(_dtMax);
+  checkpoint.put(_dtSum);
+  _physics->writeCheckpoint(checkpoint, _state);
+  checkpoint.put(fileSize(resultsDir + "/solution_" + _finVol->getFluxName() + ".bin"));
+  checkpoint.put(fileSize(resultsDir + "/probes.csv"));
+  checkpoint.put(fileSize(resultsDir + "/time_steps.txt"));
+  checkpoint.save(resultsDir + "/checkpoint.bin");
+#if VERBOSITY>0
+  *_log << "Checkpoint at t = " << _currentTime << std::endl;
+#endif
+}
+
+
+
+// Relit un point de reprise et remet les fichiers de sortie dans l'état où
+// ils étaient à ce moment
+void TimeScheme::readCheckpoint(const std::string& fileName, int& n, int& nSaves, int& nProbesSaves)
+{
+  std::string resultsDir(_DF->getResultsDirectory());
+  Checkpoint checkpoint;
+  checkpoint.load(fileName);
+  if (checkpoint.get<long long>() != _Sol.rows())
+    {
+      std::cout << termcolor::red << "ERROR::TIMESCHEME : The checkpoint " << fileName << " was written with another mesh." << std::endl;
+      std::cout << termcolor::reset;
+      exit(-1);
+    }
+  if (checkpoint.get<unsigned long long>() != _parametersHash)
+    {
+      std::cout << termcolor::yellow << "WARNING::TIMESCHEME : The data file changed since the checkpoint " << fileName << " was written." << std::endl;
+      std::cout << termcolor::reset;
+    }
+  int outputFormat(checkpoint.get<int>()), binaryValueSize(checkpoint.get<int>());
+  if (outputFormat != static_cast<int>(_plan.outputFormat) || binaryValueSize != _plan.binaryValueSize)
+    {
+      std::cout << termcolor::red << "ERROR::TIMESCHEME : OutputFormat and BinaryPrecision must be the same as in the checkpoint " << fileName << std::endl;
+      std::cout << termcolor::reset;
+      exit(-1);
+    }
+  _currentTime = checkpoint.get<double>();
+  setTimeStep(checkpoint.get<double>());
+  n = checkpoint.get<int>();
+  nSaves = checkpoint.get<int>();
+  nProbesSaves = checkpoint.get<int>();
+  checkpoint.getMatrix(_Sol);
+  _nAdaptiveSteps = checkpoint.get<int>();
+  _dtMin = checkpoint.get<double>();
+  _dtMax = checkpoint.get<double>();
+  _dtSum = checkpoint.get<double>();
+  _physics->readCheckpoint(checkpoint, _state);
+  long long solutionFileSize(checkpoint.get<long long>()), probesFileSize(checkpoint.get<long long>());
+  long long timeStepsFileSize(checkpoint.get<long long>());
+
+  // Fichiers de sortie
+  if (_plan.outputFormat == OutputFormatType::Binary)
+    {
+      _solutionFile.Resume(resultsDir + "/solution_" + _finVol->getFluxName() + ".bin", _Sol.rows(), _plan.binaryValueSize, solutionFileSize);
+    }
+  if (_nProbes != 0)
+    {
+      _probeRecorder.Resume(resultsDir + "/probes.csv", _probesRef, _probesIndices, getProbesTopography(), _plan.g, probesFileSize);
+    }
+  if (_plan.isAdaptiveTimeStep)
+    {
+      openTimeStepHistory(timeStepsFileSize);
+    }
+#if VERBOSITY>0
+  *_log << "Restarting from t = " << _currentTime << " (" << fileName << ")" << std::endl;
+#endif
 }
 
 
@@ -125,68 +338,235 @@ void TimeScheme::solve()
 {
   // Logs de début
 #if VERBOSITY>0
-  std::cout << "====================================================================================================" << std::endl;
-  std::cout << "Time loop..." << std::endl;
+  *_log << "====================================================================================================" << std::endl;
+  *_log << "Time loop..." << std::endl;
+#endif
+#if PROFILING>0
+  Profiler::start();
 #endif
   
   // Variables pratiques
   int n(0);
   std::string resultsDir(_DF->getResultsDirectory());
   std::string fluxName(_finVol->getFluxName());
+  std::ifstream parametersFile(_DF->getFileName());
+  std::string parameters((std::istreambuf_iterator<char>(parametersFile)), std::istreambuf_iterator<char>());
+  _parametersHash = stringHash(parameters);
 
-  // Sauvegarde la condition initiale
-  std::string fileName(resultsDir + "/solution_" + fluxName + "_" + std::to_string(n) + ".txt");
-  saveCurrentSolution(fileName);
+  // Trouve les indices des cellules dans lesquelles sont les sondes
+  buildProbesCellIndices();
 
-  // Sauvegarde la topographie
-  std::string topoFileName(resultsDir + "/topography.txt");
-  std::ofstream topoFile(topoFileName, std::ios::out);
-  for (int i(0) ; i < _Sol.rows() ; ++i)
+  // Avec le pas de temps adaptatif, on sauvegarde aux mêmes instants qu'avec
+  // le pas de temps fixe TimeStep : le pas de temps est réduit pour tomber
+  // exactement sur ces instants ainsi que sur le temps final.
+  int probesFrequency(_plan.probeSampling);
+  int nSaves(0), nProbesSaves(0);
+  double tol(1e-6 * _plan.timeStep);
+  double dx(_mesh->getSpaceStep());
+
+  if (_DF->isRestart())
     {
-      topoFile << _mesh->getCellCenters()(i) << " " << _physics->getTopography()(i) << std::endl;
+      // Reprise : état de la boucle en temps et fichiers de sortie tels
+      // qu'ils étaient au moment du point de reprise
+      readCheckpoint(_DF->getRestartFile(), n, nSaves, nProbesSaves);
+      _snapshotWriter.start([this](const Snapshot& snapshot) {writeSolution(snapshot);});
     }
+  else
+    {
+      // Fichier binaire : en-tête avec le fichier de paramètres, le maillage et la topographie
+      if (_plan.outputFormat == OutputFormatType::Binary)
+        {
+          _solutionFile.Initialize(resultsDir + "/solution_" + fluxName + ".bin", parameters, _mesh->getCellCenters(),
+                                   _physics->getTopography(), _plan.g, _plan.binaryValueSize);
+        }
 
-  // Trouve les indices des cellules dans lesquelles sont les sondes
-  buildProbesCellIndices();
+      // Thread de sauvegarde : deux copies de la solution au plus en attente
+      _snapshotWriter.start([this](const Snapshot& snapshot) {writeSolution(snapshot);});
+
+      // Sauvegarde la condition initiale
+      std::string fileName(resultsDir + "/solution_" + fluxName + "_" + std::to_string(n) + ".txt");
+      saveCurrentSolution(fileName);
+
+      // Sauvegarde la topographie (déjà dans le fichier binaire)
+      if (_plan.outputFormat == OutputFormatType::Text)
+        {
+          std::string topoFileName(resultsDir + "/topography.txt");
+          std::ofstream topoFile(topoFileName, std::ios::out);
+          std::vector<const double*> topoColumns = {_mesh->getCellCenters().data(), _physics->getTopography().data()};
+          writeColumns(topoFile, topoColumns, _Sol.rows(), ' ');
+        }
+
+      if (_nProbes != 0)
+        {
+          _probeRecorder.Initialize(resultsDir + "/probes.csv", _probesRef, _probesIndices, getProbesTopography(), _plan.g);
+        }
+
+      if (_plan.isAdaptiveTimeStep)
+        {
+          _nAdaptiveSteps = 0;
+          _dtMin = 0.;
+          _dtMax = 0.;
+          _dtSum = 0.;
+          openTimeStepHistory(0);
+        }
+    }
+
+  // Nombre d'allocations faites par oneStep (mode debug uniquement)
+  long stepAllocations(0);
+
+  // Points de reprise toutes les CheckpointInterval secondes
+  std::chrono::steady_clock::duration checkpointInterval(std::chrono::duration_cast<std::chrono::steady_clock::duration>
+                                                         (std::chrono::duration<double>(_plan.checkpointInterval)));
+  std::chrono::steady_clock::time_point nextCheckpoint(std::chrono::steady_clock::now() + checkpointInterval);
   
+#if PROFILING>0
+  Profiler::beginTimeLoop();
+#endif
+
   // Boucle en temps
   while (_currentTime < _finalTime)
     {
-      oneStep();
-      ++n;
-      _currentTime += _timeStep;
+      bool isSaveTime(false), isProbesTime(false);
+      if (_plan.isAdaptiveTimeStep)
+        {
+          // Prochain instant à atteindre exactement
+          double nextSaveTime(_initialTime + ((nSaves + 1) * _plan.saveFrequency) * _plan.timeStep);
+          double nextProbesTime(_initialTime + ((nProbesSaves + 1) * probesFrequency) * _plan.timeStep);
+          double nextEventTime(_finalTime);
+          if (!_plan.isSaveFinalTimeOnly)
+            nextEventTime = std::min(nextEventTime, nextSaveTime);
+          if (probesFrequency > 0)
+            nextEventTime = std::min(nextEventTime, nextProbesTime);
+          if (nextEventTime > _finalTime - tol)
+            nextEventTime = _finalTime;
+          // Condition CFL avec la vitesse d'onde de la solution courante,
+          // conditions aux limites comprises (et non celle du dernier étage
+          // du pas précédent). Le terme source et le flux construits ici
+          // servent au premier étage du schéma. On coupe en deux le reste
+          // avant le prochain instant plutôt que de laisser un tout petit
+          // dernier pas de temps.
+          _physics->buildSourceTerm(_Sol, _state);
+          _finVol->buildFluxVector(_currentTime, _Sol, _state);
+          double timeStep(_plan.CFL * dx / _state.maxWaveSpeed);
+          // Le pas de temps s'effondre quand le schéma devient instable
+          // (vitesse d'onde infinie, ou NaN dès qu'une cellule l'est) : le temps
+          // n'avancerait plus
+          if (!std::isfinite(timeStep) || !(timeStep > 1e-10 * _plan.timeStep))
+            {
+              std::cout << termcolor::red << "ERROR::TIMESCHEME : The adaptive time step collapsed (dt = " << timeStep << " at t = " << _currentTime
+                        << "), the scheme is probably unstable : reduce the CFL." << std::endl;
+              std::cout << termcolor::reset;
+              exit(-1);
+            }
+          double nextTime(_currentTime + timeStep);
+          if (nextTime > nextEventTime - tol)
+            nextTime = nextEventTime;
+          else if (nextTime + timeStep > nextEventTime)
+            nextTime = 0.5 * (_currentTime + nextEventTime);
+          setTimeStep(nextTime - _currentTime);
+
+          long allocationsBefore(AllocationCounter::getCount());
+          _isSolFluxBuilt = true;
+          oneStep();
+          _isSolFluxBuilt = false;
+          stepAllocations += AllocationCounter::getCount() - allocationsBefore;
+          ++n;
+          _currentTime = nextTime;
+          recordTimeStep();
+
+          while (_currentTime > _initialTime + ((nSaves + 1) * _plan.saveFrequency) * _plan.timeStep - tol)
+            {
+              ++nSaves;
+              isSaveTime = true;
+            }
+          while (probesFrequency > 0 && _currentTime > _initialTime + ((nProbesSaves + 1) * probesFrequency) * _plan.timeStep - tol)
+            {
+              ++nProbesSaves;
+              isProbesTime = true;
+            }
+        }
+      else
+        {
+          long allocationsBefore(AllocationCounter::getCount());
+          oneStep();
+          stepAllocations += AllocationCounter::getCount() - allocationsBefore;
+          ++n;
+          _currentTime += _timeStep;
+          nSaves = n/_plan.saveFrequency;
+          isSaveTime = (n % _plan.saveFrequency == 0);
+          isProbesTime = (probesFrequency > 0 && n % probesFrequency == 0);
+        }
       // Save solution at time t
-      if (!_DF->isSaveFinalTimeOnly() &&  n % _DF->getSaveFrequency() == 0)
+      if (!_plan.isSaveFinalTimeOnly && isSaveTime)
         {
-          std::string fileName(resultsDir + "/solution_" + fluxName + "_" + std::to_string(n/_DF->getSaveFrequency()) + ".txt");
+          std::string fileName(resultsDir + "/solution_" + fluxName + "_" + std::to_string(nSaves) + ".txt");
           saveCurrentSolution(fileName);
         }
       // Save probes
-      if (_nProbes != 0 && n % (_DF->getSaveFrequency()/10) == 0)
+      if (isProbesTime)
         {
           saveProbes();
         }
+      // Checkpoint
+      if (_plan.checkpointInterval > 0 && std::chrono::steady_clock::now() >= nextCheckpoint)
+        {
+          writeCheckpoint(n, nSaves, nProbesSaves);
+          nextCheckpoint = std::chrono::steady_clock::now() + checkpointInterval;
+        }
+#if PROFILING>0
+      Profiler::endStep();
+#endif
     }
   // End of time loop
+  if (_nProbes != 0)
+    {
+      PROFILE_SCOPE(Output);
+      _probeRecorder.flush();
+    }
   if (_DF->isSaveFinalTimeOnly())
     {
-      std::string fileName(resultsDir + "/solution_" + fluxName + "_" + std::to_string(n/_DF->getSaveFrequency()) + ".txt");
+      std::string fileName(resultsDir + "/solution_" + fluxName + "_" + std::to_string(nSaves) + ".txt");
       saveCurrentSolution(fileName);
     }
+  // Attend la fin de l'écriture des sauvegardes
+  {
+    PROFILE_SCOPE(Output);
+    _snapshotWriter.finish();
+  }
+  // Dernier point de reprise, pour pouvoir prolonger le calcul
+  if (_plan.checkpointInterval > 0)
+    {
+      writeCheckpoint(n, nSaves, nProbesSaves);
+    }
+  if (_plan.isAdaptiveTimeStep)
+    {
+      closeTimeStepHistory();
+    }
+#if PROFILING>0
+  Profiler::stop(_Sol.rows());
+  Profiler::printReport(*_log);
+#if PROFILING>1
+  Profiler::writeJSON(resultsDir + "/profile.json");
+#endif
+#endif
   if (_DF->isTestCase())
     {
-      _physics->buildExactSolution(_currentTime);
+      _physics->buildExactSolution(_currentTime, _state);
       std::string fileName(resultsDir + "/solution_exacte.txt");
-      _physics->saveExactSolution(fileName);
+      _physics->saveExactSolution(fileName, _state);
       Eigen::Vector2d L2error(computeL2Error());
-      std::cout << "Error h  L2 = " << L2error(0) << " and error q L2 = " << L2error(1) << " for dx = " << _DF->getDx() << std::endl;
+      *_log << "Error h  L2 = " << L2error(0) << " and error q L2 = " << L2error(1) << " for dx = " << _DF->getDx() << std::endl;
       Eigen::Vector2d L1error(computeL1Error());
-      std::cout << "Error h  L1 = " << L1error(0) << " and error q L1 = " << L1error(1) << " for dx = " << _DF->getDx() << std::endl;
+      *_log << "Error h  L1 = " << L1error(0) << " and error q L1 = " << L1error(1) << " for dx = " << _DF->getDx() << std::endl;
+    }
+  if (AllocationCounter::isEnabled())
+    {
+      *_log << "DEBUG::TIMESCHEME : " << stepAllocations << " heap allocations in " << n << " time steps." << std::endl;
     }
   // Logs de fin
 #if VERBOSITY>0
-  std::cout << termcolor::green << "TIMESCHEME::SUCCESS : Solved 1D St-Venant equations successfully !" << std::endl;
-  std::cout << termcolor::reset << "====================================================================================================" << std::endl << std::endl;
+  *_log << termcolor::green << "TIMESCHEME::SUCCESS : Solved 1D St-Venant equations successfully !" << std::endl;
+  *_log << termcolor::reset << "====================================================================================================" << std::endl << std::endl;
 #endif
 }
 
@@ -194,7 +574,7 @@ void TimeScheme::solve()
 Eigen::Vector2d TimeScheme::computeL2Error() const
 {
   Eigen::Vector2d error(0., 0.);
-  const Eigen::Matrix<double, Eigen::Dynamic, 2>& exactSol(_physics->getExactSolution());
+  const Eigen::Matrix<double, Eigen::Dynamic, 2>& exactSol(_state.exactSol);
   error(0) = (_Sol.col(0) - exactSol.col(0)).norm();
   error(1) = (_Sol.col(1) - exactSol.col(1)).norm();
   error *= _DF->getDx();
@@ -205,7 +585,7 @@ Eigen::Vector2d TimeScheme::computeL2Error() const
 Eigen::Vector2d TimeScheme::computeL1Error() const
 {
   Eigen::Vector2d error(0., 0.);
-  const Eigen::Matrix<double, Eigen::Dynamic, 2>& exactSol(_physics->getExactSolution());
+  const Eigen::Matrix<double, Eigen::Dynamic, 2>& exactSol(_state.exactSol);
   for (int i(0) ; i < _Sol.rows() ; ++i)
     {
       error(0) += abs(_Sol(i,0) - exactSol(i,0));
@@ -226,20 +606,23 @@ ExplicitEuler::ExplicitEuler():
 
 
 
-ExplicitEuler::ExplicitEuler(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol):
+ExplicitEuler::ExplicitEuler(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol):
   TimeScheme(DF, mesh, physics, finVol)
 {
 }
 
 
 
-void ExplicitEuler::Initialize(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol)
+void ExplicitEuler::Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol)
 {
   _DF = DF;
   _mesh = mesh;
   _physics = physics;
   _finVol = finVol;
+  _plan = DF->getRunPlan();
   _Sol.resize(mesh->getNumberOfCells(), 2);
+  _state = SolverState(mesh->getNumberOfCells(), DF->getTimeStep());
+  _state.forcing = physics->getBoundaryForcing();
   _timeStep = DF->getTimeStep();
   _initialTime = DF->getInitialTime();
   _finalTime = DF->getFinalTime();
@@ -250,16 +633,18 @@ void ExplicitEuler::Initialize(DataFile* DF, Mesh* mesh, Physics* physics, Finit
 
 void ExplicitEuler::oneStep()
 {
+  // Hors flux et terme source (mesurés à part), tout est mise à jour de la solution
+  PROFILE_SCOPE(Update);
+
   // Récupération des trucs importants
   double dt(_timeStep);
   double dx(_mesh->getSpaceStep());
 
   // Construction du terme source et du flux numérique
-  _finVol->buildFluxVector(_currentTime, _Sol);
-  _physics->buildSourceTerm(_Sol);
+  buildSolFluxAndSource();
   // Recuperation du terme source et du flux numerique
-  const Eigen::Matrix<double, Eigen::Dynamic, 2>& source(_physics->getSourceTerm());
-  const Eigen::Matrix<double, Eigen::Dynamic, 2>& fluxVector(_finVol->getFluxVector());
+  const StateMatrix& source(_state.source);
+  const StateMatrix& fluxVector(_state.fluxVector);
 
   // Mise à jour de la solution sur chaque cellules
   _Sol += dt * (fluxVector / dx + source);
@@ -276,50 +661,183 @@ RK2::RK2():
 
 
 
-RK2::RK2(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol):
-  TimeScheme(DF, mesh, physics, finVol)
+RK2::RK2(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol):
+  TimeScheme(DF, mesh, physics, finVol), _k1(_Sol.rows(), 2), _stageSol(_Sol.rows(), 2)
 {
 }
 
 
 
-void RK2::Initialize(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol)
+void RK2::Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol)
 {
   _DF = DF;
   _mesh = mesh;
   _physics = physics;
   _finVol = finVol;
+  _plan = DF->getRunPlan();
   _Sol.resize(mesh->getNumberOfCells(), 2);
+  _state = SolverState(mesh->getNumberOfCells(), DF->getTimeStep());
+  _state.forcing = physics->getBoundaryForcing();
   _timeStep = DF->getTimeStep();
   _initialTime = DF->getInitialTime();
   _finalTime = DF->getFinalTime();
   _currentTime = _initialTime; 
+  _k1.resize(mesh->getNumberOfCells(), 2);
+  _stageSol.resize(mesh->getNumberOfCells(), 2);
 }
 
 
 
 void RK2::oneStep()
 {
+  // Hors flux et terme source (mesurés à part), tout est mise à jour de la solution
+  PROFILE_SCOPE(Update);
+
   // Récupération des trucs importants
   double dt(_timeStep);
   double dx(_mesh->getSpaceStep());
 
-  Eigen::Matrix<double, Eigen::Dynamic, 2> k1, k2;
+  // Toutes les matrices ont le même rangement (StateMatrix) : les mises à
+  // jour sont faites sur les tableaux à plat, par blocs qui tiennent dans
+  // le cache L1. Chaque étage ne fait ainsi qu'un passage sur la mémoire,
+  // sans allocation, et reste vectorisé par Eigen dans chaque bloc.
+  typedef Eigen::Map<Eigen::ArrayXd> FlatArray;
+  typedef Eigen::Map<const Eigen::ArrayXd> ConstFlatArray;
+  const int blockSize(512);
+  int size(_Sol.size());
+
+  // Calcul de k1 et de la solution intermédiaire
+  buildSolFluxAndSource();
+  for (int begin(0) ; begin < size ; begin += blockSize)
+    {
+      int n(std::min(blockSize, size - begin));
+      ConstFlatArray fluxVector(_state.fluxVector.data() + begin, n), source(_state.source.data() + begin, n);
+      ConstFlatArray Sol(_Sol.data() + begin, n);
+      FlatArray k1(_k1.data() + begin, n), stageSol(_stageSol.data() + begin, n);
+      k1 = fluxVector / dx + source;
+      stageSol = Sol + dt * k1;
+    }
 
-  // Calcul de k1
-  _finVol->buildFluxVector(_currentTime, _Sol);
-  _physics->buildSourceTerm(_Sol);
-  const Eigen::Matrix<double, Eigen::Dynamic, 2>& fluxVector1(_finVol->getFluxVector());
-  const Eigen::Matrix<double, Eigen::Dynamic, 2>& source1(_physics->getSourceTerm());
-  k1 = fluxVector1 / dx + source1;
-  
-  // Calcul de k2
-  _physics->buildSourceTerm(_Sol + dt * k1);
-  _finVol->buildFluxVector(_currentTime + dt, _Sol + dt * k1);
-  const Eigen::Matrix<double, Eigen::Dynamic, 2>& source2(_physics->getSourceTerm());
-  const Eigen::Matrix<double, Eigen::Dynamic, 2>& fluxVector2(_finVol->getFluxVector());
-  k2 = fluxVector2 / dx + source2;
-  
-  // Mise a jour de la solution
-  _Sol += 0.5 * dt * (k1 + k2);
+  // Calcul de k2 et mise a jour de la solution
+  _physics->buildSourceTerm(_stageSol, _state);
+  _finVol->buildFluxVector(_currentTime + dt, _stageSol, _state);
+  for (int begin(0) ; begin < size ; begin += blockSize)
+    {
+      int n(std::min(blockSize, size - begin));
+      ConstFlatArray fluxVector(_state.fluxVector.data() + begin, n), source(_state.source.data() + begin, n);
+      ConstFlatArray k1(_k1.data() + begin, n);
+      FlatArray Sol(_Sol.data() + begin, n);
+      Sol += 0.5 * dt * (k1 + (fluxVector / dx + source));
+    }
+}
+
+
+//-----------------------------------------------------//
+//------------------SSP Runge Kutta 3------------------//
+//-----------------------------------------------------//
+SSPRK3::SSPRK3():
+  TimeScheme()
+{
+}
+
+
+
+SSPRK3::SSPRK3(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol):
+  TimeScheme(DF, mesh, physics, finVol), _stageSol(_Sol.rows(), 2)
+{
+}
+
+
+
+void SSPRK3::Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol)
+{
+  _DF = DF;
+  _mesh = mesh;
+  _physics = physics;
+  _finVol = finVol;
+  _plan = DF->getRunPlan();
+  _Sol.resize(mesh->getNumberOfCells(), 2);
+  _state = SolverState(mesh->getNumberOfCells(), DF->getTimeStep());
+  _state.forcing = physics->getBoundaryForcing();
+  _timeStep = DF->getTimeStep();
+  _initialTime = DF->getInitialTime();
+  _finalTime = DF->getFinalTime();
+  _currentTime = _initialTime; 
+  _stageSol.resize(mesh->getNumberOfCells(), 2);
+}
+
+
+
+void SSPRK3::oneStep()
+{
+  // Hors flux et terme source (mesurés à part), tout est mise à jour de la solution
+  PROFILE_SCOPE(Update);
+
+  double dt(_timeStep);
+
+  // U1 = Sol + dt * L(Sol), aux instants t, t + dt puis t + dt/2
+  sspStage(_currentTime, _Sol, 0., 1., _stageSol);
+  // U2 = 3/4 Sol + 1/4 (U1 + dt * L(U1))
+  sspStage(_currentTime + dt, _stageSol, 0.75, 0.25, _stageSol);
+  // Sol = 1/3 Sol + 2/3 (U2 + dt * L(U2))
+  sspStage(_currentTime + 0.5 * dt, _stageSol, 1./3., 2./3., _Sol);
+}
+
+
+//---------------------------------------------------------//
+//------------------SSP Runge Kutta (s,2)------------------//
+//---------------------------------------------------------//
+SSPRKs2::SSPRKs2():
+  TimeScheme()
+{
+}
+
+
+
+SSPRKs2::SSPRKs2(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol):
+  TimeScheme(DF, mesh, physics, finVol), _stageSol(_Sol.rows(), 2)
+{
+}
+
+
+
+void SSPRKs2::Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol)
+{
+  _DF = DF;
+  _mesh = mesh;
+  _physics = physics;
+  _finVol = finVol;
+  _plan = DF->getRunPlan();
+  _Sol.resize(mesh->getNumberOfCells(), 2);
+  _state = SolverState(mesh->getNumberOfCells(), DF->getTimeStep());
+  _state.forcing = physics->getBoundaryForcing();
+  _timeStep = DF->getTimeStep();
+  _initialTime = DF->getInitialTime();
+  _finalTime = DF->getFinalTime();
+  _currentTime = _initialTime; 
+  _stageSol.resize(mesh->getNumberOfCells(), 2);
+}
+
+
+
+void SSPRKs2::oneStep()
+{
+  // Hors flux et terme source (mesurés à part), tout est mise à jour de la solution
+  PROFILE_SCOPE(Update);
+
+  double dt(_timeStep);
+  int s(_plan.rungeKuttaStages);
+  double subStep(dt / (s - 1));
+
+  // Chaque étage est un pas d'Euler explicite de dt/(s-1) : le flux de
+  // Lax-Friedrichs et les conditions aux limites utilisent ce sous-pas
+  _state.timeStep = subStep;
+  sspStage(_currentTime, _Sol, 0., 1., _stageSol);
+  for (int i(1) ; i < s - 1 ; ++i)
+    {
+      sspStage(_currentTime + i * subStep, _stageSol, 0., 1., _stageSol);
+    }
+  // Sol = 1/s Sol + (s-1)/s (U + dt/(s-1) * L(U))
+  sspStage(_currentTime + (s - 1) * subStep, _stageSol, 1. / s, (s - 1.) / s, _Sol);
+  _state.timeStep = dt;
 }
@@ -7,7 +7,14 @@
 #include "Mesh.h"
 #include "Physics.h"
 #include "FiniteVolume.h"
-
+#include "Layout.h"
+#include "ProbeRecorder.h"
+#include "SnapshotWriter.h"
+#include "SolutionFile.h"
+#include "SolverState.h"
+
+#include <fstream>
+#include <ostream>
 #include <vector>
 
 
@@ -15,14 +22,25 @@
 class TimeScheme
 {
 protected:
-  // Pointeur vers les trucs importants
-  DataFile* _DF;
-  Mesh* _mesh;
-  Physics* _physics;
-  FiniteVolume* _finVol;
+  // Pointeur vers les trucs importants (le problème, en lecture seule)
+  const DataFile* _DF;
+  const Mesh* _mesh;
+  const Physics* _physics;
+  const FiniteVolume* _finVol;
+
+  // Options résolues du fichier de paramètres
+  RunPlan _plan;
 
   // Vecteur solution
-  Eigen::Matrix<double, Eigen::Dynamic, 2> _Sol;
+  StateMatrix _Sol;
+
+  // État du calcul : terme source, flux, forçage aux limites... (voir
+  // SolverState.h)
+  SolverState _state;
+  // Pas de temps adaptatif : le terme source et le flux de _Sol sont déjà
+  // dans _state (construits par solve() pour choisir le pas de temps), le
+  // premier étage les reprend au lieu de les reconstruire
+  bool _isSolFluxBuilt;
 
   // Paramètres de temps
   double _timeStep;
@@ -30,24 +48,52 @@ protected:
   double _finalTime;
   double _currentTime;
 
+  // Pas de temps adaptatif : chaque pas est écrit au fur et à mesure dans
+  // time_steps.txt, seuls le nombre de pas, le min, le max et la somme
+  // sont gardés pour le résumé
+  std::ofstream _timeStepFile;
+  int _nAdaptiveSteps;
+  double _dtMin, _dtMax, _dtSum;
+
   // Probes
   int _nProbes;
   std::vector<int> _probesRef;
   std::vector<double> _probesPos;
   std::vector<int> _probesIndices;
+  ProbeRecorder _probeRecorder;
+
+  // Écriture des sauvegardes en parallèle de la boucle en temps
+  SnapshotWriter _snapshotWriter;
+  // Fichier binaire des sauvegardes (OutputFormat = Binary)
+  SolutionFileWriter _solutionFile;
+
+  // Empreinte du fichier de paramètres (points de reprise)
+  unsigned long long _parametersHash;
+
+  // Messages de la boucle en temps (std::cout par défaut)
+  std::ostream* _log;
+
+  // Topographie dans les cellules des sondes
+  std::vector<double> getProbesTopography() const;
+
+  // Étage d'Euler explicite des schémas SSP, de pas _state.timeStep à
+  // partir de l'instant t : out = a * Sol + b * (U + dt * L(U))
+  void sspStage(double t, const StateMatrix& U, double a, double b, StateMatrix& out);
+  // Flux puis terme source de _Sol pour le premier étage d'Euler et de RK2
+  void buildSolFluxAndSource();
   
 public:
   // Constructeurs
   TimeScheme();
-  TimeScheme(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol);
+  TimeScheme(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
 
   // Initialiseur
-  void Initialize(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol);
+  void Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
   // Destructeur
   virtual ~TimeScheme() = default;
 
   // Getters
-  const Eigen::Matrix<double, Eigen::Dynamic, 2>& getSolution() const {return _Sol;};
+  const StateMatrix& getSolution() const {return _Sol;};
   double getTimeStep() const {return _timeStep;};
   double getInitialTime() const {return _initialTime;};
   double getFinalTime() const {return _finalTime;};
@@ -56,12 +102,28 @@ public:
   // Adjust the probes prositions to fit within the mesh
   void buildProbesCellIndices();
   
+  // Change the time step everywhere it is used (adaptive time stepping)
+  void setTimeStep(double timeStep);
+
+  // Redirect the messages of the time loop (errors and warnings excepted)
+  void setLogStream(std::ostream& log) {_log = &log;};
+  
   // Solve and save solution
   virtual void oneStep() = 0;
-  void saveCurrentSolution(std::string& fileName) const;
-  void saveProbes() const;
+  void saveCurrentSolution(std::string& fileName);
+  void writeSolution(const Snapshot& snapshot);
+  void saveProbes();
+  // Pas de temps adaptatif : time_steps.txt (taille en octets à la reprise,
+  // 0 pour un nouveau fichier), un pas de temps, résumé de fin de calcul
+  void openTimeStepHistory(long long size);
+  void recordTimeStep();
+  void closeTimeStepHistory();
   void solve();
 
+  // Checkpoint/restart of the time loop
+  void writeCheckpoint(int n, int nSaves, int nProbesSaves);
+  void readCheckpoint(const std::string& fileName, int& n, int& nSaves, int& nProbesSaves);
+
   // Error
   Eigen::Vector2d computeL2Error() const;
   Eigen::Vector2d computeL1Error() const;
@@ -74,10 +136,10 @@ class ExplicitEuler: public TimeScheme
 public:
   // Constructeurs
   ExplicitEuler();
-  ExplicitEuler(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol);
+  ExplicitEuler(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
 
   // Initialiseur
-  void Initialize(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol);
+  void Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
 
   // One time step
   void oneStep();
@@ -87,13 +149,65 @@ public:
 
 class RK2: public TimeScheme
 {
+private:
+  // Registres de l'étage intermédiaire, alloués une fois : k1 et la
+  // solution intermédiaire Sol + dt * k1
+  StateMatrix _k1, _stageSol;
+
 public:
   // Constructeurs
   RK2();
-  RK2(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol);
+  RK2(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
+
+  // Initialiseur
+  void Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
+
+  // One time step
+  void oneStep();
+};
+
+
+
+// SSP-RK3 de Shu et Osher, sous forme de combinaisons convexes d'étages
+// d'Euler explicite (même CFL qu'Euler explicite, ordre 3). Seuls deux
+// registres sont utilisés : la solution et la solution intermédiaire.
+class SSPRK3: public TimeScheme
+{
+private:
+  // Solution intermédiaire, allouée une fois
+  StateMatrix _stageSol;
+
+public:
+  // Constructeurs
+  SSPRK3();
+  SSPRK3(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
+
+  // Initialiseur
+  void Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
+
+  // One time step
+  void oneStep();
+};
+
+
+
+// SSP-RK(s,2) à s étages (RungeKuttaStages), ordre 2 : s - 1 étages d'Euler
+// explicite de pas dt/(s-1) puis une moyenne avec la solution. La CFL
+// admissible est s - 1 fois celle d'Euler explicite, pour s évaluations du
+// flux par pas de temps, et seuls deux registres sont utilisés.
+class SSPRKs2: public TimeScheme
+{
+private:
+  // Solution intermédiaire, allouée une fois
+  StateMatrix _stageSol;
+
+public:
+  // Constructeurs
+  SSPRKs2();
+  SSPRKs2(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
 
   // Initialiseur
-  void Initialize(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol);
+  void Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
 
   // One time step
   void oneStep();
@@ -0,0 +1,93 @@
+#include "TimeSeries.h"
+#include "termcolor.h"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+
+
+TimeSeries::TimeSeries():
+  _interpolation(InterpolationType::Linear), _bucketWidth(1.)
+{
+}
+
+
+
+void TimeSeries::Initialize(const Eigen::VectorXd& times, const Eigen::VectorXd& values, InterpolationType interpolation)
+{
+  int nData(times.size());
+  _interpolation = interpolation;
+  if (nData < 2)
+    {
+      std::cout << termcolor::red << "ERROR::TIMESERIES : At least two values are needed, " << nData << " given." << std::endl;
+      std::cout << termcolor::reset;
+      exit(-1);
+    }
+
+  for (int k(0) ; k < nData - 1 ; ++k)
+    {
+      if (!(times(k+1) > times(k)))
+        {
+          std::cout << termcolor::red << "ERROR::TIMESERIES : The times must be strictly increasing." << std::endl;
+          std::cout << termcolor::reset;
+          exit(-1);
+        }
+    }
+  _times = times;
+  _values = values;
+
+  // Premier intervalle de chaque paquet
+  int nBuckets(nData - 1);
+  _bucketWidth = (times(nData - 1) - times(0)) / nBuckets;
+  _bucketStart.resize(nBuckets + 1);
+  int k(0);
+  for (int b(0) ; b <= nBuckets ; ++b)
+    {
+      double t(times(0) + b * _bucketWidth);
+      while (k < nData - 2 && times(k+1) <= t)
+        ++k;
+      _bucketStart[b] = k;
+    }
+
+  // Pentes de l'interpolation cubique (différences centrées sur les mesures
+  // voisines, décentrées aux bords)
+  _slopes.resize(0);
+  if (_interpolation == InterpolationType::Cubic)
+    {
+      _slopes.resize(nData);
+      _slopes(0) = (values(1) - values(0)) / (times(1) - times(0));
+      for (int i(1) ; i < nData - 1 ; ++i)
+        _slopes(i) = (values(i+1) - values(i-1)) / (times(i+1) - times(i-1));
+      _slopes(nData - 1) = (values(nData - 1) - values(nData - 2)) / (times(nData - 1) - times(nData - 2));
+    }
+}
+
+
+
+double TimeSeries::value(double t) const
+{
+  int n(_values.size());
+  if (!(t > _times(0)))
+    return _values(0);
+  if (t >= _times(n - 1))
+    return _values(n - 1);
+
+  // Paquet de t, puis recherche parmi les mesures du paquet
+  int nBuckets(_bucketStart.size() - 1);
+  int b(std::min(static_cast<int>((t - _times(0)) / _bucketWidth), nBuckets - 1));
+  const double* first(_times.data() + _bucketStart[b]);
+  const double* last(_times.data() + _bucketStart[b+1] + 1);
+  int i(std::upper_bound(first, last, t) - _times.data() - 1);
+  i = std::max(0, std::min(i, n - 2));
+
+  double h(_times(i+1) - _times(i));
+  double f((t - _times(i)) / h);
+  double v0(_values(i)), v1(_values(i+1));
+  if (_interpolation == InterpolationType::Linear)
+    return v0 + f * (v1 - v0);
+
+  // Polynôme d'Hermite cubique sur [_times(i), _times(i+1)]
+  double f2(f * f), f3(f2 * f);
+  return (2.*f3 - 3.*f2 + 1.) * v0 + (f3 - 2.*f2 + f) * h * _slopes(i) + (3.*f2 - 2.*f3) * v1 + (f3 - f2) * h * _slopes(i+1);
+}
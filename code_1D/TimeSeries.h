@@ -0,0 +1,54 @@
+#ifndef TIME_SERIES_H
+#define TIME_SERIES_H
+
+#include "DataFile.h"
+#include "Eigen/Eigen/Dense"
+
+#include <vector>
+
+
+
+// Série temporelle d'un capteur (condition aux limites DataFile).
+//
+// Les mesures d'origine sont gardées telles quelles et interpolées
+// (linéaire ou Hermite cubique) entre deux mesures consécutives. Pour
+// trouver l'intervalle de t, la durée est découpée en paquets de même
+// largeur (autant que d'intervalles entre mesures) : l'indice du paquet
+// s'obtient directement à partir de t, puis une recherche dichotomique se
+// limite aux quelques mesures du paquet. Les instants peuvent donc arriver
+// dans n'importe quel ordre (étages des schémas de Runge-Kutta, pas de temps
+// adaptatif, plusieurs membres d'un ensemble qui partagent la même série).
+//
+// Avant la première mesure et après la dernière, la valeur la plus proche
+// est gardée.
+class TimeSeries
+{
+private:
+  // Mesures (instants strictement croissants)
+  Eigen::VectorXd _times, _values;
+  // Pentes (par unité de temps) aux instants des mesures, interpolation cubique
+  Eigen::VectorXd _slopes;
+  InterpolationType _interpolation;
+  // Paquets : le paquet b couvre [_times(0) + b * _bucketWidth, ...[ et
+  // commence dans l'intervalle [_times(k), _times(k+1)] avec k = _bucketStart[b]
+  double _bucketWidth;
+  std::vector<int> _bucketStart;
+
+public:
+  // Constructeur
+  TimeSeries();
+
+  // Mesures (times, values), times strictement croissants
+  void Initialize(const Eigen::VectorXd& times, const Eigen::VectorXd& values, InterpolationType interpolation);
+
+  // Getters
+  bool isEmpty() const {return _values.size() == 0;};
+  int getNumberOfSamples() const {return _values.size();};
+  double getInitialTime() const {return _times(0);};
+  double getFinalTime() const {return _times(_times.size() - 1);};
+
+  // Valeur à l'instant t
+  double value(double t) const;
+};
+
+#endif // TIME_SERIES_H
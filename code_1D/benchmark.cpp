@@ -0,0 +1,444 @@
+#include "termcolor.h"
+#include "DataFile.h"
+#include "Mesh.h"
+#include "Physics.h"
+#include "FiniteVolume.h"
+#include "FluxKernels.h"
+#include "TimeScheme.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Banc d'essai des performances du code 1D (make bench).
+//
+// Micro-benchmarks, en ns par interface, par cellule ou par appel :
+//   - numFlux de chaque flux, un appel par interface, et les noyaux
+//     groupés (interfaceFluxes) utilisés par buildFluxVector, sur des états
+//     mouillés, secs et transcritiques tirés au hasard,
+//   - minmod, buildFluxVector à l'ordre 1 et 2 (reconstruction MUSCL),
+//   - buildSourceTerm avec la bosse.
+// Calculs complets, en cellules.pas/s : rupture de barrage à pas de temps
+// fixe de 10^3 à 10^7 cellules, sans aucune sauvegarde, avec Euler
+// explicite (damBreak), RK2 (damBreakRK2) et SSP-RK3 (damBreakSSPRK3).
+//
+// Les résultats sont comparés au fichier de référence donné en argument,
+// --save le remplace par les résultats du jour. Les valeurs de référence
+// dépendent de la machine : il faut le régénérer en changeant de machine.
+//
+// Usage : ./benchmark [fichier_de_référence] [--save] [--max-cells N]
+
+// Dossier de travail du banc d'essai (fichiers de paramètres)
+static const std::string benchDir("bench_results");
+
+// Écart toléré avec la référence avant de signaler un changement
+static const double tolerance(0.10);
+
+
+
+struct BenchResult
+{
+  std::string name;
+  double value;
+  std::string unit;
+};
+
+
+
+// Temps moyen (s) d'un appel de f : meilleure de nRepeats mesures durant
+// chacune au moins minTime secondes
+template<class F>
+double bestTime(F f, double minTime = 0.05, int nRepeats = 5)
+{
+  typedef std::chrono::steady_clock Clock;
+  double best(1e300);
+  f();
+  for (int r(0) ; r < nRepeats ; ++r)
+    {
+      long calls(0);
+      double elapsed(0.);
+      Clock::time_point start(Clock::now());
+      do
+        {
+          f();
+          ++calls;
+          elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        }
+      while (elapsed < minTime);
+      best = std::min(best, elapsed / calls);
+    }
+  return best;
+}
+
+
+
+// Empêche le compilateur de supprimer les calculs mesurés
+static volatile double sink(0.);
+
+
+
+// Un calcul complet : fichier de paramètres, maillage, physique, flux et schéma en temps
+struct Problem
+{
+  std::unique_ptr<DataFile> DF;
+  std::unique_ptr<Mesh> mesh;
+  std::unique_ptr<Physics> physics;
+  std::unique_ptr<FiniteVolume> finVol;
+  std::unique_ptr<TimeScheme> TS;
+};
+
+
+
+// Construit un calcul sur [xmin, xmax] avec nCells cellules. Les options
+// sont écrites dans un fichier de paramètres, lu comme par main.
+static void buildProblem(Problem& pb, const std::string& name, int nCells, double xmin, double xmax,
+                         const std::string& flux, int order, const std::string& initialCondition,
+                         const std::string& topography, const std::string& timeScheme = "ExplicitEuler")
+{
+  double dx((xmax - xmin) / nCells);
+  std::string fileName(benchDir + "/" + name + ".txt");
+  std::ofstream file(fileName);
+  file << std::setprecision(17);
+  file << "TimeScheme\n" << timeScheme << "\nNumericalFlux\n" << flux << "\nOrder\n" << order << "\n";
+  file << "xmin\n" << xmin << "\nxmax\n" << xmax << "\ndx\n" << dx << "\n";
+  // Pas de temps fixe, CFL 0.1 pour des vitesses d'onde jusqu'à 5 m/s
+  file << "InitialTime\n0.\nFinalTime\n1.\nTimeStep\n" << 0.1 * dx / 5. << "\nCFL\n0.9\nAdaptiveStepping\n0\n";
+  file << "GravityAcceleration\n9.81\n";
+  file << "ResultsDir\n" << benchDir << "\nSaveFinalResultOnly\n1\nSaveFrequency\n1\nProbes\n0\n";
+  file << "IsTestCase\n0\nWhichTestCase\nDamBreakWet\n";
+  file << "InitialCondition\n" << initialCondition << "\nInitialHeight\n2.\nInitialDischarge\n1.\nInitFile\nnone\n";
+  file << "LeftBoundaryCondition\nNeumann\nRightBoundaryCondition\nNeumann\n";
+  file << "LeftBoundaryImposedHeight\n1.\nLeftBoundaryImposedDischarge\n1.\n";
+  file << "RightBoundaryImposedHeight\n1.\nRightBoundaryImposedDischarge\n1.\n";
+  file << "IsTopography\n" << (topography == "FlatBottom" ? 0 : 1) << "\nTopographyType\n" << topography << "\n";
+  file.close();
+
+  pb.DF.reset(new DataFile(fileName));
+  pb.DF->readDataFile();
+  pb.mesh.reset(new Mesh(pb.DF.get()));
+  pb.mesh->Initialize();
+  pb.physics.reset(new Physics(pb.DF.get(), pb.mesh.get()));
+  pb.physics->Initialize();
+  if (flux == "LaxFriedrichs")
+    pb.finVol.reset(new LaxFriedrichs(pb.DF.get(), pb.mesh.get(), pb.physics.get()));
+  else if (flux == "Rusanov")
+    pb.finVol.reset(new Rusanov(pb.DF.get(), pb.mesh.get(), pb.physics.get()));
+  else
+    pb.finVol.reset(new HLL(pb.DF.get(), pb.mesh.get(), pb.physics.get()));
+  switch (pb.DF->getRunPlan().timeScheme)
+    {
+    case TimeSchemeType::ExplicitEuler:
+      pb.TS.reset(new ExplicitEuler(pb.DF.get(), pb.mesh.get(), pb.physics.get(), pb.finVol.get()));
+      break;
+    case TimeSchemeType::RK2:
+      pb.TS.reset(new RK2(pb.DF.get(), pb.mesh.get(), pb.physics.get(), pb.finVol.get()));
+      break;
+    case TimeSchemeType::SSPRK3:
+      pb.TS.reset(new SSPRK3(pb.DF.get(), pb.mesh.get(), pb.physics.get(), pb.finVol.get()));
+      break;
+    case TimeSchemeType::SSPRKs2:
+      pb.TS.reset(new SSPRKs2(pb.DF.get(), pb.mesh.get(), pb.physics.get(), pb.finVol.get()));
+      break;
+    }
+}
+
+
+
+// États à gauche et à droite de n interfaces, tirés au hasard :
+//   wet            = h dans [0.5, 2], écoulement fluvial (Fr < 0.8)
+//   dry            = un côté sec une fois sur deux, les deux une fois sur dix
+//   transcritical  = h dans [0.5, 2], Fr dans [0.8, 1.2], dans les deux sens
+static void randomStates(const std::string& distribution, int n, double g,
+                         Eigen::Matrix<double, Eigen::Dynamic, 2>& SolG, Eigen::Matrix<double, Eigen::Dynamic, 2>& SolD)
+{
+  std::mt19937 generator(12345);
+  std::uniform_real_distribution<double> uniform(0., 1.);
+  SolG.resize(n, 2);
+  SolD.resize(n, 2);
+  for (int i(0) ; i < n ; ++i)
+    {
+      for (int side(0) ; side < 2 ; ++side)
+        {
+          double h(0.5 + 1.5 * uniform(generator)), Fr(0.);
+          if (distribution == "transcritical")
+            Fr = 0.8 + 0.4 * uniform(generator);
+          else
+            Fr = 0.8 * uniform(generator);
+          double sign(uniform(generator) < 0.5 ? -1. : 1.);
+          double q(sign * Fr * h * sqrt(g * h));
+          Eigen::Matrix<double, Eigen::Dynamic, 2>& Sol(side == 0 ? SolG : SolD);
+          Sol(i,0) = h;
+          Sol(i,1) = q;
+        }
+      if (distribution == "dry")
+        {
+          double r(uniform(generator));
+          if (r < 0.1)
+            {
+              SolG.row(i).setZero();
+              SolD.row(i).setZero();
+            }
+          else if (r < 0.3)
+            SolG.row(i).setZero();
+          else if (r < 0.5)
+            SolD.row(i).setZero();
+        }
+    }
+}
+
+
+
+// Donne accès au limiteur de pente (protégé)
+class MinmodBench: public HLL
+{
+public:
+  MinmodBench(const DataFile* DF, const Mesh* mesh, const Physics* physics): HLL(DF, mesh, physics) {};
+  using FiniteVolume::minmod;
+};
+
+
+
+// Micro-benchmarks des flux numériques
+static void benchFluxes(std::vector<BenchResult>& results)
+{
+  const int n(4096);
+  const char* fluxes[] = {"LaxFriedrichs", "Rusanov", "HLL"};
+  const char* distributions[] = {"wet", "dry", "transcritical"};
+  for (const char* flux : fluxes)
+    {
+      Problem pb;
+      buildProblem(pb, "bench_flux", n, 0., 1., flux, 1, "DamBreakWet", "FlatBottom");
+      for (const char* distribution : distributions)
+        {
+          Eigen::Matrix<double, Eigen::Dynamic, 2> SolG, SolD, F(n, 2);
+          randomStates(distribution, n, pb.DF->getGravityAcceleration(), SolG, SolD);
+          const FiniteVolume& finVol(*pb.finVol);
+          double dt(pb.DF->getTimeStep());
+
+          double t(bestTime([&]()
+                            {
+                              double sum(0.), waveSpeed(0.);
+                              for (int i(0) ; i < n ; ++i)
+                                {
+                                  Eigen::Vector2d flux(finVol.numFlux(SolG.row(i), SolD.row(i), dt, &waveSpeed));
+                                  sum += flux(0) + waveSpeed;
+                                }
+                              sink = sum;
+                            }));
+          results.push_back({std::string("numFlux/") + flux + "/" + distribution, 1e9 * t / n, "ns/interface"});
+
+          t = bestTime([&]() {sink = finVol.interfaceFluxes(SolG, SolD, dt, F);});
+          results.push_back({std::string("interfaceFluxes/") + flux + "/" + distribution, 1e9 * t / n, "ns/interface"});
+        }
+    }
+}
+
+
+
+// Micro-benchmarks de la reconstruction et du terme source
+static void benchReconstruction(std::vector<BenchResult>& results)
+{
+  const int n(4096);
+  {
+    Problem pb;
+    buildProblem(pb, "bench_minmod", n, 0., 1., "HLL", 2, "DamBreakWet", "FlatBottom");
+    MinmodBench limiter(pb.DF.get(), pb.mesh.get(), pb.physics.get());
+    std::mt19937 generator(12345);
+    std::uniform_real_distribution<double> uniform(-1., 1.);
+    std::vector<double> a(n + 1);
+    for (double& x : a)
+      x = uniform(generator);
+    double t(bestTime([&]()
+                      {
+                        double sum(0.);
+                        for (int i(0) ; i < n ; ++i)
+                          sum += limiter.minmod(a[i], a[i+1]);
+                        sink = sum;
+                      }));
+    results.push_back({"minmod", 1e9 * t / n, "ns/call"});
+  }
+
+  for (int order(1) ; order <= 2 ; ++order)
+    {
+      Problem pb;
+      buildProblem(pb, "bench_reconstruction", n, 0., 1., "HLL", order, "DamBreakWet", "FlatBottom");
+      const StateMatrix& Sol(pb.physics->getInitialCondition());
+      SolverState state(n, pb.DF->getTimeStep());
+      state.forcing = pb.physics->getBoundaryForcing();
+      double t(bestTime([&]() {pb.finVol->buildFluxVector(0., Sol, state);}));
+      results.push_back({"buildFluxVector/order" + std::to_string(order), 1e9 * t / (n + 1), "ns/interface"});
+    }
+
+  {
+    Problem pb;
+    buildProblem(pb, "bench_source", n, 0., 20., "HLL", 1, "UniformHeightAndDischarge", "Bump");
+    const StateMatrix& Sol(pb.physics->getInitialCondition());
+    SolverState state(pb.mesh->getNumberOfCells(), pb.DF->getTimeStep());
+    double t(bestTime([&]() {pb.physics->buildSourceTerm(Sol, state);}));
+    results.push_back({"buildSourceTerm/Bump", 1e9 * t / pb.mesh->getNumberOfCells(), "ns/cell"});
+  }
+}
+
+
+
+// Calculs complets : rupture de barrage, HLL à l'ordre 1, Euler explicite,
+// RK2 puis SSP-RK3
+static void benchRuns(std::vector<BenchResult>& results, long maxCells)
+{
+  typedef std::chrono::steady_clock Clock;
+  const char* timeSchemes[] = {"ExplicitEuler", "RK2", "SSPRK3"};
+  for (const char* timeScheme : timeSchemes)
+    for (long nCells(1000) ; nCells <= maxCells ; nCells *= 10)
+      {
+        Problem pb;
+        buildProblem(pb, "bench_run", nCells, 0., 1., "HLL", 1, "DamBreakWet", "FlatBottom", timeScheme);
+        // Environ 2.10^7 cellules.pas par taille, 5 pas au moins
+        int nSteps(std::max(5L, 20000000L / nCells));
+        pb.TS->oneStep();
+        Clock::time_point start(Clock::now());
+        for (int n(0) ; n < nSteps ; ++n)
+          pb.TS->oneStep();
+        double elapsed(std::chrono::duration<double>(Clock::now() - start).count());
+        sink = pb.TS->getSolution()(0,0);
+        std::ostringstream name;
+        name << "damBreak" << (std::string(timeScheme) == "ExplicitEuler" ? "" : timeScheme) << "/1e" << static_cast<int>(std::round(std::log10(nCells)));
+        results.push_back({name.str(), nCells * static_cast<double>(nSteps) / elapsed, "cells.steps/s"});
+      }
+}
+
+
+
+// Lit le fichier de référence : une ligne "nom valeur unité" par résultat
+static std::map<std::string, double> readBaseline(const std::string& fileName)
+{
+  std::map<std::string, double> baseline;
+  std::ifstream file(fileName);
+  std::string line;
+  while (std::getline(file, line))
+    {
+      if (line.empty() || line[0] == '#')
+        continue;
+      std::istringstream stream(line);
+      std::string name;
+      double value;
+      if (stream >> name >> value)
+        baseline[name] = value;
+    }
+  return baseline;
+}
+
+
+
+static void writeBaseline(const std::string& fileName, const std::vector<BenchResult>& results)
+{
+  std::ofstream file(fileName);
+  file << "# Résultats de référence de make bench (nom valeur unité)." << std::endl;
+  file << "# Ils dépendent de la machine : make bench-baseline pour les régénérer." << std::endl;
+  file << "# Flux kernels : " << fluxKernelsInstructionSet() << std::endl;
+  for (const BenchResult& result : results)
+    file << result.name << " " << std::setprecision(4) << result.value << " " << result.unit << std::endl;
+}
+
+
+
+int main(int argc, char** argv)
+{
+  std::string baselineFile;
+  bool save(false);
+  long maxCells(10000000);
+  for (int i(1) ; i < argc ; ++i)
+    {
+      std::string arg(argv[i]);
+      if (arg == "--save")
+        save = true;
+      else if (arg == "--max-cells" && i + 1 < argc)
+        maxCells = std::atol(argv[++i]);
+      else if (arg[0] != '-')
+        baselineFile = arg;
+      else
+        {
+          std::cout << termcolor::red << "Usage : " << argv[0] << " [baseline_file] [--save] [--max-cells N]" << std::endl;
+          std::cout << termcolor::reset;
+          exit(-1);
+        }
+    }
+  if (save && baselineFile.empty())
+    {
+      std::cout << termcolor::red << "ERROR::BENCH : --save needs a baseline file." << std::endl;
+      std::cout << termcolor::reset;
+      exit(-1);
+    }
+
+  system(("mkdir -p ./" + benchDir).c_str());
+  std::cout << "Flux kernels : " << fluxKernelsInstructionSet() << std::endl;
+
+  std::vector<BenchResult> results;
+  benchFluxes(results);
+  benchReconstruction(results);
+  benchRuns(results, maxCells);
+
+  // Comparaison avec la référence : pour les temps, plus petit est mieux,
+  // pour les débits (par seconde), plus grand est mieux
+  std::map<std::string, double> baseline;
+  if (!baselineFile.empty() && !save)
+    baseline = readBaseline(baselineFile);
+  int nSlower(0), nFaster(0);
+  std::cout << std::left << std::setw(46) << "Benchmark" << std::right << std::setw(14) << "Value"
+            << "  " << std::left << std::setw(15) << "Unit" << std::right << std::setw(14) << "Baseline"
+            << std::setw(10) << "Speedup" << std::endl;
+  for (const BenchResult& result : results)
+    {
+      std::cout << std::left << std::setw(46) << result.name << std::right << std::setw(14) << std::setprecision(4)
+                << result.value << "  " << std::left << std::setw(15) << result.unit << std::right;
+      std::map<std::string, double>::const_iterator it(baseline.find(result.name));
+      if (it == baseline.end())
+        {
+          std::cout << std::setw(14) << "-" << std::setw(10) << "-" << std::endl;
+          continue;
+        }
+      bool isRate(result.unit.find("/s") != std::string::npos);
+      double speedup(isRate ? result.value / it->second : it->second / result.value);
+      std::cout << std::setw(14) << it->second << std::setw(9) << std::fixed << std::setprecision(2) << speedup << "x";
+      std::cout << std::defaultfloat;
+      if (speedup < 1. - tolerance)
+        {
+          std::cout << termcolor::red << "  SLOWER" << termcolor::reset;
+          ++nSlower;
+        }
+      else if (speedup > 1. + tolerance)
+        {
+          std::cout << termcolor::green << "  FASTER" << termcolor::reset;
+          ++nFaster;
+        }
+      std::cout << std::endl;
+    }
+
+  if (save)
+    {
+      writeBaseline(baselineFile, results);
+      std::cout << termcolor::green << "SUCCESS::BENCH : Baseline saved in " << baselineFile << std::endl;
+      std::cout << termcolor::reset;
+    }
+  else if (!baseline.empty())
+    {
+      if (nSlower > 0)
+        std::cout << termcolor::red;
+      else
+        std::cout << termcolor::green;
+      std::cout << nSlower << " benchmark(s) slower and " << nFaster << " faster than the baseline by more than "
+                << 100. * tolerance << " %." << std::endl;
+      std::cout << termcolor::reset;
+    }
+
+  return EXIT_SUCCESS;
+}
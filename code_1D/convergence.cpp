@@ -0,0 +1,315 @@
+#include "termcolor.h"
+#include "DataFile.h"
+#include "Mesh.h"
+#include "Physics.h"
+#include "FiniteVolume.h"
+#include "TimeScheme.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if PROFILING>0
+#error "The profiler is global to the process and the runs are solved on several threads : build with PROFILING=0 (make convergence)."
+#endif
+
+// Étude de convergence du code 1D (make convergence).
+//
+// Le fichier de paramètres (un cas test) est lu une seule fois, puis un
+// calcul est lancé pour chaque combinaison des pas d'espace, flux et ordres
+// demandés. Les calculs tournent en parallèle sur un groupe de threads dans
+// ce seul processus, chacun avec sa copie du DataFile et son propre dossier
+// de résultats : ResultsDir/<flux>_order<k>_Nx<N>.
+// Les erreurs L1 et L2 et les ordres de convergence observés sont affichés
+// et écrits dans ResultsDir/errors_<flux>_order_<k>.txt, au format des
+// fichiers de convergence_tests.
+//
+// Usage : ./convergence_study parameters.txt --dx 0.25,0.125,0.0625 [--flux HLL,Rusanov] [--order 1,2] [--threads N]
+// Sans --flux ou --order, les valeurs du fichier de paramètres sont utilisées.
+
+
+
+// Un calcul de l'étude
+struct Run
+{
+  double dx;
+  std::string flux;
+  int order;
+
+  std::unique_ptr<DataFile> DF;
+  std::unique_ptr<Mesh> mesh;
+  std::unique_ptr<Physics> physics;
+  std::unique_ptr<FiniteVolume> finVol;
+  std::unique_ptr<TimeScheme> TS;
+
+  Eigen::Vector2d errorL1, errorL2;
+  double wallTime;
+};
+
+
+
+static void usage(const char* prog)
+{
+  std::cout << termcolor::red << "Usage : " << prog << " data_file --dx dx1,dx2,... [--flux flux1,flux2,...] [--order 1,2] [--threads N]" << std::endl;
+  std::cout << termcolor::reset;
+  exit(-1);
+}
+
+
+
+// Découpe une liste séparée par des virgules
+static std::vector<std::string> splitList(const std::string& list)
+{
+  std::vector<std::string> values;
+  std::stringstream stream(list);
+  std::string value;
+  while (std::getline(stream, value, ','))
+    if (!value.empty())
+      values.push_back(value);
+  return values;
+}
+
+
+
+// Construit le maillage, la physique, le flux et le schéma en temps d'un calcul
+static void buildRun(Run& run)
+{
+  DataFile* DF(run.DF.get());
+  run.mesh.reset(new Mesh(DF));
+  run.mesh->Initialize();
+  run.physics.reset(new Physics(DF, run.mesh.get()));
+  run.physics->Initialize();
+  switch (DF->getRunPlan().numericalFlux)
+    {
+    case NumericalFluxType::LaxFriedrichs:
+      run.finVol.reset(new LaxFriedrichs(DF, run.mesh.get(), run.physics.get()));
+      break;
+    case NumericalFluxType::Rusanov:
+      run.finVol.reset(new Rusanov(DF, run.mesh.get(), run.physics.get()));
+      break;
+    case NumericalFluxType::HLL:
+      run.finVol.reset(new HLL(DF, run.mesh.get(), run.physics.get()));
+      break;
+    }
+  switch (DF->getRunPlan().timeScheme)
+    {
+    case TimeSchemeType::ExplicitEuler:
+      run.TS.reset(new ExplicitEuler(DF, run.mesh.get(), run.physics.get(), run.finVol.get()));
+      break;
+    case TimeSchemeType::RK2:
+      run.TS.reset(new RK2(DF, run.mesh.get(), run.physics.get(), run.finVol.get()));
+      break;
+    case TimeSchemeType::SSPRK3:
+      run.TS.reset(new SSPRK3(DF, run.mesh.get(), run.physics.get(), run.finVol.get()));
+      break;
+    case TimeSchemeType::SSPRKs2:
+      run.TS.reset(new SSPRKs2(DF, run.mesh.get(), run.physics.get(), run.finVol.get()));
+      break;
+    }
+}
+
+
+
+// Ordre de convergence observé entre deux pas d'espace
+static double rate(double errorCoarse, double errorFine, double dxCoarse, double dxFine)
+{
+  return log(errorCoarse / errorFine) / log(dxCoarse / dxFine);
+}
+
+
+
+int main(int argc, char** argv)
+{
+  //-------------------------------------------------------//
+  //---------------------Arguments-------------------------//
+  //-------------------------------------------------------//
+  if (argc < 2)
+    usage(argv[0]);
+  std::vector<std::string> dxList, fluxList, orderList;
+  int nThreads(std::max(1u, std::thread::hardware_concurrency()));
+  for (int i(2) ; i < argc ; ++i)
+    {
+      std::string arg(argv[i]);
+      if (i + 1 >= argc)
+        usage(argv[0]);
+      if (arg == "--dx")
+        dxList = splitList(argv[++i]);
+      else if (arg == "--flux")
+        fluxList = splitList(argv[++i]);
+      else if (arg == "--order")
+        orderList = splitList(argv[++i]);
+      else if (arg == "--threads")
+        nThreads = std::max(1, atoi(argv[++i]));
+      else
+        usage(argv[0]);
+    }
+  if (dxList.empty())
+    usage(argv[0]);
+
+
+  //-------------------------------------------------------//
+  //---------------------Fichier de paramètres-------------//
+  //-------------------------------------------------------//
+  DataFile baseDF(argv[1]);
+  baseDF.readDataFile();
+  if (baseDF.getRunPlan().testCase == TestCaseType::None)
+    {
+      std::cout << termcolor::red << "ERROR::CONVERGENCE : The data file must describe a test case with an exact solution (IsTestCase = 1)." << std::endl;
+      std::cout << termcolor::reset;
+      exit(-1);
+    }
+  if (fluxList.empty())
+    fluxList.push_back(baseDF.getNumericalFlux());
+  if (orderList.empty())
+    orderList.push_back(std::to_string(baseDF.getSchemeOrder()));
+  const std::string& resultsDir(baseDF.getResultsDirectory());
+
+  // Une copie du DataFile par calcul, du plus fin au plus grossier : les
+  // calculs les plus longs partent en premier
+  std::vector<double> dxValues;
+  for (const std::string& dx : dxList)
+    dxValues.push_back(atof(dx.c_str()));
+  std::sort(dxValues.begin(), dxValues.end());
+  std::vector<Run> runs;
+  for (double dx : dxValues)
+    for (const std::string& flux : fluxList)
+      for (const std::string& order : orderList)
+        {
+          if (dx <= 0.)
+            {
+              std::cout << termcolor::red << "ERROR::CONVERGENCE : dx must be positive." << std::endl;
+              std::cout << termcolor::reset;
+              exit(-1);
+            }
+          Run run;
+          run.dx = dx;
+          run.flux = flux;
+          run.order = atoi(order.c_str());
+          run.DF.reset(new DataFile(baseDF));
+          run.DF->setScheme(dx, flux, run.order);
+          run.DF->setResultsDirectory(resultsDir + "/" + flux + "_order" + order + "_Nx" + std::to_string(run.DF->getNx()));
+          system(("mkdir -p ./" + run.DF->getResultsDirectory()).c_str());
+          runs.push_back(std::move(run));
+        }
+  nThreads = std::min(nThreads, int(runs.size()));
+
+  std::cout << "Convergence study : " << runs.size() << " runs of " << baseDF.getTestCase() << " on " << nThreads << " threads" << std::endl;
+
+  // Les messages de construction ne sont affichés que pour le premier
+  // calcul (les erreurs éventuelles ne dépendent pas du schéma)
+  buildRun(runs[0]);
+  std::streambuf* coutBuffer(std::cout.rdbuf());
+  std::ostringstream silent;
+  std::cout.rdbuf(silent.rdbuf());
+  for (size_t r(1) ; r < runs.size() ; ++r)
+    buildRun(runs[r]);
+  std::cout.rdbuf(coutBuffer);
+
+
+  //----------------------------------------------------//
+  //---------------------Résolution---------------------//
+  //----------------------------------------------------//
+  std::atomic<int> nextRun(0);
+  std::mutex printMutex;
+  int nDone(0);
+  auto worker = [&]()
+    {
+      int r;
+      while ((r = nextRun++) < int(runs.size()))
+        {
+          Run& run(runs[r]);
+          std::ostringstream log;
+          run.TS->setLogStream(log);
+          std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+          run.TS->solve();
+          run.wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+          run.errorL1 = run.TS->computeL1Error();
+          run.errorL2 = run.TS->computeL2Error();
+          // Libère la mémoire du calcul, seules les erreurs sont gardées
+          run.TS.reset();
+          run.finVol.reset();
+          run.physics.reset();
+          run.mesh.reset();
+
+          std::lock_guard<std::mutex> lock(printMutex);
+          ++nDone;
+          std::cout << "[" << nDone << "/" << runs.size() << "] " << run.flux << " order " << run.order
+                    << " Nx = " << run.DF->getNx() << " done in " << run.wallTime << " s" << std::endl;
+        }
+    };
+  std::vector<std::thread> threads;
+  for (int t(0) ; t < nThreads ; ++t)
+    threads.push_back(std::thread(worker));
+  for (std::thread& thread : threads)
+    thread.join();
+
+
+  //-------------------------------------------------------//
+  //---------------------Tableau des erreurs---------------//
+  //-------------------------------------------------------//
+  for (const std::string& flux : fluxList)
+    for (const std::string& order : orderList)
+      {
+        // Calculs de ce schéma, du plus grossier au plus fin
+        std::vector<const Run*> scheme;
+        for (auto it = runs.rbegin() ; it != runs.rend() ; ++it)
+          if (it->flux == flux && it->order == atoi(order.c_str()))
+            scheme.push_back(&*it);
+
+        std::string fluxName(flux);
+        std::transform(fluxName.begin(), fluxName.end(), fluxName.begin(), ::tolower);
+        std::string fileName(resultsDir + "/errors_" + fluxName + "_order_" + order + ".txt");
+        std::ofstream file(fileName);
+        file << "# Nx      dx        h.errorL1      q.errorL1       h.errorL2      q.errorL2       h.rateL1  q.rateL1  h.rateL2  q.rateL2" << std::endl;
+
+        std::cout << std::endl << flux << " order " << order << std::endl;
+        std::cout << std::left << std::setw(10) << "Nx" << std::setw(12) << "dx"
+                  << std::setw(14) << "h.errorL1" << std::setw(9) << "rate"
+                  << std::setw(14) << "q.errorL1" << std::setw(9) << "rate"
+                  << std::setw(14) << "h.errorL2" << std::setw(9) << "rate"
+                  << std::setw(14) << "q.errorL2" << std::setw(9) << "rate" << std::endl;
+        for (size_t k(0) ; k < scheme.size() ; ++k)
+          {
+            const Run& run(*scheme[k]);
+            double errors[4] = {run.errorL1(0), run.errorL1(1), run.errorL2(0), run.errorL2(1)};
+            std::string rates[4] = {"-", "-", "-", "-"};
+            if (k > 0)
+              {
+                const Run& coarse(*scheme[k-1]);
+                double coarseErrors[4] = {coarse.errorL1(0), coarse.errorL1(1), coarse.errorL2(0), coarse.errorL2(1)};
+                for (int e(0) ; e < 4 ; ++e)
+                  {
+                    std::ostringstream value;
+                    value << std::fixed << std::setprecision(2) << rate(coarseErrors[e], errors[e], coarse.DF->getDx(), run.DF->getDx());
+                    rates[e] = value.str();
+                  }
+              }
+            std::cout << std::setw(10) << run.DF->getNx() << std::setw(12) << run.DF->getDx();
+            file << std::left << std::setw(10) << run.DF->getNx() << std::setw(10) << run.DF->getDx();
+            for (int e(0) ; e < 4 ; ++e)
+              {
+                std::cout << std::setw(14) << errors[e] << std::setw(9) << rates[e];
+                file << std::setw(15) << errors[e] << " ";
+              }
+            for (int e(0) ; e < 4 ; ++e)
+              file << std::setw(10) << rates[e];
+            std::cout << std::endl;
+            file << std::endl;
+          }
+        std::cout << "Written in " << fileName << std::endl;
+      }
+  std::cout << std::right;
+
+  return EXIT_SUCCESS;
+}
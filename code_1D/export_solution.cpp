@@ -0,0 +1,135 @@
+#include "termcolor.h"
+#include "SolutionFile.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+
+
+// Relit un fichier binaire de sauvegardes (OutputFormat = Binary) et exporte
+// les sauvegardes au format texte des fichiers solution_*.txt.
+//
+// Usage :
+//   ./export_solution results/solution_HLL.bin               liste les sauvegardes
+//   ./export_solution results/solution_HLL.bin k [file.txt]  exporte la sauvegarde k
+//   ./export_solution results/solution_HLL.bin all           exporte toutes les sauvegardes
+//   ./export_solution results/solution_HLL.bin parameters    affiche le fichier de paramètres
+// Par défaut, la sauvegarde k est écrite dans results/solution_HLL_n.txt,
+// où n est le numéro de la sauvegarde, comme avec OutputFormat = Text : il
+// se déduit de son instant, de InitialTime, TimeStep et SaveFrequency.
+// n diffère donc de k avec SaveFinalResultOnly ou après une reprise.
+
+
+
+// Valeur d'un paramètre du fichier de paramètres (ligne de la clé puis
+// ligne de la valeur), defaultValue si la clé n'y est pas
+static double parameterValue(const std::string& parameters, const std::string& key, double defaultValue)
+{
+  std::istringstream stream(parameters);
+  std::string line;
+  while (getline(stream, line))
+    {
+      line = line.substr(0, line.find('#'));
+      line.erase(0, line.find_first_not_of(" \t\r"));
+      line.erase(line.find_last_not_of(" \t\r") + 1);
+      double value;
+      if (line == key && stream >> value)
+        return value;
+    }
+  return defaultValue;
+}
+
+
+
+static void printUsage(const char* prog)
+{
+  std::cout << termcolor::red << "Usage : " << prog << " solution.bin [k|all|parameters] [file.txt]" << std::endl;
+  std::cout << "  k : record number, between 0 and the number of records - 1 (" << prog << " solution.bin lists them)" << std::endl;
+  std::cout << "  The records are exported to <solution>_<n>.txt, n being the save number as in the Text output." << std::endl;
+  std::cout << termcolor::reset;
+}
+
+
+
+int main(int argc, char** argv)
+{
+  //-------------------------------------------------------//
+  //---------------------Vérifications---------------------//
+  //-------------------------------------------------------//
+  if (argc < 2)
+    {
+      printUsage(argv[0]);
+      exit(-1);
+    }
+  std::string fileName(argv[1]);
+  SolutionFileReader reader(fileName);
+  std::string baseName(fileName.substr(0, fileName.rfind(".bin")));
+
+  // Numéro de sauvegarde d'un instant (celui des fichiers solution_*.txt)
+  const std::string& parameters(reader.getParameters());
+  double initialTime(parameterValue(parameters, "InitialTime", 0.));
+  double savePeriod(parameterValue(parameters, "SaveFrequency", 0.) * parameterValue(parameters, "TimeStep", 0.));
+  auto saveNumber = [&](int k, double t)
+    {
+      if (!(savePeriod > 0.))
+        return k;
+      return static_cast<int>(std::floor((t - initialTime) / savePeriod + 1e-6));
+    };
+
+
+  //-------------------------------------------------------//
+  //---------------------Liste des sauvegardes-------------//
+  //-------------------------------------------------------//
+  double t;
+  Eigen::VectorXd h, q;
+  if (argc == 2)
+    {
+      std::cout << fileName << " : " << reader.getNumberOfCells() << " cells, " << reader.getNumberOfRecords()
+                << " records (" << 8 * reader.getValueSize() << " bits)" << std::endl;
+      for (int k(0) ; k < reader.getNumberOfRecords() ; ++k)
+        {
+          reader.readRecord(k, t, h, q);
+          std::cout << k << " t = " << t << " (save " << saveNumber(k, t) << ")" << std::endl;
+        }
+      return 0;
+    }
+
+  
+  //-------------------------------------------------------//
+  //---------------------Export----------------------------//
+  //-------------------------------------------------------//
+  std::string what(argv[2]);
+  if (what == "parameters")
+    {
+      std::cout << reader.getParameters();
+      return 0;
+    }
+  int first(0), last(reader.getNumberOfRecords());
+  if (what != "all")
+    {
+      char* end(nullptr);
+      long k(std::strtol(what.c_str(), &end, 10));
+      if (what.empty() || *end != '\0' || k < 0 || k >= reader.getNumberOfRecords())
+        {
+          std::cout << termcolor::red << "ERROR::EXPORT : Invalid record " << what << " (" << reader.getNumberOfRecords() << " records)." << std::endl;
+          printUsage(argv[0]);
+          exit(-1);
+        }
+      first = k;
+      last = first + 1;
+    }
+  for (int k(first) ; k < last ; ++k)
+    {
+      reader.readRecord(k, t, h, q);
+      std::string outputName(baseName + "_" + std::to_string(saveNumber(k, t)) + ".txt");
+      if (argc > 3 && what != "all")
+        outputName = argv[3];
+      writeSolutionText(outputName, reader.getCellCenters(), reader.getTopography(), h, q, reader.getGravityAcceleration());
+      std::cout << "Record " << k << " (t = " << t << ") exported to " << outputName << std::endl;
+    }
+
+  return 0;
+}
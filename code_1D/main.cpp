@@ -3,9 +3,12 @@
 #include "Mesh.h"
 #include "Physics.h"
 #include "FiniteVolume.h"
+#include "FluxKernels.h"
 #include "TimeScheme.h"
+#include "Ensemble.h"
 
 #include <iostream>
+#include <string>
 
 
 
@@ -20,6 +23,22 @@ int main(int argc, char** argv)
       std::cout << termcolor::reset;
       exit(-1);
     }
+  // Reprise d'un calcul : ./main parameters.txt --restart results/checkpoint.bin
+  // Calcul d'ensemble : ./main parameters.txt --ensemble members.txt (voir Ensemble.h)
+  std::string restartFile, ensembleFile;
+  if (argc > 2)
+    {
+      if (argc != 4 || (std::string(argv[2]) != "--restart" && std::string(argv[2]) != "--ensemble"))
+        {
+          std::cout << termcolor::red << "Usage : " << argv[0] << " data_file [--restart checkpoint_file | --ensemble members_file]" << std::endl;
+          std::cout << termcolor::reset;
+          exit(-1);
+        }
+      if (std::string(argv[2]) == "--restart")
+        restartFile = argv[3];
+      else
+        ensembleFile = argv[3];
+    }
 
   
   //-------------------------------------------------------//
@@ -34,6 +53,7 @@ int main(int argc, char** argv)
   //---------------------Fichier de paramètres-------------//
   //-------------------------------------------------------//
   DataFile* DF = new DataFile(argv[1]);
+  DF->setRestartFile(restartFile);
   DF->readDataFile();
 #if VERBOSITY>0
   DF->printData();
@@ -57,51 +77,61 @@ int main(int argc, char** argv)
   //--------------------------------------------------------//
   //---------------------Flux numérique---------------------//
   //--------------------------------------------------------//
-  FiniteVolume* finVol;
-  if (DF->getNumericalFlux() == "LaxFriedrichs")
+  FiniteVolume* finVol(0);
+  switch (DF->getRunPlan().numericalFlux)
     {
+    case NumericalFluxType::LaxFriedrichs:
       finVol = new LaxFriedrichs(DF, mesh, physics);
-    }
-  else if (DF->getNumericalFlux() == "Rusanov")
-    {
+      break;
+    case NumericalFluxType::Rusanov:
       finVol = new Rusanov(DF, mesh, physics);
-    }
-  else if (DF->getNumericalFlux() == "HLL")
-    {
+      break;
+    case NumericalFluxType::HLL:
       finVol = new HLL(DF, mesh, physics);
+      break;
     }
-  else
-    {
-      std::cout << termcolor::red << "ERROR::FINITEVOLUME : Case not implemented." << std::endl;
-      std::cout << termcolor::reset;
-      exit(-1);
-    }
+#if VERBOSITY>0
+  std::cout << "Flux kernels : " << fluxKernelsInstructionSet() << std::endl;
+#endif
 
   
   //---------------------------------------------------------//
   //---------------------Schéma en temps---------------------//
   //---------------------------------------------------------//
-  TimeScheme* TS;
-  if (DF->getTimeScheme() == "ExplicitEuler")
+  TimeScheme* TS(0);
+  Ensemble* ensemble(0);
+  if (!ensembleFile.empty())
     {
-      TS = new ExplicitEuler(DF, mesh, physics, finVol);
-    }
-  else if (DF->getTimeScheme() == "RK2")
-    {
-      TS = new RK2(DF, mesh, physics, finVol);
+      ensemble = new Ensemble(DF, mesh, physics, finVol);
+      ensemble->readMembers(ensembleFile);
     }
   else
     {
-      std::cout << termcolor::red << "ERROR::TIMESCHEME : Case not implemented." << std::endl;
-      std::cout << termcolor::reset;
-      exit(-1);
+      switch (DF->getRunPlan().timeScheme)
+        {
+        case TimeSchemeType::ExplicitEuler:
+          TS = new ExplicitEuler(DF, mesh, physics, finVol);
+          break;
+        case TimeSchemeType::RK2:
+          TS = new RK2(DF, mesh, physics, finVol);
+          break;
+        case TimeSchemeType::SSPRK3:
+          TS = new SSPRK3(DF, mesh, physics, finVol);
+          break;
+        case TimeSchemeType::SSPRKs2:
+          TS = new SSPRKs2(DF, mesh, physics, finVol);
+          break;
+        }
     }
 
 
   //----------------------------------------------------//
   //---------------------Résolution---------------------//
   //----------------------------------------------------//
-  TS->solve();
+  if (ensemble)
+    ensemble->solve();
+  else
+    TS->solve();
 
   
   //-----------------------------------------------------------//
@@ -112,6 +142,7 @@ int main(int argc, char** argv)
   delete physics;
   delete finVol;
   delete TS;
+  delete ensemble;
 
   
   //-----------------------------------------------------//
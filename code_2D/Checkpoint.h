@@ -0,0 +1,106 @@
+/*!
+ * @file Checkpoint.h
+ *
+ * Defines a class to write and read the checkpoints of the time loop.
+ *
+ * @authors Gabriel Suau, Remi Pegouret, Lucas Trautmann
+ *
+ * @version 0.1.0
+ *
+ * @copyright © 2021 Gabriel Suau
+ * @copyright © 2021 Remi Pegouret
+ * @copyright © 2021 Lucas Trautmann
+ * 
+ * @copyright This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * @copyright You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "Layout.h"
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Point de reprise d'un calcul : l'état complet de la boucle en temps,
+// sérialisé dans un buffer puis écrit d'un seul coup dans un fichier.
+//
+// L'écriture est atomique : le fichier est d'abord écrit sous un nom
+// temporaire, synchronisé sur le disque puis renommé. Un calcul arrêté au
+// milieu d'une écriture laisse donc toujours le point de reprise précédent
+// intact. Les valeurs sont relues dans l'ordre où elles ont été ajoutées.
+class Checkpoint
+{
+private:
+  std::vector<char> _buffer;
+  std::size_t _position;
+  std::string _fileName;
+
+  // Arrête le programme si le fichier est trop court
+  void checkRemaining(std::size_t size) const;
+
+public:
+  // Constructeur
+  Checkpoint();
+
+  // Ajout de valeurs (types simples uniquement)
+  template<class T>
+  void put(const T& value)
+  {
+    putBytes(&value, sizeof(T));
+  }
+  template<class T>
+  void putVector(const std::vector<T>& values)
+  {
+    put<long long>(values.size());
+    putBytes(values.data(), values.size() * sizeof(T));
+  }
+  void putBytes(const void* data, std::size_t size);
+  void putString(const std::string& value);
+  void putMatrix(const StateMatrix& matrix);
+
+  // Lecture des valeurs, dans le même ordre
+  template<class T>
+  T get()
+  {
+    T value;
+    getBytes(&value, sizeof(T));
+    return value;
+  }
+  template<class T>
+  void getVector(std::vector<T>& values)
+  {
+    values.resize(get<long long>());
+    getBytes(values.data(), values.size() * sizeof(T));
+  }
+  void getBytes(void* data, std::size_t size);
+  std::string getString();
+  void getMatrix(StateMatrix& matrix);
+
+  // Écriture atomique (fichier temporaire + renommage) et lecture
+  void save(const std::string& fileName) const;
+  void load(const std::string& fileName);
+};
+
+// Outils pour remettre les fichiers de sortie dans l'état du point de reprise
+// Taille d'un fichier en octets (0 s'il n'existe pas)
+long long fileSize(const std::string& fileName);
+// Tronque un fichier à size octets
+void truncateFile(const std::string& fileName, long long size);
+// Empreinte (FNV-1a) d'une chaîne, pour reconnaître un fichier de paramètres
+unsigned long long stringHash(const std::string& value);
+
+#endif // CHECKPOINT_H
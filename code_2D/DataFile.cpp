@@ -36,12 +36,13 @@
 #include <cmath>
 #include <regex>
 
-DataFile::DataFile()
+DataFile::DataFile():
+  _meshRenumbering("None"), _useMeshCache(false), _rungeKuttaStages(4), _isAdaptiveTimeStep(false), _outputFormat("VTK"), _checkpointInterval(0.)
 {
 }
 
 DataFile::DataFile(const std::string& fileName):
-  _fileName(fileName), _scenario("none")
+  _fileName(fileName), _scenario("none"), _meshRenumbering("None"), _useMeshCache(false), _rungeKuttaStages(4), _isAdaptiveTimeStep(false), _outputFormat("VTK"), _checkpointInterval(0.)
 {
 }
 
@@ -49,6 +50,13 @@ void DataFile::Initialize(const std::string& fileName)
 {
   _fileName = fileName;
   _scenario = "none";
+  _meshRenumbering = "None";
+  _useMeshCache = false;
+  _rungeKuttaStages = 4;
+  _isAdaptiveTimeStep = false;
+  _outputFormat = "VTK";
+  _checkpointInterval = 0.;
+  _restartFile = "";
 }
 
 std::string DataFile::cleanLine(std::string &line)
@@ -93,6 +101,10 @@ void DataFile::readDataFile()
         {
           data_file >> _timeScheme;
         }
+      if (proper_line.find("RungeKuttaStages") != std::string::npos)
+        {
+          data_file >> _rungeKuttaStages;
+        }
       if (proper_line.find("NumericalFlux") != std::string::npos)
         {
           data_file >> _numericalFlux;
@@ -105,6 +117,14 @@ void DataFile::readDataFile()
         {
           data_file >> _meshFile;
         }
+      if (proper_line.find("MeshRenumbering") != std::string::npos)
+        {
+          data_file >> _meshRenumbering;
+        }
+      if (proper_line.find("MeshCache") != std::string::npos)
+        {
+          data_file >> _useMeshCache;
+        }
       if (proper_line.find("InitialTime") != std::string::npos)
         {
           data_file >> _initialTime;
@@ -121,6 +141,10 @@ void DataFile::readDataFile()
         {
           data_file >> _CFL;
         }
+      if (proper_line.find("AdaptiveStepping") != std::string::npos)
+        {
+          data_file >> _isAdaptiveTimeStep;
+        }
       if (proper_line.find("GravityAcceleration") != std::string::npos)
         {
           data_file >> _g;
@@ -129,6 +153,14 @@ void DataFile::readDataFile()
         {
           data_file >> _saveFrequency;
         }
+      if (proper_line.find("OutputFormat") != std::string::npos)
+        {
+          data_file >> _outputFormat;
+        }
+      if (proper_line.find("CheckpointInterval") != std::string::npos)
+        {
+          data_file >> _checkpointInterval;
+        }
       if (proper_line.find("Scenario") != std::string::npos)
         {
           data_file >> _scenario;
@@ -160,7 +192,11 @@ void DataFile::readDataFile()
   // Création et nettoyage du dossier de résultats
   std::cout << "Creating the results directory..." << std::endl;
   system(("mkdir -p ./" +_resultsDir).c_str());
-  system(("rm -f ./" +_resultsDir + "/solution*").c_str());
+  // The results already written are kept when restarting
+  if (!isRestart())
+    {
+      system(("rm -f ./" +_resultsDir + "/solution*").c_str());
+    }
   system(("cp -r ./" + _fileName + " ./" + _resultsDir + "/params.txt").c_str());
 
   // Logs
@@ -180,12 +216,100 @@ void DataFile::readDataFile()
     {
       _topographyType = "FlatBottom";
     }
+
+  // Convert the options into enumerations
+  buildRunPlan();
+
   // Logs de succès
   std::cout << termcolor::green << "SUCCESS::DATAFILE : File read successfully" << std::endl;
   std::cout << termcolor::reset << "====================================================================================================" << std::endl << std::endl;
 }
 
 
+// Stop the program if an option has an unknown value
+static void unknownOption(const std::string& option, const std::string& value)
+{
+  std::cout << termcolor::red << "ERROR::DATAFILE : Case not implemented for " << option << " : " << value << std::endl;
+  std::cout << termcolor::reset;
+  exit(-1);
+}
+
+// Build the resolved options. Every string option is checked here, only
+// once, so that the solver does not have to compare them anymore.
+void DataFile::buildRunPlan()
+{
+  if (_numericalFlux == "Rusanov")
+    _runPlan.numericalFlux = NumericalFluxType::Rusanov;
+  else if (_numericalFlux == "HLL")
+    _runPlan.numericalFlux = NumericalFluxType::HLL;
+  else
+    unknownOption("NumericalFlux", _numericalFlux);
+
+  if (_timeScheme == "ExplicitEuler")
+    _runPlan.timeScheme = TimeSchemeType::ExplicitEuler;
+  else if (_timeScheme == "SSPRK3")
+    _runPlan.timeScheme = TimeSchemeType::SSPRK3;
+  else if (_timeScheme == "SSPRKs2")
+    _runPlan.timeScheme = TimeSchemeType::SSPRKs2;
+  else
+    unknownOption("TimeScheme", _timeScheme);
+  if (_rungeKuttaStages < 2)
+    unknownOption("RungeKuttaStages", std::to_string(_rungeKuttaStages));
+  _runPlan.rungeKuttaStages = _rungeKuttaStages;
+
+  _runPlan.timeStep = _timeStep;
+  _runPlan.isAdaptiveTimeStep = _isAdaptiveTimeStep;
+  _runPlan.CFL = _CFL;
+  _runPlan.g = _g;
+  _runPlan.saveFrequency = _saveFrequency;
+
+  if (_outputFormat == "VTK")
+    _runPlan.outputFormat = OutputFormatType::VTK;
+  else if (_outputFormat == "XDMF")
+    _runPlan.outputFormat = OutputFormatType::XDMF;
+  else
+    unknownOption("OutputFormat", _outputFormat);
+  _runPlan.checkpointInterval = _checkpointInterval;
+
+  if (_scenario == "ConstantWaterHeight")
+    _runPlan.scenario = ScenarioType::ConstantWaterHeight;
+  else if (_scenario == "RestingLake")
+    _runPlan.scenario = ScenarioType::RestingLake;
+  else if (_scenario == "DamBreak")
+    _runPlan.scenario = ScenarioType::DamBreak;
+  else if (_scenario == "SinePerturbation")
+    _runPlan.scenario = ScenarioType::SinePerturbation;
+  else
+    unknownOption("Scenario", _scenario);
+
+  if (_topographyType == "FlatBottom")
+    _runPlan.topography = TopographyType::FlatBottom;
+  else if (_topographyType == "LinearUp")
+    _runPlan.topography = TopographyType::LinearUp;
+  else if (_topographyType == "LinearDown")
+    _runPlan.topography = TopographyType::LinearDown;
+  else if (_topographyType == "SineLinearUp")
+    _runPlan.topography = TopographyType::SineLinearUp;
+  else if (_topographyType == "SineLinearDown")
+    _runPlan.topography = TopographyType::SineLinearDown;
+  else if (_topographyType == "EllipticBump")
+    _runPlan.topography = TopographyType::EllipticBump;
+  else if (_topographyType == "File")
+    _runPlan.topography = TopographyType::File;
+  else
+    unknownOption("TopographyType", _topographyType);
+
+  if (_meshRenumbering == "None")
+    _runPlan.meshRenumbering = MeshRenumberingType::None;
+  else if (_meshRenumbering == "RCM")
+    _runPlan.meshRenumbering = MeshRenumberingType::RCM;
+  else if (_meshRenumbering == "Hilbert")
+    _runPlan.meshRenumbering = MeshRenumberingType::Hilbert;
+  else
+    unknownOption("MeshRenumbering", _meshRenumbering);
+  _runPlan.useMeshCache = _useMeshCache;
+}
+
 // Affiche les paramètres sur le terminal
 void DataFile::printData() const
 {
@@ -193,19 +317,31 @@ void DataFile::printData() const
   std::cout << "Printing parameters of " << _fileName << std::endl;
   std::cout << "Mesh                = Get from file" << std::endl;
   std::cout << "Mesh file           = " << _meshFile << std::endl;
+  std::cout << "Mesh renumbering    = " << _meshRenumbering << std::endl;
+  std::cout << "Mesh cache          = " << _useMeshCache << std::endl;
   std::cout << "Boundary conditions = " << _nBoundaries << std::endl;
   for (int i(0) ; i < _nBoundaries ; ++i)
     {
       std::cout << "   " << _boundaryConditionReference(i) << " " << _boundaryConditionType[i] << std::endl; 
     }
   std::cout << "Time Scheme         = " << _timeScheme << std::endl;
+  if (_timeScheme == "SSPRKs2")
+    std::cout << "  |Stages           = " << _rungeKuttaStages << std::endl;
   std::cout << "Initial time        = " << _initialTime << std::endl;
   std::cout << "Final time          = " << _finalTime << std::endl;
   std::cout << "Time step           = " << _timeStep << std::endl;
+  std::cout << "Adaptive time step  = " << _isAdaptiveTimeStep << std::endl;
+  if (_isAdaptiveTimeStep)
+    std::cout << "   |CFL             = " << _CFL << std::endl;
   std::cout << "Gravity             = " << _g << std::endl;
   std::cout << "Numerical Flux      = " << _numericalFlux << std::endl;
   std::cout << "Results directory   = " << _resultsDir << std::endl;
   std::cout << "Save Frequency      = " << _saveFrequency << std::endl;
+  std::cout << "Output format       = " << _outputFormat << std::endl;
+  if (_checkpointInterval > 0)
+    std::cout << "Checkpoint interval = " << _checkpointInterval << " s" << std::endl;
+  if (isRestart())
+    std::cout << "Restart from        = " << _restartFile << std::endl;
   std::cout << "Scenario            = " << _scenario << std::endl;
   std::cout << "Topography          = " << _topographyType << std::endl;
   if (_topographyType == "File")
@@ -34,6 +34,37 @@
 #include <string>
 #include <vector>
 
+// Options of the data file, converted once into enumerations after the
+// file has been read (see RunPlan).
+enum class NumericalFluxType {Rusanov, HLL};
+enum class TimeSchemeType {ExplicitEuler, SSPRK3, SSPRKs2};
+enum class TopographyType {FlatBottom, LinearUp, LinearDown, SineLinearUp, SineLinearDown, EllipticBump, File};
+enum class ScenarioType {ConstantWaterHeight, RestingLake, DamBreak, SinePerturbation};
+enum class MeshRenumberingType {None, RCM, Hilbert};
+enum class OutputFormatType {VTK, XDMF};
+
+// Resolved options of the simulation. It is built once by
+// DataFile::readDataFile and copied by the solver objects, so that the
+// time loop never compares strings nor calls the DataFile getters.
+struct RunPlan
+{
+  NumericalFluxType numericalFlux;
+  TimeSchemeType timeScheme;
+  // Number of stages of SSPRKs2
+  int rungeKuttaStages;
+  double timeStep;
+  bool isAdaptiveTimeStep;
+  double CFL;
+  double g;
+  int saveFrequency;
+  OutputFormatType outputFormat;
+  double checkpointInterval;
+  ScenarioType scenario;
+  TopographyType topography;
+  MeshRenumberingType meshRenumbering;
+  bool useMeshCache;
+};
+
 class DataFile
 {
 private:
@@ -43,19 +74,29 @@ private:
   std::string _resultsDir;
 
   std::string _meshFile;
+  std::string _meshRenumbering;
+  bool _useMeshCache;
 
   std::string _numericalFlux;
 
   // Time parameters
   std::string _timeScheme;
+  // Number of stages of SSPRKs2 (s >= 2)
+  int _rungeKuttaStages;
   double _initialTime;
   double _finalTime;
   double _timeStep;
   double _CFL;
+  bool _isAdaptiveTimeStep;
 
   double _g;
 
   int _saveFrequency;
+  std::string _outputFormat;
+
+  // Checkpoints (wall-clock interval in seconds, 0 = none) and restart file
+  double _checkpointInterval;
+  std::string _restartFile;
 
   // Topography
   bool _isTopography;
@@ -66,6 +107,9 @@ private:
   int _nBoundaries;
   Eigen::VectorXi _boundaryConditionReference;
   std::vector<std::string> _boundaryConditionType;
+
+  // Resolved options
+  RunPlan _runPlan;
   
 public:
   DataFile();
@@ -75,28 +119,43 @@ public:
 
   void Initialize(const std::string& fileName);
 
+  // Restart from a checkpoint (to be called before readDataFile)
+  void setRestartFile(const std::string& restartFile) {_restartFile = restartFile;};
+
   void readDataFile();
 
   std::string cleanLine(std::string &line);
 
+  // Convert the options into enumerations (called by readDataFile)
+  void buildRunPlan();
+
   // Getters
   const std::string& getFileName() const {return _fileName;};
   const std::string& getScenario() const {return _scenario;};
   const std::string& getResultsDirectory() const {return _resultsDir;};
   const std::string& getMeshFile() const {return _meshFile;};
+  const std::string& getMeshRenumbering() const {return _meshRenumbering;};
+  bool useMeshCache() const {return _useMeshCache;};
   const std::string& getNumericalFlux() const {return _numericalFlux;};
   const std::string& getTimeScheme() const {return _timeScheme;};
+  int getRungeKuttaStages() const {return _rungeKuttaStages;};
   double getInitialTime() const {return _initialTime;};
   double getFinalTime() const {return _finalTime;};
   double getTimeStep() const {return _timeStep;};
   double getCFL() const {return _CFL;};
+  bool isAdaptiveTimeStep() const {return _isAdaptiveTimeStep;};
   double getGravityAcceleration() const {return _g;};
   int getSaveFrequency() const {return _saveFrequency;};
+  const std::string& getOutputFormat() const {return _outputFormat;};
+  double getCheckpointInterval() const {return _checkpointInterval;};
+  const std::string& getRestartFile() const {return _restartFile;};
+  bool isRestart() const {return !_restartFile.empty();};
   bool isTopography() const {return _isTopography;};
   const std::string& getTopographyType() const {return _topographyType;};
   const std::string& getTopographyFile() const {return _topographyFile;};
   const Eigen::VectorXi& getBoundaryConditionReference() const {return _boundaryConditionReference;};
   const std::vector<std::string>& getBoundaryConditionType() const {return _boundaryConditionType;};
+  const RunPlan& getRunPlan() const {return _runPlan;};
 
   // Print the parameters
   void printData() const;
@@ -29,12 +29,15 @@
 #include "DataFile.h"
 #include "Mesh.h"
 #include "Physics.h"
+#include "Profiler.h"
 
 #include "Eigen/Eigen/Dense"
 #include "Eigen/Eigen/Sparse"
 
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <limits>
 
 //--------------------------------------------------//
 //--------------------Base Class--------------------//
@@ -43,17 +46,16 @@ FiniteVolume::FiniteVolume()
 {
 }
 
-FiniteVolume::FiniteVolume(DataFile* DF, Mesh* mesh, Physics* physics):
-  _DF(DF), _mesh(mesh), _physics(physics), _fluxVector(_mesh->getNumberOfCells(), 3)
+FiniteVolume::FiniteVolume(const DataFile* DF, const Mesh* mesh, const Physics* physics):
+  _DF(DF), _mesh(mesh), _physics(physics)
 {
 }
 
-void FiniteVolume::Initialize(DataFile* DF, Mesh* mesh, Physics* physics)
+void FiniteVolume::Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics)
 {
   _DF = DF;
   _mesh = mesh;
   _physics = physics;
-  _fluxVector.resize(_mesh->getNumberOfCells(), 3);
 }
 
 
@@ -65,23 +67,22 @@ Rusanov::Rusanov():
 {
 }
 
-Rusanov::Rusanov(DataFile* DF, Mesh* mesh, Physics* physics):
+Rusanov::Rusanov(const DataFile* DF, const Mesh* mesh, const Physics* physics):
   FiniteVolume(DF, mesh, physics)
 {
   _fluxName = "Rusanov";
 }
 
-void Rusanov::Initialize(DataFile* DF, Mesh* mesh, Physics* physics)
+void Rusanov::Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics)
 {
   _DF = DF;
   _mesh = mesh;
   _physics = physics;
   _fluxName = "Rusanov";
-  _fluxVector.resize(_mesh->getNumberOfCells(), 3);
 }
 
 // Compute the numerical flux across an edge
-Eigen::Vector3d Rusanov::numFlux1D(const Eigen::Vector3d& SolG, const Eigen::Vector3d& SolD, const Eigen::Vector2d& normal) const
+Eigen::Vector3d Rusanov::numFlux1D(const Eigen::Vector3d& SolG, const Eigen::Vector3d& SolD, const Eigen::Vector2d& normal, double& waveSpeed) const
 {
   // Vecteur flux au travers de l'arête.
   Eigen::Vector3d flux;
@@ -90,6 +91,7 @@ Eigen::Vector3d Rusanov::numFlux1D(const Eigen::Vector3d& SolG, const Eigen::Vec
   double lambda1, lambda2;
   _physics->computeWaveSpeed(SolG, SolD, normal, lambda1, lambda2);
   double b(std::max(lambda1,lambda2));
+  waveSpeed = std::max(std::abs(lambda1),std::abs(lambda2));
 
   // Calcul du flux
   flux = 0.5 * ((_physics->physicalFlux(SolD) + _physics->physicalFlux(SolG))*normal - b * (SolD - SolG));
@@ -97,38 +99,67 @@ Eigen::Vector3d Rusanov::numFlux1D(const Eigen::Vector3d& SolG, const Eigen::Vec
 }
 
 
-void Rusanov::buildFluxVector(const Eigen::Matrix<double, Eigen::Dynamic, 3>& Sol)
+void Rusanov::buildFluxVector(const StateMatrix& Sol, SolverState& state) const
 {
+  // The boundary edges are done in the same loop as the interior ones,
+  // their time is counted with the fluxes
+  PROFILE_SCOPE(RiemannFluxes);
+
   // Reset the flux 
-  _fluxVector.setZero();
+  StateMatrix& fluxVector(state.fluxVector);
+  fluxVector.setZero();
 
   // Get mesh parameters
   // Edges
-  int nbEdges(_mesh->getNumberOfEdges());
-  const std::vector<Edge>& edges(_mesh->getEdges());
+  const Eigen::Matrix<int, Eigen::Dynamic, 2>& edgesCells(_mesh->getEdgesCells());
   const Eigen::VectorXd& edgesLength(_mesh->getEdgesLength());
   const Eigen::Matrix<double, Eigen::Dynamic, 2>& edgesNormal(_mesh->getEdgesNormal());
-
-  // Boucle sur les arêtes
-  for (int i(0) ; i < nbEdges ; ++i)
+  // Edge colouring : the edges of one colour never share a cell
+  int nbColours(_mesh->getNumberOfEdgeColours());
+  const std::vector<int>& colourOffsets(_mesh->getEdgeColourOffsets());
+  const std::vector<int>& colouredEdges(_mesh->getColouredEdges());
+
+  // The colours are done one after the other and the edges of a colour are
+  // shared between the threads. The order of the contributions to a cell
+  // does not depend on the number of threads, and neither does the result.
+  double maxWaveSpeed(0.);
+  bool isNaN(false);
+#pragma omp parallel
+  for (int k(0) ; k < nbColours ; ++k)
     {
-      int c1(edges[i].getC1()), c2(edges[i].getC2());
-      double edgeLength(edgesLength(i));
-      Eigen::Vector2d edgeNormal(edgesNormal.row(i));
-      // Boundary edges
-      if (c2 == -1)
-        {
-          Eigen::Vector3d flux1D(numFlux1D(Sol.row(c1), Sol.row(c1), edgeNormal));
-          _fluxVector.row(c1) += edgeLength * flux1D;
-        }
-      // Interior edges
-      else
+      // Boucle sur les arêtes de la couleur k
+#pragma omp for reduction(max:maxWaveSpeed) reduction(||:isNaN)
+      for (int n = colourOffsets[k] ; n < colourOffsets[k+1] ; ++n)
         {
-          Eigen::Vector3d flux1D(numFlux1D(Sol.row(c1), Sol.row(c2), edgeNormal));
-          _fluxVector.row(c1) += edgeLength * flux1D;
-          _fluxVector.row(c2) -= edgeLength * flux1D;
+          int i(colouredEdges[n]);
+          int c1(edgesCells(i,0)), c2(edgesCells(i,1));
+          double edgeLength(edgesLength(i));
+          Eigen::Vector2d edgeNormal(edgesNormal.row(i));
+          double waveSpeed;
+          Eigen::Vector3d flux1D;
+          // Boundary edges
+          if (c2 == -1)
+            {
+              flux1D = numFlux1D(Sol.row(c1), Sol.row(c1), edgeNormal, waveSpeed);
+              fluxVector.row(c1) += edgeLength * flux1D;
+            }
+          // Interior edges
+          else
+            {
+              flux1D = numFlux1D(Sol.row(c1), Sol.row(c2), edgeNormal, waveSpeed);
+              fluxVector.row(c1) += edgeLength * flux1D;
+              fluxVector.row(c2) -= edgeLength * flux1D;
+            }
+          // Keep the largest wave speed for the CFL condition. std::max and
+          // the max reduction drop NaN, and so may the wave speed for a NaN
+          // in c2 : a blow-up is caught by the mass flux, NaN as soon as one
+          // of the two cells is.
+          maxWaveSpeed = std::max(maxWaveSpeed, waveSpeed);
+          if (std::isnan(waveSpeed) || std::isnan(flux1D(0)))
+            isNaN = true;
         }
     }
+  state.maxWaveSpeed = (isNaN ? std::numeric_limits<double>::quiet_NaN() : maxWaveSpeed);
 }
 
 //--------------------------------------------------//
@@ -139,30 +170,29 @@ HLL::HLL():
 {
 }
 
-HLL::HLL(DataFile* DF, Mesh* mesh, Physics* physics):
+HLL::HLL(const DataFile* DF, const Mesh* mesh, const Physics* physics):
   FiniteVolume(DF, mesh, physics)
 {
   _fluxName = "HLL";
 }
 
-void HLL::Initialize(DataFile* DF, Mesh* mesh, Physics* physics)
+void HLL::Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics)
 {
   _DF = DF;
   _mesh = mesh;
   _physics = physics;
   _fluxName = "HLL";
-  _fluxVector.resize(_mesh->getNumberOfCells(), 3);
 }
 
 // Compute the numerical flux across an edge
-Eigen::Vector3d HLL::numFlux1D(const Eigen::Vector3d& SolG, const Eigen::Vector3d& SolD, const Eigen::Vector2d& normal) const
+Eigen::Vector3d HLL::numFlux1D(const Eigen::Vector3d& SolG, const Eigen::Vector3d& SolD, const Eigen::Vector2d& normal, double&) const
 {
   Eigen::Vector3d flux;
 
   // TODO
 }
 
-void HLL::buildFluxVector(const Eigen::Matrix<double, Eigen::Dynamic, 3>& Sol)
+void HLL::buildFluxVector(const StateMatrix& Sol, SolverState&) const
 {
   // TODO
 }
@@ -31,6 +31,8 @@
 #include "DataFile.h"
 #include "Mesh.h"
 #include "Physics.h"
+#include "Layout.h"
+#include "SolverState.h"
 
 #include "Eigen/Eigen/Dense"
 #include "Eigen/Eigen/Sparse"
@@ -42,34 +44,31 @@ class FiniteVolume
 {
 protected:
   // Pointeurs vers les trucs importants
-  DataFile* _DF;
-  Mesh* _mesh;
-  Physics* _physics;
+  const DataFile* _DF;
+  const Mesh* _mesh;
+  const Physics* _physics;
 
   // Nom du flux numérique
   std::string _fluxName;
-
-  // Vecteur des flux
-  Eigen::Matrix<double, Eigen::Dynamic, 3> _fluxVector;
   
 public:
   // Constructeurs
   FiniteVolume();
-  FiniteVolume(DataFile* DF, Mesh* mesh, Physics* physics);
+  FiniteVolume(const DataFile* DF, const Mesh* mesh, const Physics* physics);
 
   // Destructeur
   virtual ~FiniteVolume() = default;
   
   // Initialisation
-  void Initialize(DataFile* DF, Mesh* mesh, Physics* physics);
+  void Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics);
 
   // Getters
   const std::string& getFluxName() const {return _fluxName;};
-  const Eigen::Matrix<double, Eigen::Dynamic, 3>& getFluxVector() const {return _fluxVector;};
   
-  // Fluxes
-  virtual Eigen::Vector3d numFlux1D(const Eigen::Vector3d& SolG, const Eigen::Vector3d& SolD, const Eigen::Vector2d& normal) const = 0;
-  virtual void buildFluxVector(const Eigen::Matrix<double, Eigen::Dynamic, 3>& Sol) = 0;
+  // Fluxes. numFlux1D also returns the largest wave speed |lambda| across the edge.
+  // buildFluxVector builds state.fluxVector and state.maxWaveSpeed.
+  virtual Eigen::Vector3d numFlux1D(const Eigen::Vector3d& SolG, const Eigen::Vector3d& SolD, const Eigen::Vector2d& normal, double& waveSpeed) const = 0;
+  virtual void buildFluxVector(const StateMatrix& Sol, SolverState& state) const = 0;
 };
 
 
@@ -81,14 +80,14 @@ class Rusanov: public FiniteVolume
 public:
   // Constructeur
   Rusanov();
-  Rusanov(DataFile* DF, Mesh* mesh, Physics* physics);
+  Rusanov(const DataFile* DF, const Mesh* mesh, const Physics* physics);
 
   // Initialisation
-  void Initialize(DataFile* DF, Mesh* mesh, Physics* physics);
+  void Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics);
 
   // Build flux vector
-  void buildFluxVector(const Eigen::Matrix<double, Eigen::Dynamic, 3>& Sol);
-  Eigen::Vector3d numFlux1D(const Eigen::Vector3d& SolG, const Eigen::Vector3d& SolD, const Eigen::Vector2d& normal) const;
+  void buildFluxVector(const StateMatrix& Sol, SolverState& state) const;
+  Eigen::Vector3d numFlux1D(const Eigen::Vector3d& SolG, const Eigen::Vector3d& SolD, const Eigen::Vector2d& normal, double& waveSpeed) const;
 };
 
 
@@ -100,14 +99,14 @@ class HLL: public FiniteVolume
 public:
   // Constructeur
   HLL();
-  HLL(DataFile* DF, Mesh* mesh, Physics* physics);
+  HLL(const DataFile* DF, const Mesh* mesh, const Physics* physics);
 
   // Initialisation
-  void Initialize(DataFile* DF, Mesh* mesh, Physics* physics);
+  void Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics);
 
   // Build flux vector
-  void buildFluxVector(const Eigen::Matrix<double, Eigen::Dynamic, 3>& Sol);
-  Eigen::Vector3d numFlux1D(const Eigen::Vector3d& SolG, const Eigen::Vector3d& SolD, const Eigen::Vector2d& normal) const;
+  void buildFluxVector(const StateMatrix& Sol, SolverState& state) const;
+  Eigen::Vector3d numFlux1D(const Eigen::Vector3d& SolG, const Eigen::Vector3d& SolD, const Eigen::Vector2d& normal, double& waveSpeed) const;
 };
 
 #endif //FINITE_VOLUME_H
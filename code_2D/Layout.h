@@ -0,0 +1,60 @@
+/*!
+ * @file Layout.h
+ *
+ * Defines the storage layout of the conserved variables.
+ *
+ * @authors Gabriel Suau, Remi Pegouret, Lucas Trautmann
+ *
+ * @version 0.1.0
+ *
+ * @copyright © 2021 Gabriel Suau
+ * @copyright © 2021 Remi Pegouret
+ * @copyright © 2021 Lucas Trautmann
+ * 
+ * @copyright This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * @copyright You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include "Eigen/Eigen/Dense"
+
+// Storage layouts of the matrices with one row per cell and one column per
+// conserved variable (solution, flux vector and source term).
+//   - SoALayout : column-major, each variable is contiguous (structure of arrays)
+//   - AoSLayout : row-major, the variables of a cell are contiguous (array of structures)
+// The layout is chosen at compile time with the LAYOUT variable of the Makefile.
+struct SoALayout
+{
+  static const int storageOrder = Eigen::ColMajor;
+};
+
+struct AoSLayout
+{
+  static const int storageOrder = Eigen::RowMajor;
+};
+
+template<class Layout, int nVariables>
+using CellMatrix = Eigen::Matrix<double, Eigen::Dynamic, nVariables, Layout::storageOrder>;
+
+#ifdef AOS_LAYOUT
+typedef AoSLayout StateLayout;
+#else
+typedef SoALayout StateLayout;
+#endif
+
+// Conserved variables (h, qx, qy) on each cell
+typedef CellMatrix<StateLayout, 3> StateMatrix;
+
+#endif // LAYOUT_H
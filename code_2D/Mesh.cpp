@@ -34,6 +34,14 @@
 
 #include <fstream>
 #include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 //--------------------------------------------------//
 //---------------------Vertices---------------------//
@@ -58,48 +66,72 @@ void Vertex::print() const
 //---------------------Edges---------------------//
 //-----------------------------------------------//
 Edge::Edge():
-  _index(-1), _verticesIndex(-1,-1)
+  _mesh(0), _edge(-1)
 {
 }
 
-Edge::Edge(int vertex1, int vertex2, int index, std::string boundaryCondition):
-  _index(index), _c1(-1), _c2(-1), _boundaryCondition(boundaryCondition)
+Edge::Edge(const Mesh* mesh, int edge):
+  _mesh(mesh), _edge(edge)
 {
-  if (vertex1 > vertex2)
-    {
-      _verticesIndex(0) = vertex2;
-      _verticesIndex(1) = vertex1;
-    }
-  else
-    {
-      _verticesIndex(0) = vertex1;
-      _verticesIndex(1) = vertex2;
-    }
+}
+
+int Edge::getIndex() const {return _mesh->getEdgesReference()(_edge);}
+int Edge::getC1() const {return _mesh->getEdgesCells()(_edge,0);}
+int Edge::getC2() const {return _mesh->getEdgesCells()(_edge,1);}
+double Edge::getLength() const {return _mesh->getEdgesLength()(_edge);}
+Eigen::Vector2i Edge::getVerticesIndex() const {return _mesh->getEdgesVertices().row(_edge);}
+Eigen::Vector2d Edge::getNormal() const {return _mesh->getEdgesNormal().row(_edge);}
+Eigen::Vector2d Edge::getCenter() const {return _mesh->getEdgesCenter().row(_edge);}
+int Edge::getBoundaryConditionID() const {return _mesh->getEdgesBoundaryCondition()(_edge);}
+
+const std::string& Edge::getBoundaryCondition() const
+{
+  static const std::string none("none");
+  int BC(getBoundaryConditionID());
+  return (BC == -1 ? none : _mesh->getBoundaryConditionType()[BC]);
 }
 
 void Edge::print() const
 {
-  std::cout << "(vertex1,vertex2,index) = (" << _verticesIndex(0)  << "," << _verticesIndex(1) << "," << _index << ")" << std::endl;
+  Eigen::Vector2i verticesIndex(getVerticesIndex());
+  std::cout << "(vertex1,vertex2,index) = (" << verticesIndex(0)  << "," << verticesIndex(1) << "," << getIndex() << ")" << std::endl;
 }
 
 //------------------------------------------------------------//
 //---------------------Generic Cell class---------------------//
 //------------------------------------------------------------//
-Cell::Cell()
+Cell::Cell():
+  _mesh(0), _cell(-1)
 {
 }
 
-Cell::Cell(const Eigen::VectorXi& verticesIndex, int index):
-  _index(index), _nbVertices(verticesIndex.size()), _verticesIndex(verticesIndex)
+Cell::Cell(const Mesh* mesh, int cell):
+  _mesh(mesh), _cell(cell)
 {  
 }
 
+int Cell::getIndex() const {return _mesh->getCellsReference()(_cell);}
+double Cell::getArea() const {return _mesh->getCellsArea()(_cell);}
+Eigen::Vector2d Cell::getCenter() const {return _mesh->getCellsCenter().row(_cell);}
+
+int Cell::getNumberOfVertices() const
+{
+  const Eigen::VectorXi& offsets(_mesh->getCellsVerticesOffsets());
+  return offsets(_cell+1) - offsets(_cell);
+}
+
+Eigen::VectorXi::ConstSegmentReturnType Cell::getVerticesIndex() const
+{
+  const Eigen::VectorXi& offsets(_mesh->getCellsVerticesOffsets());
+  return _mesh->getCellsVertices().segment(offsets(_cell), offsets(_cell+1) - offsets(_cell));
+}
+
 void Cell::print() const
 {
-  std::cout << "Cell (index,vertices) = (" << _index;
-  for (int i(0) ; i < _nbVertices ; ++i)
+  std::cout << "Cell (index,vertices) = (" << getIndex();
+  for (int i(0) ; i < getNumberOfVertices() ; ++i)
     {
-      std::cout << "," << _verticesIndex(i);
+      std::cout << "," << getVerticesIndex()(i);
     }
   std::cout << ")" << std::endl;
 }
@@ -107,12 +139,13 @@ void Cell::print() const
 //----------------------------------------------//
 //---------------------Mesh---------------------//
 //----------------------------------------------//
-Mesh::Mesh()
+Mesh::Mesh():
+  _numberOfEdgeColours(0)
 {
 }
 
 Mesh::Mesh(DataFile* DF):
-  _DF(DF), _meshFile(_DF->getMeshFile()), _boundaryConditionReference(_DF->getBoundaryConditionReference()), _boundaryConditionType(_DF->getBoundaryConditionType())
+  _DF(DF), _meshFile(_DF->getMeshFile()), _numberOfEdgeColours(0), _boundaryConditionReference(_DF->getBoundaryConditionReference()), _boundaryConditionType(_DF->getBoundaryConditionType())
 {
 }
 
@@ -126,23 +159,24 @@ void Mesh::Initialize(DataFile* DF)
 }
 
 // Ajoute une arête
-void Mesh::addEdge(const Edge& edge, int nc, std::vector<int>& headMinv, std::vector<int>& nextEdge, int& nbEdge)
+void Mesh::addEdge(int vertex1, int vertex2, int reference, int boundaryCondition, int nc,
+                   std::vector<int>& headMinv, std::vector<int>& nextEdge, int& nbEdge)
 {
-  int vertex1 = edge.getVerticesIndex()(0);
-  int vertex2 = edge.getVerticesIndex()(1);
-  int ref = edge.getIndex();
-  std::string BCType = edge.getBoundaryCondition();
+  if (vertex1 > vertex2)
+    {
+      std::swap(vertex1, vertex2);
+    }
 
   bool exist = false;
   // we look at the list of edges leaving from n1
   // if we find the same edge than n1->n2 we add the edge
   for (int e(headMinv[vertex1]) ; e != -1 ; e = nextEdge[e])
     {
-      if (_edges[e].getVerticesIndex()(1) == vertex2)
+      if (_edgesVertices(e,1) == vertex2)
         {
           if (nc >= 0)
             {
-              _edges[e].addNeighbourCell(nc);
+              addNeighbourCell(e, nc);
             }
           exist = true;
         }
@@ -152,10 +186,15 @@ void Mesh::addEdge(const Edge& edge, int nc, std::vector<int>& headMinv, std::ve
   if (!exist)
     {
       // we initialize the edge
-      _edges[nbEdge] = Edge(vertex1, vertex2, ref, BCType);
+      _edgesVertices(nbEdge,0) = vertex1;
+      _edgesVertices(nbEdge,1) = vertex2;
+      _edgesCells(nbEdge,0) = -1;
+      _edgesCells(nbEdge,1) = -1;
+      _edgesReference(nbEdge) = reference;
+      _edgesBoundaryCondition(nbEdge) = boundaryCondition;
       if (nc >= 0)
         {
-          _edges[nbEdge].addNeighbourCell(nc);
+          addNeighbourCell(nbEdge, nc);
         }
       // we update the arrays next_edge and head_minv
       nextEdge[nbEdge] = headMinv[vertex1];
@@ -167,21 +206,21 @@ void Mesh::addEdge(const Edge& edge, int nc, std::vector<int>& headMinv, std::ve
 // Calcule les centres, les aires et les périmètres des cellules
 void Mesh::buildCellsCenterAndAreaAndPerimeter()
 {
-  _cellsCenter.resize(_numberOfCells,2);
+  _cellsCenter.setZero(_numberOfCells,2);
   _cellsArea.resize(_numberOfCells);
   _cellsPerimeter.resize(_numberOfCells);
   // Boucle sur les cellules
   for (int i(0) ; i < _numberOfCells ; ++i)
     {
       // Récupère les coordonnées des sommets de la cellule
-      const Eigen::VectorXi& verticesIndex(_cells[i].getVerticesIndex());
-      int nbVertices(verticesIndex.size());
+      int nbVertices(_cellsVerticesOffsets(i+1) - _cellsVerticesOffsets(i));
+      const int* verticesIndex(&_cellsVertices(_cellsVerticesOffsets(i)));
       
       // Calcul du centre
       for (int j(0) ; j < nbVertices ; ++j)
         {
-          double x(_vertices[verticesIndex(j)].getCoordinates()[0]);
-          double y(_vertices[verticesIndex(j)].getCoordinates()[1]);
+          double x(_vertices[verticesIndex[j]].getCoordinates()[0]);
+          double y(_vertices[verticesIndex[j]].getCoordinates()[1]);
           _cellsCenter(i,0) += x;
           _cellsCenter(i,1) += y;
         }
@@ -192,10 +231,10 @@ void Mesh::buildCellsCenterAndAreaAndPerimeter()
       // // Pour tout polygone convexe
       // for (int j(0) ; j < nbVertices - 1  ; ++j)
       //   {
-      //     double x1(_vertices[verticesIndex(j)].getCoordinates()[0]);
-      //     double y1(_vertices[verticesIndex(j)].getCoordinates()[1]);
-      //     double x2(_vertices[verticesIndex(j+1)].getCoordinates()[0]);
-      //     double y2(_vertices[verticesIndex(j+1)].getCoordinates()[1]);
+      //     double x1(_vertices[verticesIndex[j]].getCoordinates()[0]);
+      //     double y1(_vertices[verticesIndex[j]].getCoordinates()[1]);
+      //     double x2(_vertices[verticesIndex[j+1]].getCoordinates()[0]);
+      //     double y2(_vertices[verticesIndex[j+1]].getCoordinates()[1]);
       //     _cellsPerimeter(i) += sqrt(pow(x2-x1,2) + pow(y2-y1,2));
       //     _cellsArea(i) += (x2+x1)*(y2-y1);
       //     // Verification de l'aiere
@@ -213,12 +252,12 @@ void Mesh::buildCellsCenterAndAreaAndPerimeter()
       
       // Pour des triangles //
       // Calcul de l'aire
-      double x1(_vertices[verticesIndex(0)].getCoordinates()[0]);
-      double y1(_vertices[verticesIndex(0)].getCoordinates()[1]);
-      double x2(_vertices[verticesIndex(1)].getCoordinates()[0]);
-      double y2(_vertices[verticesIndex(1)].getCoordinates()[1]);
-      double x3(_vertices[verticesIndex(2)].getCoordinates()[0]);
-      double y3(_vertices[verticesIndex(2)].getCoordinates()[1]);
+      double x1(_vertices[verticesIndex[0]].getCoordinates()[0]);
+      double y1(_vertices[verticesIndex[0]].getCoordinates()[1]);
+      double x2(_vertices[verticesIndex[1]].getCoordinates()[0]);
+      double y2(_vertices[verticesIndex[1]].getCoordinates()[1]);
+      double x3(_vertices[verticesIndex[2]].getCoordinates()[0]);
+      double y3(_vertices[verticesIndex[2]].getCoordinates()[1]);
        double l12(sqrt(pow(x1-x2,2) + pow(y1-y2,2)));
        double l13(sqrt(pow(x1-x3,2) + pow(y1-y3,2)));
        double l23(sqrt(pow(x2-x3,2) + pow(y2-y3,2)));
@@ -239,8 +278,8 @@ void Mesh::buildEdgesNormalAndLengthAndCenter()
   for (int i(0) ; i < _numberOfEdges ; ++i)
     {
       // Calcul de la longueur
-      int vertex1(_edges[i].getVerticesIndex()(0));
-      int vertex2(_edges[i].getVerticesIndex()(1));
+      int vertex1(_edgesVertices(i,0));
+      int vertex2(_edgesVertices(i,1));
       double x1(_vertices[vertex1].getCoordinates()(0));
       double y1(_vertices[vertex1].getCoordinates()(1));
       double x2(_vertices[vertex2].getCoordinates()(0));
@@ -252,7 +291,7 @@ void Mesh::buildEdgesNormalAndLengthAndCenter()
       _edgesCenter(i,1) = 0.5 * (y1 + y2);
       
       // Calcul du vecteur (centre de la cellule c1 to centre de l'arête)
-      int c1(_edges[i].getC1());
+      int c1(_edgesCells(i,0));
       Eigen::Vector2d diff(_edgesCenter.row(i) - _cellsCenter.row(c1));
       // Calcul de la normale dans un sens arbitraire
       _edgesNormal(i,0) = y1 - y2;
@@ -269,6 +308,540 @@ void Mesh::buildEdgesNormalAndLengthAndCenter()
     }
 }
 
+// Colorie les arêtes de sorte que deux arêtes d'une même couleur ne touchent
+// jamais la même cellule : les arêtes d'une couleur peuvent alors être traitées
+// en parallèle sans conflit d'écriture dans le vecteur des flux.
+// Coloriage glouton dans l'ordre des arêtes, qui donne au plus
+// 2*(nombre de sommets par cellule) - 1 couleurs.
+void Mesh::buildEdgesColouring()
+{
+  // Couleurs déjà utilisées par les arêtes de chaque cellule (un bit par couleur)
+  std::vector<unsigned int> usedColours(_numberOfCells, 0);
+  std::vector<int> edgeColour(_numberOfEdges);
+  _numberOfEdgeColours = 0;
+
+  for (int i(0) ; i < _numberOfEdges ; ++i)
+    {
+      int c1(_edgesCells(i,0)), c2(_edgesCells(i,1));
+      unsigned int used(usedColours[c1]);
+      if (c2 != -1)
+        {
+          used |= usedColours[c2];
+        }
+      // Plus petite couleur libre
+      int colour(0);
+      while (used & (1u << colour))
+        {
+          ++colour;
+        }
+      edgeColour[i] = colour;
+      usedColours[c1] |= (1u << colour);
+      if (c2 != -1)
+        {
+          usedColours[c2] |= (1u << colour);
+        }
+      _numberOfEdgeColours = std::max(_numberOfEdgeColours, colour + 1);
+    }
+
+  // Regroupe les arêtes par couleur (tri par comptage, l'ordre des arêtes est
+  // conservé à l'intérieur d'une couleur)
+  _edgeColourOffsets.assign(_numberOfEdgeColours + 1, 0);
+  for (int i(0) ; i < _numberOfEdges ; ++i)
+    {
+      ++_edgeColourOffsets[edgeColour[i] + 1];
+    }
+  for (int k(0) ; k < _numberOfEdgeColours ; ++k)
+    {
+      _edgeColourOffsets[k+1] += _edgeColourOffsets[k];
+    }
+  _colouredEdges.resize(_numberOfEdges);
+  std::vector<int> position(_edgeColourOffsets.begin(), _edgeColourOffsets.end() - 1);
+  for (int i(0) ; i < _numberOfEdges ; ++i)
+    {
+      _colouredEdges[position[edgeColour[i]]++] = i;
+    }
+}
+
+// Ordre Reverse Cuthill-McKee des cellules (graphe des cellules voisines par
+// une arête). Chaque composante connexe part de sa cellule de plus petit
+// degré. Renvoie newToOld : newToOld[i] = ancien indice de la i-ème cellule.
+static std::vector<int> reverseCuthillMcKee(int nCells, const Eigen::Matrix<int, Eigen::Dynamic, 2>& edgesCells)
+{
+  // Voisins de chaque cellule (stockage CSR)
+  std::vector<int> offsets(nCells + 1, 0);
+  for (int i(0) ; i < edgesCells.rows() ; ++i)
+    {
+      if (edgesCells(i,1) != -1)
+        {
+          ++offsets[edgesCells(i,0) + 1];
+          ++offsets[edgesCells(i,1) + 1];
+        }
+    }
+  for (int i(0) ; i < nCells ; ++i)
+    {
+      offsets[i+1] += offsets[i];
+    }
+  std::vector<int> neighbours(offsets[nCells]);
+  std::vector<int> position(offsets.begin(), offsets.end() - 1);
+  for (int i(0) ; i < edgesCells.rows() ; ++i)
+    {
+      int c1(edgesCells(i,0)), c2(edgesCells(i,1));
+      if (c2 != -1)
+        {
+          neighbours[position[c1]++] = c2;
+          neighbours[position[c2]++] = c1;
+        }
+    }
+  std::vector<int> degree(nCells);
+  for (int i(0) ; i < nCells ; ++i)
+    {
+      degree[i] = offsets[i+1] - offsets[i];
+    }
+  auto byDegree = [&degree](int a, int b) {return degree[a] < degree[b] || (degree[a] == degree[b] && a < b);};
+
+  // Cellules par degré croissant (points de départ des composantes connexes)
+  std::vector<int> starts(nCells);
+  for (int i(0) ; i < nCells ; ++i)
+    {
+      starts[i] = i;
+    }
+  std::sort(starts.begin(), starts.end(), byDegree);
+
+  // Parcours en largeur, les voisins étant visités par degré croissant
+  std::vector<int> order;
+  order.reserve(nCells);
+  std::vector<bool> visited(nCells, false);
+  for (int k(0) ; k < nCells ; ++k)
+    {
+      if (visited[starts[k]])
+        continue;
+      visited[starts[k]] = true;
+      order.push_back(starts[k]);
+      for (std::size_t head(order.size() - 1) ; head < order.size() ; ++head)
+        {
+          int c(order[head]);
+          int first(order.size());
+          for (int j(offsets[c]) ; j < offsets[c+1] ; ++j)
+            {
+              if (!visited[neighbours[j]])
+                {
+                  visited[neighbours[j]] = true;
+                  order.push_back(neighbours[j]);
+                }
+            }
+          std::sort(order.begin() + first, order.end(), byDegree);
+        }
+    }
+  std::reverse(order.begin(), order.end());
+  return order;
+}
+
+// Indice d'un point (x,y) d'une grille n x n (n puissance de 2) le long
+// de la courbe de Hilbert
+static long long hilbertIndex(unsigned int n, unsigned int x, unsigned int y)
+{
+  long long d(0);
+  for (unsigned int s(n/2) ; s > 0 ; s /= 2)
+    {
+      unsigned int rx((x & s) > 0), ry((y & s) > 0);
+      d += (long long)s * s * ((3 * rx) ^ ry);
+      // Rotation du quadrant
+      if (ry == 0)
+        {
+          if (rx == 1)
+            {
+              x = n - 1 - x;
+              y = n - 1 - y;
+            }
+          std::swap(x, y);
+        }
+    }
+  return d;
+}
+
+// Ordre des cellules le long d'une courbe de Hilbert passant par leurs
+// centres. Renvoie newToOld comme reverseCuthillMcKee.
+static std::vector<int> hilbertCurve(const Eigen::VectorXi& cellsVerticesOffsets, const Eigen::VectorXi& cellsVertices,
+                                     const std::vector<Vertex>& vertices)
+{
+  int nCells(cellsVerticesOffsets.size() - 1);
+  // Centres des cellules et boîte englobante
+  Eigen::Matrix<double, Eigen::Dynamic, 2> centers(nCells, 2);
+  for (int i(0) ; i < nCells ; ++i)
+    {
+      Eigen::Vector2d center(0., 0.);
+      for (int j(cellsVerticesOffsets(i)) ; j < cellsVerticesOffsets(i+1) ; ++j)
+        {
+          center += vertices[cellsVertices(j)].getCoordinates();
+        }
+      centers.row(i) = center / (cellsVerticesOffsets(i+1) - cellsVerticesOffsets(i));
+    }
+  Eigen::Vector2d lower(centers.colwise().minCoeff()), upper(centers.colwise().maxCoeff());
+  double width(std::max(upper(0) - lower(0), upper(1) - lower(1)));
+  if (width <= 0.)
+    width = 1.;
+
+  // Position de chaque centre sur une grille 2^16 x 2^16
+  const unsigned int n(1u << 16);
+  std::vector<long long> key(nCells);
+  for (int i(0) ; i < nCells ; ++i)
+    {
+      unsigned int x(std::min((n - 1.) * (centers(i,0) - lower(0)) / width, n - 1.));
+      unsigned int y(std::min((n - 1.) * (centers(i,1) - lower(1)) / width, n - 1.));
+      key[i] = hilbertIndex(n, x, y);
+    }
+
+  std::vector<int> order(nCells);
+  for (int i(0) ; i < nCells ; ++i)
+    {
+      order[i] = i;
+    }
+  std::sort(order.begin(), order.end(), [&key](int a, int b) {return key[a] < key[b] || (key[a] == key[b] && a < b);});
+  return order;
+}
+
+// Plus petite et plus grande cellule voisine d'une arête (-1 pour une arête de bord)
+static void sortedEdgeCells(const Eigen::Matrix<int, Eigen::Dynamic, 2>& edgesCells, int i, int& c1, int& c2)
+{
+  c1 = edgesCells(i,0);
+  c2 = edgesCells(i,1);
+  if (c2 != -1 && c2 < c1)
+    std::swap(c1, c2);
+}
+
+// Renumérote les cellules (Reverse Cuthill-McKee ou courbe de Hilbert) puis
+// trie les arêtes par leur plus petite cellule voisine, pour que les cellules lues dans la
+// boucle sur les arêtes soient proches en mémoire. L'ordre du fichier de
+// maillage est gardé dans _cellsFileOrder pour les sorties.
+void Mesh::renumberCellsAndEdges()
+{
+  _cellsFileOrder.resize(_numberOfCells);
+  for (int i(0) ; i < _numberOfCells ; ++i)
+    {
+      _cellsFileOrder[i] = i;
+    }
+
+  std::vector<int> newToOld;
+  switch (_DF->getRunPlan().meshRenumbering)
+    {
+    case MeshRenumberingType::None:
+      return;
+    case MeshRenumberingType::RCM:
+      newToOld = reverseCuthillMcKee(_numberOfCells, _edgesCells);
+      break;
+    case MeshRenumberingType::Hilbert:
+      newToOld = hilbertCurve(_cellsVerticesOffsets, _cellsVertices, _vertices);
+      break;
+    }
+
+  // Permutation des cellules
+  Eigen::VectorXi offsets(_numberOfCells + 1), vertices(_cellsVertices.size()), reference(_numberOfCells);
+  offsets(0) = 0;
+  for (int i(0) ; i < _numberOfCells ; ++i)
+    {
+      int c(newToOld[i]);
+      int nbVertices(_cellsVerticesOffsets(c+1) - _cellsVerticesOffsets(c));
+      offsets(i+1) = offsets(i) + nbVertices;
+      vertices.segment(offsets(i), nbVertices) = _cellsVertices.segment(_cellsVerticesOffsets(c), nbVertices);
+      reference(i) = _cellsReference(c);
+      _cellsFileOrder[c] = i;
+    }
+  _cellsVerticesOffsets.swap(offsets);
+  _cellsVertices.swap(vertices);
+  _cellsReference.swap(reference);
+
+  // Nouveaux indices des cellules voisines des arêtes. L'orientation des
+  // arêtes (c1 -> c2) est gardée : le flux de Rusanov en dépend.
+  for (int i(0) ; i < _numberOfEdges ; ++i)
+    {
+      _edgesCells(i,0) = _cellsFileOrder[_edgesCells(i,0)];
+      if (_edgesCells(i,1) != -1)
+        {
+          _edgesCells(i,1) = _cellsFileOrder[_edgesCells(i,1)];
+        }
+    }
+
+  // Tri des arêtes
+  std::vector<int> order(_numberOfEdges);
+  for (int i(0) ; i < _numberOfEdges ; ++i)
+    {
+      order[i] = i;
+    }
+  const Eigen::Matrix<int, Eigen::Dynamic, 2>& edgesCells(_edgesCells);
+  std::stable_sort(order.begin(), order.end(), [&edgesCells](int a, int b)
+                   {
+                     int a1, a2, b1, b2;
+                     sortedEdgeCells(edgesCells, a, a1, a2);
+                     sortedEdgeCells(edgesCells, b, b1, b2);
+                     return a1 < b1 || (a1 == b1 && a2 < b2);
+                   });
+  Eigen::Matrix<int, Eigen::Dynamic, 2> edgesVertices(_numberOfEdges, 2), edgesCellsSorted(_numberOfEdges, 2);
+  Eigen::VectorXi edgesReference(_numberOfEdges), edgesBoundaryCondition(_numberOfEdges);
+  for (int i(0) ; i < _numberOfEdges ; ++i)
+    {
+      edgesVertices.row(i) = _edgesVertices.row(order[i]);
+      edgesCellsSorted.row(i) = _edgesCells.row(order[i]);
+      edgesReference(i) = _edgesReference(order[i]);
+      edgesBoundaryCondition(i) = _edgesBoundaryCondition(order[i]);
+    }
+  _edgesVertices.swap(edgesVertices);
+  _edgesCells.swap(edgesCellsSorted);
+  _edgesReference.swap(edgesReference);
+  _edgesBoundaryCondition.swap(edgesBoundaryCondition);
+}
+
+// Lit les cellules (toutes avec _numberOfVerticesPerCell sommets)
+void Mesh::readCells(std::ifstream& meshStream)
+{
+  meshStream >> _numberOfCells;
+  _cellsVerticesOffsets.resize(_numberOfCells + 1);
+  _cellsVertices.resize(_numberOfVerticesPerCell * _numberOfCells);
+  _cellsReference.resize(_numberOfCells);
+  for (int i(0) ; i < _numberOfCells ; ++i)
+    {
+      _cellsVerticesOffsets(i) = i * _numberOfVerticesPerCell;
+      for (int j(0) ; j < _numberOfVerticesPerCell ; ++j)
+        {
+          meshStream >> _cellsVertices(i * _numberOfVerticesPerCell + j);
+          --_cellsVertices(i * _numberOfVerticesPerCell + j);
+        }
+      meshStream >> _cellsReference(i);
+    }
+  _cellsVerticesOffsets(_numberOfCells) = _numberOfVerticesPerCell * _numberOfCells;
+}
+
+//-----------------------------------------------------------//
+//---------------------Binary mesh cache---------------------//
+//-----------------------------------------------------------//
+// Le cache contient le maillage entièrement construit (sommets, cellules,
+// arêtes et leurs voisines, normales, longueurs, aires, coloriage). Il est
+// valide tant que la clé (hash du fichier de maillage et des options qui
+// changent la construction) et la version sont les mêmes. Incrémenter
+// meshCacheVersion à chaque changement du contenu du cache.
+static const int meshCacheVersion = 1;
+
+struct MeshCacheHeader
+{
+  char magic[8];
+  int version;
+  int numberOfVerticesPerCell;
+  unsigned long long key;
+  int numberOfVertices;
+  int numberOfCells;
+  int numberOfEdges;
+  int numberOfEdgeColours;
+};
+
+// Hash FNV-1a 64 bits
+static unsigned long long fnv1a(const void* data, size_t size, unsigned long long hash = 14695981039346656037ULL)
+{
+  const unsigned char* bytes(static_cast<const unsigned char*>(data));
+  for (size_t i(0) ; i < size ; ++i)
+    {
+      hash ^= bytes[i];
+      hash *= 1099511628211ULL;
+    }
+  return hash;
+}
+
+// Fichier projeté en mémoire (lecture seule)
+class MappedFile
+{
+private:
+  int _fd;
+  size_t _size;
+  const char* _data;
+
+public:
+  MappedFile(const std::string& fileName):
+    _fd(open(fileName.c_str(), O_RDONLY)), _size(0), _data(0)
+  {
+    struct stat status;
+    if (_fd == -1 || fstat(_fd, &status) != 0 || status.st_size == 0)
+      return;
+    void* data(mmap(0, status.st_size, PROT_READ, MAP_PRIVATE, _fd, 0));
+    if (data == MAP_FAILED)
+      return;
+    _size = status.st_size;
+    _data = static_cast<const char*>(data);
+  }
+
+  ~MappedFile()
+  {
+    if (_data)
+      munmap(const_cast<char*>(_data), _size);
+    if (_fd != -1)
+      close(_fd);
+  }
+
+  bool isOpen() const {return _data != 0;};
+  size_t size() const {return _size;};
+  const char* data() const {return _data;};
+};
+
+// Lecture séquentielle d'un tableau dans le cache (false si le fichier est trop court)
+static bool readArray(const MappedFile& file, size_t& position, void* data, size_t size)
+{
+  if (position + size > file.size())
+    return false;
+  memcpy(data, file.data() + position, size);
+  position += size;
+  return true;
+}
+
+static void writeArray(std::ofstream& output, const void* data, size_t size)
+{
+  output.write(static_cast<const char*>(data), size);
+}
+
+// Clé du cache : contenu du fichier de maillage, renumérotation et
+// conditions aux limites (qui donnent les indices de CL des arêtes)
+unsigned long long Mesh::computeCacheKey() const
+{
+  MappedFile meshFile(_meshFile);
+  unsigned long long key(fnv1a(meshFile.data(), meshFile.size()));
+  MeshRenumberingType renumbering(_DF->getRunPlan().meshRenumbering);
+  key = fnv1a(&renumbering, sizeof(renumbering), key);
+  for (int i(0) ; i < _boundaryConditionReference.size() ; ++i)
+    {
+      key = fnv1a(&_boundaryConditionReference(i), sizeof(int), key);
+      key = fnv1a(_boundaryConditionType[i].data(), _boundaryConditionType[i].size() + 1, key);
+    }
+  return key;
+}
+
+// Charge le maillage depuis le cache. Renvoie false si le cache n'existe pas
+// ou ne correspond pas (clé, version, taille)
+bool Mesh::readCache(const std::string& cacheFile, unsigned long long key)
+{
+  MappedFile file(cacheFile);
+  if (!file.isOpen())
+    return false;
+
+  size_t position(0);
+  MeshCacheHeader header;
+  if (!readArray(file, position, &header, sizeof(header))
+      || strncmp(header.magic, "TERMESH", 8) != 0 || header.version != meshCacheVersion || header.key != key)
+    return false;
+
+  _numberOfVerticesPerCell = header.numberOfVerticesPerCell;
+  _cellType = (_numberOfVerticesPerCell == 3 ? "Triangles" : "Quadrilaterals");
+  _numberOfVertices = header.numberOfVertices;
+  _numberOfCells = header.numberOfCells;
+  _numberOfEdges = header.numberOfEdges;
+  _numberOfEdgeColours = header.numberOfEdgeColours;
+
+  // Sommets
+  Eigen::Matrix<double, Eigen::Dynamic, 2> coordinates(_numberOfVertices, 2);
+  Eigen::VectorXi verticesIndex(_numberOfVertices);
+  // Cellules
+  _cellsVerticesOffsets.resize(_numberOfCells + 1);
+  _cellsReference.resize(_numberOfCells);
+  _cellsFileOrder.resize(_numberOfCells);
+  _cellsCenter.resize(_numberOfCells, 2);
+  _cellsArea.resize(_numberOfCells);
+  _cellsPerimeter.resize(_numberOfCells);
+  // Arêtes
+  _edgesVertices.resize(_numberOfEdges, 2);
+  _edgesCells.resize(_numberOfEdges, 2);
+  _edgesReference.resize(_numberOfEdges);
+  _edgesBoundaryCondition.resize(_numberOfEdges);
+  _edgesCenter.resize(_numberOfEdges, 2);
+  _edgesNormal.resize(_numberOfEdges, 2);
+  _edgesLength.resize(_numberOfEdges);
+  _edgeColourOffsets.resize(_numberOfEdgeColours + 1);
+  _colouredEdges.resize(_numberOfEdges);
+
+  bool ok(readArray(file, position, coordinates.data(), coordinates.size() * sizeof(double))
+          && readArray(file, position, verticesIndex.data(), verticesIndex.size() * sizeof(int))
+          && readArray(file, position, _cellsVerticesOffsets.data(), _cellsVerticesOffsets.size() * sizeof(int)));
+  if (!ok)
+    return false;
+  _cellsVertices.resize(_cellsVerticesOffsets(_numberOfCells));
+  ok = (readArray(file, position, _cellsVertices.data(), _cellsVertices.size() * sizeof(int))
+        && readArray(file, position, _cellsReference.data(), _cellsReference.size() * sizeof(int))
+        && readArray(file, position, _cellsFileOrder.data(), _cellsFileOrder.size() * sizeof(int))
+        && readArray(file, position, _cellsCenter.data(), _cellsCenter.size() * sizeof(double))
+        && readArray(file, position, _cellsArea.data(), _cellsArea.size() * sizeof(double))
+        && readArray(file, position, _cellsPerimeter.data(), _cellsPerimeter.size() * sizeof(double))
+        && readArray(file, position, _edgesVertices.data(), _edgesVertices.size() * sizeof(int))
+        && readArray(file, position, _edgesCells.data(), _edgesCells.size() * sizeof(int))
+        && readArray(file, position, _edgesReference.data(), _edgesReference.size() * sizeof(int))
+        && readArray(file, position, _edgesBoundaryCondition.data(), _edgesBoundaryCondition.size() * sizeof(int))
+        && readArray(file, position, _edgesCenter.data(), _edgesCenter.size() * sizeof(double))
+        && readArray(file, position, _edgesNormal.data(), _edgesNormal.size() * sizeof(double))
+        && readArray(file, position, _edgesLength.data(), _edgesLength.size() * sizeof(double))
+        && readArray(file, position, _edgeColourOffsets.data(), _edgeColourOffsets.size() * sizeof(int))
+        && readArray(file, position, _colouredEdges.data(), _colouredEdges.size() * sizeof(int)));
+  if (!ok || position != file.size())
+    return false;
+
+  _vertices.resize(_numberOfVertices);
+  for (int i(0) ; i < _numberOfVertices ; ++i)
+    {
+      _vertices[i] = Vertex(coordinates(i,0), coordinates(i,1), verticesIndex(i));
+    }
+  return true;
+}
+
+// Écrit le cache. Le fichier est d'abord écrit sous un nom temporaire puis
+// renommé, pour qu'une autre exécution ne lise jamais un cache incomplet.
+void Mesh::writeCache(const std::string& cacheFile, unsigned long long key) const
+{
+  MeshCacheHeader header;
+  memset(&header, 0, sizeof(header));
+  strncpy(header.magic, "TERMESH", 8);
+  header.version = meshCacheVersion;
+  header.numberOfVerticesPerCell = _numberOfVerticesPerCell;
+  header.key = key;
+  header.numberOfVertices = _numberOfVertices;
+  header.numberOfCells = _numberOfCells;
+  header.numberOfEdges = _numberOfEdges;
+  header.numberOfEdgeColours = _numberOfEdgeColours;
+
+  Eigen::Matrix<double, Eigen::Dynamic, 2> coordinates(_numberOfVertices, 2);
+  Eigen::VectorXi verticesIndex(_numberOfVertices);
+  for (int i(0) ; i < _numberOfVertices ; ++i)
+    {
+      coordinates.row(i) = _vertices[i].getCoordinates();
+      verticesIndex(i) = _vertices[i].getIndex();
+    }
+
+  std::string tmpFile(cacheFile + ".tmp" + std::to_string(getpid()));
+  std::ofstream output(tmpFile, std::ios::out | std::ios::binary);
+  writeArray(output, &header, sizeof(header));
+  writeArray(output, coordinates.data(), coordinates.size() * sizeof(double));
+  writeArray(output, verticesIndex.data(), verticesIndex.size() * sizeof(int));
+  writeArray(output, _cellsVerticesOffsets.data(), _cellsVerticesOffsets.size() * sizeof(int));
+  writeArray(output, _cellsVertices.data(), _cellsVertices.size() * sizeof(int));
+  writeArray(output, _cellsReference.data(), _cellsReference.size() * sizeof(int));
+  writeArray(output, _cellsFileOrder.data(), _cellsFileOrder.size() * sizeof(int));
+  writeArray(output, _cellsCenter.data(), _cellsCenter.size() * sizeof(double));
+  writeArray(output, _cellsArea.data(), _cellsArea.size() * sizeof(double));
+  writeArray(output, _cellsPerimeter.data(), _cellsPerimeter.size() * sizeof(double));
+  writeArray(output, _edgesVertices.data(), _edgesVertices.size() * sizeof(int));
+  writeArray(output, _edgesCells.data(), _edgesCells.size() * sizeof(int));
+  writeArray(output, _edgesReference.data(), _edgesReference.size() * sizeof(int));
+  writeArray(output, _edgesBoundaryCondition.data(), _edgesBoundaryCondition.size() * sizeof(int));
+  writeArray(output, _edgesCenter.data(), _edgesCenter.size() * sizeof(double));
+  writeArray(output, _edgesNormal.data(), _edgesNormal.size() * sizeof(double));
+  writeArray(output, _edgesLength.data(), _edgesLength.size() * sizeof(double));
+  writeArray(output, _edgeColourOffsets.data(), _edgeColourOffsets.size() * sizeof(int));
+  writeArray(output, _colouredEdges.data(), _colouredEdges.size() * sizeof(int));
+  output.close();
+
+  if (!output || std::rename(tmpFile.c_str(), cacheFile.c_str()) != 0)
+    {
+      std::remove(tmpFile.c_str());
+      std::cout << termcolor::yellow << "WARNING::MESH : Unable to write the mesh cache : " << cacheFile << std::endl;
+      std::cout << termcolor::reset;
+    }
+  else
+    {
+      std::cout << "Mesh cache written : " << cacheFile << std::endl;
+    }
+}
+
 // Build the mesh from the mesh file
 void Mesh::Initialize()
 {
@@ -283,14 +856,28 @@ void Mesh::Initialize()
       std::cout << termcolor::reset << "====================================================================================================" << std::endl;
       exit(-1);
     }
-  else
+
+  // Maillage déjà construit lors d'une exécution précédente
+  std::string cacheFile(_meshFile + ".cache");
+  unsigned long long cacheKey(0);
+  if (_DF->getRunPlan().useMeshCache)
     {
-      std::cout << "Generating a 2D mesh from file : " << _meshFile << std::endl;
+      cacheKey = computeCacheKey();
+      if (readCache(cacheFile, cacheKey))
+        {
+          std::cout << "Loading the 2D mesh from cache : " << cacheFile << std::endl;
+          std::cout << termcolor::green << "SUCCESS::MESH : Mesh loaded succesfully !" << std::endl;
+          std::cout << termcolor::reset << "====================================================================================================" << std::endl << std::endl;
+          return;
+        }
     }
 
+  std::cout << "Generating a 2D mesh from file : " << _meshFile << std::endl;
+
   std::string line;
   int dimension(3), nBoundaryEdges(0);
-  std::vector<Edge> boundaryEdges;
+  // Arêtes de bord : sommets, référence et condition aux limites
+  Eigen::Matrix<int, Eigen::Dynamic, 4> boundaryEdges;
 
   // Parcours les lignes du fichier de maillage
   while (getline(meshStream, line))
@@ -317,28 +904,28 @@ void Mesh::Initialize()
       else if (line.find("Edges") != std::string::npos)
         {
           meshStream >> nBoundaryEdges;
-          boundaryEdges.resize(nBoundaryEdges);
+          boundaryEdges.resize(nBoundaryEdges, 4);
           for (int i(0) ; i < nBoundaryEdges ; ++i)
             {
               int vertex1(0), vertex2(0);
               int index(0);
               meshStream >> vertex1 >> vertex2 >> index;
               --vertex1; --vertex2;
-              std::string BCType("none");
+              int BC(-1);
               for (int i(0) ; i < _boundaryConditionReference.size() ; ++i)
                 {
                   if (index == _boundaryConditionReference[i])
                     {
-                      BCType = _boundaryConditionType[i];
+                      BC = i;
                     }
                 }
-              if (BCType == "none")
+              if (BC == -1)
                 {
                   std::cout << termcolor::red << "ERROR::MESH : Problem with boundary conditions in your mesh (reference or types are wrong)" << std::endl;
                   std::cout << termcolor::reset;
                   exit(-1);
                 }
-              boundaryEdges[i] = Edge(vertex1, vertex2, index, BCType);
+              boundaryEdges.row(i) << vertex1, vertex2, index, BC;
             }
         }
       // Création des cellules du maillage
@@ -347,40 +934,18 @@ void Mesh::Initialize()
         {
           _numberOfVerticesPerCell = 3;
           _cellType = "Triangles";
-          meshStream >> _numberOfCells;
-          _cells.resize(_numberOfCells);
-          for (int i(0) ; i < _numberOfCells ; ++i)
-            {
-              Eigen::Vector3i verticesIndex;
-              int vertex1, vertex2, vertex3;
-              int index;
-              meshStream >> vertex1 >> vertex2 >> vertex3 >> index;
-              --vertex1; --vertex2; --vertex3;
-              verticesIndex << vertex1, vertex2, vertex3;
-              _cells[i] = Cell(verticesIndex, index);
-            }
+          readCells(meshStream);
         }
       // Quadrilatères
       else if (line.find("Quadrilaterals") != std::string::npos)
         {
           _numberOfVerticesPerCell = 4;
           _cellType = "Quadrilaterals";
-          meshStream >> _numberOfCells;
-          _cells.resize(_numberOfCells);
-          for (int i(0) ; i < _numberOfCells ; ++i)
-            {
-              Eigen::Vector4i verticesIndex;
-              int vertex1, vertex2, vertex3, vertex4;
-              int index;
-              meshStream >> vertex1 >> vertex2 >> vertex3 >> vertex4 >> index;
-              --vertex1; --vertex2; --vertex3, --vertex4;
-              verticesIndex << vertex1, vertex2, vertex3, vertex4;
-              _cells[i] = Cell(verticesIndex, index);
-            }
+          readCells(meshStream);
         }
     }
 
-  // Création du vecteur _edges.
+  // Création des tableaux des arêtes
   if (_cellType == "Triangles")
     {
       _numberOfEdges = (3*_numberOfCells + nBoundaryEdges)/2; 
@@ -395,7 +960,10 @@ void Mesh::Initialize()
       std::cout << termcolor::reset << "Supported types : Triangles, Quadrilaterals" << std::endl;
       std::cout << "====================================================================================================" << std::endl << std::endl;
     }
-  _edges.resize(_numberOfEdges);
+  _edgesVertices.resize(_numberOfEdges, 2);
+  _edgesCells.resize(_numberOfEdges, 2);
+  _edgesReference.resize(_numberOfEdges);
+  _edgesBoundaryCondition.resize(_numberOfEdges);
 
   std::vector<int> headMinv(_numberOfVertices, -1);
   std::vector<int> nextEdge(_numberOfEdges, -1);
@@ -404,22 +972,28 @@ void Mesh::Initialize()
   int nbEdges(0);
   for (int i(0) ; i < nBoundaryEdges ; ++i)
     {
-      addEdge(boundaryEdges[i], -1, headMinv, nextEdge, nbEdges);
+      addEdge(boundaryEdges(i,0), boundaryEdges(i,1), boundaryEdges(i,2), boundaryEdges(i,3), -1, headMinv, nextEdge, nbEdges);
     }
 
   // Ajout des arêtes intérieures
   for (int i(0); i < _numberOfCells; i++)
     {
-      const Eigen::VectorXi& nv(_cells[i].getVerticesIndex());
+      const int* nv(&_cellsVertices(_cellsVerticesOffsets(i)));
       for (int j = 0; j < _numberOfVerticesPerCell; j++)
         {
-          Edge edge(nv(j), nv((j+1)%_numberOfVerticesPerCell), 0, "none");
-          addEdge(edge, i, headMinv, nextEdge, nbEdges);
+          addEdge(nv[j], nv[(j+1)%_numberOfVerticesPerCell], 0, -1, i, headMinv, nextEdge, nbEdges);
         }
     }
 
+  renumberCellsAndEdges();
   buildCellsCenterAndAreaAndPerimeter();
   buildEdgesNormalAndLengthAndCenter();
+  buildEdgesColouring();
+
+  if (_DF->getRunPlan().useMeshCache)
+    {
+      writeCache(cacheFile, cacheKey);
+    }
   
   std::cout << termcolor::green << "SUCCESS::MESH : Mesh generated succesfully !" << std::endl;
   std::cout << termcolor::reset << "====================================================================================================" << std::endl << std::endl;
@@ -435,5 +1009,6 @@ void Mesh::printParameters() const
   std::cout << "Number of edges     = " << _numberOfEdges << std::endl;
   std::cout << "Number of Cells     = " << _numberOfCells << std::endl;
   std::cout << "Cells type          = " << _cellType << std::endl;
+  std::cout << "Edge colours        = " << _numberOfEdgeColours << std::endl;
   std::cout << "====================================================================================================" << std::endl << std::endl;
 }
@@ -62,58 +62,38 @@ public:
 };
 
 
+class Mesh;
+
 //-----------------------------------------------//
 //---------------------Edges---------------------//
 //-----------------------------------------------//
+// Vue sur une arête du maillage. Les données sont stockées dans les
+// tableaux de Mesh, ce petit objet ne contient que l'indice de l'arête.
 class Edge
 {
 private:
-  // Indice de l'arête
-  int _index;
-  // Références des cellules adjacentes à l'arête
-  int _c1, _c2;
-  // Longueur de l'arête
-  double _edgeLength;
-  // Type de condition aux limites : Dirichlet, Neumann ou None (si arête intérieure)
-  std::string _boundaryCondition;
-  
-  // Références des sommets de l'arête
-  Eigen::Vector2i _verticesIndex;
-  // Normale unitaire à l'arête
-  Eigen::Vector2d _edgeNormal;
-  // Coordonnées du centre de l'arête
-  Eigen::Vector2d _edgeCenter;
+  // Maillage et numéro de l'arête
+  const Mesh* _mesh;
+  int _edge;
 
 public:
   // Constructeurs
   Edge();
-  Edge(int vertex1, int vertex2, int index, std::string boundaryCondition);
+  Edge(const Mesh* mesh, int edge);
   
   // Destructeur
   ~Edge() = default;
 
   // Getters
-  int getIndex() const {return _index;};
-  int getC1() const {return _c1;};
-  int getC2() const {return _c2;};
-  double getLength() const {return _edgeLength;};
-  const Eigen::Vector2i& getVerticesIndex() const {return _verticesIndex;};
-  const Eigen::Vector2d& getNormal() const {return _edgeNormal;};
-  const Eigen::Vector2d& getCenter() const {return _edgeCenter;};
-  const std::string& getBoundaryCondition() const {return _boundaryCondition;};
-
-  // Add neighbour triangle
-  void addNeighbourCell(int c)
-  {
-    if (_c1 == -1)
-      {
-        _c1 = c;
-      }
-    else
-      {
-        _c2 = c;
-      }
-  }
+  int getIndex() const;
+  int getC1() const;
+  int getC2() const;
+  double getLength() const;
+  Eigen::Vector2i getVerticesIndex() const;
+  Eigen::Vector2d getNormal() const;
+  Eigen::Vector2d getCenter() const;
+  int getBoundaryConditionID() const;
+  const std::string& getBoundaryCondition() const;
   
   // Printer (for debugging purposes)
   void print() const;
@@ -123,34 +103,28 @@ public:
 //------------------------------------------------------------//
 //---------------------Generic Cell class---------------------//
 //------------------------------------------------------------//
+// Vue sur une cellule du maillage (voir Edge)
 class Cell
 {
 private:
-  // Indice de la cellule
-  int _index;
-    // Nombre de sommets
-  int _nbVertices;
-  // Aire de la cellule
-  double _area;
-  // Indices des sommets
-  Eigen::VectorXi _verticesIndex;
-  // Coordonnées du centre de gravité
-  Eigen::Vector2d _center;
+  // Maillage et numéro de la cellule
+  const Mesh* _mesh;
+  int _cell;
 
 public:
   // Constructeurs
   Cell();
-  Cell(const Eigen::VectorXi& verticesIndex, int index);
+  Cell(const Mesh* mesh, int cell);
 
   // Destructeur
   ~Cell() = default;
 
   // Getters
-  int getIndex() const {return _index;};
-  int getNumberOfVertices() const {return _nbVertices;};
-  double getArea() const {return _area;};
-  const Eigen::VectorXi& getVerticesIndex() const {return _verticesIndex;};
-  const Eigen::Vector2d& getCenter() const {return _center;};
+  int getIndex() const;
+  int getNumberOfVertices() const;
+  double getArea() const;
+  Eigen::VectorXi::ConstSegmentReturnType getVerticesIndex() const;
+  Eigen::Vector2d getCenter() const;
 
   // Printer (for debugging purposes=)
   void print() const;
@@ -175,18 +149,40 @@ private:
   int _numberOfCells;
   int _numberOfVerticesPerCell;
   std::string _cellType;
-  std::vector<Cell> _cells;
+  // Sommets des cellules au format CSR : les sommets de la cellule i sont
+  // _cellsVertices(_cellsVerticesOffsets(i)) ... _cellsVertices(_cellsVerticesOffsets(i+1)-1)
+  Eigen::VectorXi _cellsVerticesOffsets;
+  Eigen::VectorXi _cellsVertices;
+  // Référence des cellules dans le fichier de maillage
+  Eigen::VectorXi _cellsReference;
+  // _cellsFileOrder[i] = indice de la i-ème cellule du fichier de maillage
+  // (différent de i si les cellules ont été renumérotées)
+  std::vector<int> _cellsFileOrder;
   Eigen::Matrix<double, Eigen::Dynamic, 2> _cellsCenter;
   Eigen::VectorXd _cellsArea;
   Eigen::VectorXd _cellsPerimeter;
 
   // Arêtes
   int _numberOfEdges; 
-  std::vector<Edge> _edges;
+  // Sommets (le plus petit indice en premier) et cellules voisines (c1, c2)
+  // de chaque arête. c2 = -1 pour une arête de bord.
+  Eigen::Matrix<int, Eigen::Dynamic, 2> _edgesVertices;
+  Eigen::Matrix<int, Eigen::Dynamic, 2> _edgesCells;
+  // Référence des arêtes de bord dans le fichier de maillage (0 à l'intérieur)
+  Eigen::VectorXi _edgesReference;
+  // Condition aux limites : indice dans _boundaryConditionType, -1 à l'intérieur
+  Eigen::VectorXi _edgesBoundaryCondition;
   Eigen::Matrix<double, Eigen::Dynamic, 2> _edgesCenter;
   Eigen::Matrix<double, Eigen::Dynamic, 2> _edgesNormal;
   Eigen::VectorXd _edgesLength;
 
+  // Coloriage des arêtes : deux arêtes d'une même couleur n'ont aucune
+  // cellule en commun. Les arêtes de la couleur k sont
+  // _colouredEdges[_edgeColourOffsets[k]] ... _colouredEdges[_edgeColourOffsets[k+1]-1]
+  int _numberOfEdgeColours;
+  std::vector<int> _edgeColourOffsets;
+  std::vector<int> _colouredEdges;
+
   // Conditions aux limites
   Eigen::VectorXi _boundaryConditionReference;
   std::vector<std::string> _boundaryConditionType;
@@ -216,28 +212,66 @@ public:
   int getNumberOfCells() const {return _numberOfCells;};
   int getNumberOfVerticesPerCell() const {return _numberOfVerticesPerCell;};
   const std::string& getCellType() const {return _cellType;};
-  const std::vector<Cell>& getCells() const {return _cells;};
+  Cell getCell(int i) const {return Cell(this, i);};
+  const Eigen::VectorXi& getCellsVerticesOffsets() const {return _cellsVerticesOffsets;};
+  const Eigen::VectorXi& getCellsVertices() const {return _cellsVertices;};
+  const Eigen::VectorXi& getCellsReference() const {return _cellsReference;};
+  const std::vector<int>& getCellsFileOrder() const {return _cellsFileOrder;};
   const Eigen::Matrix<double, Eigen::Dynamic, 2>& getCellsCenter() const {return _cellsCenter;};
   const Eigen::VectorXd& getCellsArea() const {return _cellsArea;};
   const Eigen::VectorXd& getCellsPerimeter() const {return _cellsPerimeter;};
 
   // Edges
   int getNumberOfEdges() const {return _numberOfEdges;};
-  const std::vector<Edge>& getEdges() const {return _edges;};
+  Edge getEdge(int i) const {return Edge(this, i);};
+  const Eigen::Matrix<int, Eigen::Dynamic, 2>& getEdgesVertices() const {return _edgesVertices;};
+  const Eigen::Matrix<int, Eigen::Dynamic, 2>& getEdgesCells() const {return _edgesCells;};
+  const Eigen::VectorXi& getEdgesReference() const {return _edgesReference;};
+  const Eigen::VectorXi& getEdgesBoundaryCondition() const {return _edgesBoundaryCondition;};
   const Eigen::Matrix<double, Eigen::Dynamic, 2>& getEdgesCenter() const {return _edgesCenter;};
   const Eigen::Matrix<double, Eigen::Dynamic, 2>& getEdgesNormal() const {return _edgesNormal;};
   const Eigen::VectorXd& getEdgesLength() const {return _edgesLength;};
 
+  // Edge colouring
+  int getNumberOfEdgeColours() const {return _numberOfEdgeColours;};
+  const std::vector<int>& getEdgeColourOffsets() const {return _edgeColourOffsets;};
+  const std::vector<int>& getColouredEdges() const {return _colouredEdges;};
+
+  // Boundary conditions
+  const std::vector<std::string>& getBoundaryConditionType() const {return _boundaryConditionType;};
+
   // Useful methods
   void buildCellsCenterAndAreaAndPerimeter();
   void buildEdgesNormalAndLengthAndCenter();
+  void buildEdgesColouring();
+  void renumberCellsAndEdges();
+
+  // Binary cache of the built mesh
+  unsigned long long computeCacheKey() const;
+  bool readCache(const std::string& cacheFile, unsigned long long key);
+  void writeCache(const std::string& cacheFile, unsigned long long key) const;
   
   // Printer (for information purposes)
   void printParameters() const;
 
 protected:
+  // Read the cells of the mesh file
+  void readCells(std::ifstream& meshStream);
   // Add an Edge (must not be public for obvious reasons)
-  void addEdge(const Edge& edge, int nt, std::vector<int>& headMinv, std::vector<int>& nextEdge, int& nbEdge);
+  void addEdge(int vertex1, int vertex2, int reference, int boundaryCondition, int nc,
+               std::vector<int>& headMinv, std::vector<int>& nextEdge, int& nbEdge);
+  // Add a neighbour cell to an edge
+  void addNeighbourCell(int edge, int c)
+  {
+    if (_edgesCells(edge,0) == -1)
+      {
+        _edgesCells(edge,0) = c;
+      }
+    else
+      {
+        _edgesCells(edge,1) = c;
+      }
+  }
 };
 
 #endif // MESH_H
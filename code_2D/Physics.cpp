@@ -28,6 +28,7 @@
 #include "Physics.h"
 #include "DataFile.h"
 #include "termcolor.h"
+#include "Profiler.h"
 #include "Eigen/Eigen/Dense"
 #include "Eigen/Eigen/Sparse"
 
@@ -40,16 +41,17 @@ Physics::Physics()
 {
 }
 
-Physics::Physics(DataFile* DF, Mesh* mesh):
-  _DF(DF), _mesh(mesh), _g(_DF->getGravityAcceleration()), _nCells(_mesh->getNumberOfCells()), _cellCenters(_mesh->getCellsCenter())
+Physics::Physics(const DataFile* DF, const Mesh* mesh):
+  _DF(DF), _mesh(mesh), _plan(DF->getRunPlan()), _g(_DF->getGravityAcceleration()), _nCells(_mesh->getNumberOfCells()), _cellCenters(_mesh->getCellsCenter())
 {
 }
 
-void Physics::Initialize(DataFile* DF, Mesh* mesh)
+void Physics::Initialize(const DataFile* DF, const Mesh* mesh)
 {
   // Initialisation
   _DF = DF;
   _mesh = mesh;
+  _plan = DF->getRunPlan();
   _g = DF->getGravityAcceleration();
   _nCells = _mesh->getNumberOfCells();
   _cellCenters = _mesh->getCellsCenter();
@@ -61,33 +63,32 @@ void Physics::Initialize()
   // Logs de début
   std::cout << "====================================================================================================" << std::endl;
   std::cout << "Building topography and initial condition..." << std::endl;
-  // Resize la condition initiale, la topographie et le terme source
+  // Resize la condition initiale et la topographie
   _Sol0.resize(_nCells, 3);
   _topography.resize(_nCells);
-  _source.resize(_nCells, 3);
 
   // Initialise la topographie
-  if (_DF->getTopographyType() == "FlatBottom")
+  if (_plan.topography == TopographyType::FlatBottom)
     {
       _topography.setZero();
     }
-  else if (_DF->getTopographyType() == "LinearUp")
+  else if (_plan.topography == TopographyType::LinearUp)
     {
       // TODO
     }
-  else if (_DF->getTopographyType() == "LinearDown")
+  else if (_plan.topography == TopographyType::LinearDown)
     {
       // TODO
     }
-  else if (_DF->getTopographyType() == "SineLinearDown")
+  else if (_plan.topography == TopographyType::SineLinearDown)
     {
       // TODO
     }
-  else if (_DF->getTopographyType() == "EllipticBump")
+  else if (_plan.topography == TopographyType::EllipticBump)
     {
       // TODO
     }
-  else if (_DF->getTopographyType() == "File")
+  else if (_plan.topography == TopographyType::File)
     {
       // TODO
     }
@@ -101,8 +102,11 @@ void Physics::Initialize()
   std::cout << termcolor::green << "SUCCESS::TOPOGRAPHY : Topography was successfully built." << std::endl;
   std::cout << termcolor::reset;
 
+  // Coefficients of the source term, computed once
+  buildSourceCoefficients();
+
   // Initialise la condition initiale
-  if (_DF->getScenario() == "ConstantWaterHeight")
+  if (_plan.scenario == ScenarioType::ConstantWaterHeight)
     {
       _Sol0.rightCols(2).setZero();
       for (int i(0) ; i < _nCells ; ++i)
@@ -110,7 +114,7 @@ void Physics::Initialize()
           _Sol0(i, 0) = 3.;
         }
     }
-  else if (_DF->getScenario() == "RestingLake")
+  else if (_plan.scenario == ScenarioType::RestingLake)
     {
       _Sol0.rightCols(2).setZero();
       double H(3.);
@@ -119,7 +123,7 @@ void Physics::Initialize()
           _Sol0(i, 0) = std::max(H - _topography(i, 1), 0.);
         }
     }
-  else if (_DF->getScenario() == "DamBreak")
+  else if (_plan.scenario == ScenarioType::DamBreak)
     {
       _Sol0.rightCols(2).setZero();
       double Hg(2.), Hd(1.);
@@ -135,7 +139,7 @@ void Physics::Initialize()
             }
         }
     }
-  else if (_DF->getScenario() == "SinePerturbation")
+  else if (_plan.scenario == ScenarioType::SinePerturbation)
     {
       _Sol0.rightCols(2).setZero();
       for (int i(0) ; i < _nCells ; ++i)
@@ -154,55 +158,39 @@ void Physics::Initialize()
   std::cout << termcolor::reset << "====================================================================================================" << std::endl << std::endl;
 }
 
-void Physics::buildSourceTerm(const Eigen::Matrix<double, Eigen::Dynamic, 3>& Sol)
+// Coefficients of the source term of (qx, qy) in each cell, -g grad(z).
+// The topography does not change : they are computed once, and the source
+// term is only a product with h at each time step. They are zero until the
+// topographies are implemented (TODO : analytic gradient of each
+// topography, finite differences for a topography file).
+void Physics::buildSourceCoefficients()
 {
-  // Construit le terme source en fonction de la topographie.
-  if (_DF->getTopographyType() == "FlatBottom")
-    {
-      _source.setZero();
-    }
-  else if (_DF->getTopographyType() == "LinearUp")
-    {
-      // TODO
-    }
-  else if (_DF->getTopographyType() == "LinearDown")
-    {
-      // TODO
-    }
-  else if (_DF->getTopographyType() == "SineLinearUp")
-    {
-      // TODO
-    }
-  else if (_DF->getTopographyType() == "SineLinearDown")
-    {
-      // TODO
-    }
-  else if (_DF->getTopographyType() == "EllipticBump")
-    {
-      // TODO
-    }
-  // Pour un fichier de topographie, la dérivée est approchée par une formule de
-  // différence finie ?
-  else if (_DF->getTopographyType() == "File")
-    {
-      // TODO
-    }
-  else
+  _sourceCoefficients.resize(_nCells, 2);
+  _sourceCoefficients.setZero();
+}
+
+void Physics::buildSourceTerm(const StateMatrix& Sol, SolverState& state) const
+{
+  PROFILE_SCOPE(SourceTerm);
+  StateMatrix& source(state.source);
+  if (_plan.topography == TopographyType::FlatBottom)
     {
-      std::cout << termcolor::red << "ERROR::SOURCETERM : Case not implemented." << std::endl;
-      std::cout << termcolor::reset;
-      exit(-1);
+      source.setZero();
+      return;
     }
+  source.col(0).setZero();
+  source.col(1) = _sourceCoefficients.col(0).cwiseProduct(Sol.col(0));
+  source.col(2) = _sourceCoefficients.col(1).cwiseProduct(Sol.col(0));
 }
 
-Eigen::Vector3d Physics::dirichletFunction(double x, double y, double t)
+Eigen::Vector3d Physics::dirichletFunction(double x, double y, double t) const
 {
   Eigen::Vector3d g(0., 0., 0.);
   // TODO
   return g;
 }
 
-Eigen::Vector3d Physics::neumannFunction(double x, double y, double t)
+Eigen::Vector3d Physics::neumannFunction(double x, double y, double t) const
 {
   Eigen::Vector3d h(0., 0., 0.);
   // TODO
@@ -31,6 +31,8 @@
 #include "DataFile.h"
 #include "Mesh.h"
 #include "termcolor.h"
+#include "Layout.h"
+#include "SolverState.h"
 #include "Eigen/Eigen/Dense"
 #include "Eigen/Eigen/Sparse"
 
@@ -38,8 +40,11 @@ class Physics
 {
 private:
   // Pointer to useful objects
-  DataFile* _DF;
-  Mesh* _mesh;
+  const DataFile* _DF;
+  const Mesh* _mesh;
+
+  // Resolved options of the data file
+  RunPlan _plan;
 
   // Useful variables
   double _g;
@@ -47,38 +52,43 @@ private:
   Eigen::Matrix<double, Eigen::Dynamic, 2> _cellCenters;
 
   // Initial condition
-  Eigen::Matrix<double, Eigen::Dynamic, 3> _Sol0;
+  StateMatrix _Sol0;
   
-  // Topography and source term
+  // Topography
   Eigen::VectorXd _topography;
-  Eigen::Matrix<double, Eigen::Dynamic, 3> _source;
+  // Coefficients of the source term (-g grad(z)), computed once : the
+  // source term of (qx, qy) is _sourceCoefficients * h
+  Eigen::Matrix<double, Eigen::Dynamic, 2> _sourceCoefficients;
   
 public:
   // Constructeur
   Physics();
-  Physics(DataFile* DF, Mesh* mesh);
+  Physics(const DataFile* DF, const Mesh* mesh);
 
-  // Initialisation
+  // Initialisation. Afterwards Physics does not change any more : what
+  // changes with time is in the SolverState given to the methods below.
   void Initialize();
-  void Initialize(DataFile* DF, Mesh* mesh);
+  void Initialize(const DataFile* DF, const Mesh* mesh);
 
   // Getters
-  const Eigen::Matrix<double, Eigen::Dynamic, 3>& getInitialCondition() const {return _Sol0;};
+  const StateMatrix& getInitialCondition() const {return _Sol0;};
   const Eigen::VectorXd& getTopography() const {return _topography;};
-  const Eigen::Matrix<double, Eigen::Dynamic, 3>& getSourceTerm() const {return _source;};
   
-  // Construit le terme source
-  void buildSourceTerm(const Eigen::Matrix<double, Eigen::Dynamic, 3>& Sol);
+  // Construit le terme source dans state.source
+  void buildSourceTerm(const StateMatrix& Sol, SolverState& state) const;
 
   // Conditions aux limites
-  Eigen::Vector3d dirichletFunction(double x, double y, double t);
-  Eigen::Vector3d neumannFunction(double x, double y, double t);
+  Eigen::Vector3d dirichletFunction(double x, double y, double t) const;
+  Eigen::Vector3d neumannFunction(double x, double y, double t) const;
 
   // Compute the physical flux
   Eigen::Matrix<double, 3, 2> physicalFlux(const Eigen::Vector3d& Sol) const;
 
   // Compute the eigenvalues of the flux jacobian
   void computeWaveSpeed(const Eigen::Vector3d& SolG, const Eigen::Vector3d& SolD, const Eigen::Vector2d& normal, double& lambda1, double& lambda2) const;
+
+protected:
+  void buildSourceCoefficients();
 };
 
 #endif // PHYSICS_H
@@ -0,0 +1,110 @@
+/*!
+ * @file Profiler.h
+ *
+ * Defines the scoped timers used to profile the time loop.
+ *
+ * @authors Gabriel Suau, Remi Pegouret, Lucas Trautmann
+ *
+ * @version 0.1.0
+ *
+ * @copyright © 2021 Gabriel Suau
+ * @copyright © 2021 Remi Pegouret
+ * @copyright © 2021 Lucas Trautmann
+ * 
+ * @copyright This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * @copyright You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+// Phases de la boucle en temps mesurées par le profiler
+enum class ProfilePhase {Boundary, Reconstruction, RiemannFluxes, SourceTerm, Update, Output, Count};
+
+// Profiler de la boucle en temps. Il n'est compilé que si PROFILING > 0
+// (make PROFILING=1 ou 2) : les PROFILE_SCOPE disparaissent sinon.
+//
+// Chaque PROFILE_SCOPE(Phase) mesure le temps passé dans le bloc qui le
+// contient, sans le temps des blocs mesurés qu'il contient lui-même (par
+// exemple un PROFILE_SCOPE placé plus loin dans le même bloc).
+// Les temps sont cumulés par pas de temps (endStep) pour obtenir la moyenne
+// et le 99e centile par pas de temps de chaque phase. Ne mesure que le
+// thread de la boucle en temps.
+class Profiler
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  // Remet tout à zéro et démarre le chronomètre global
+  static void start();
+  // Oublie les temps mesurés avant la boucle en temps (ils restent dans
+  // les totaux mais ne comptent pour aucun pas de temps)
+  static void beginTimeLoop();
+  // Ajoute du temps à une phase (pour le pas de temps courant)
+  static void add(ProfilePhase phase, Clock::duration duration);
+  // Fin d'un pas de temps
+  static void endStep();
+  // Arrête le chronomètre global, nCells sert au débit en cellules.pas/s
+  static void stop(long nCells);
+
+  // Tableau récapitulatif
+  static void printReport(std::ostream& out);
+  // Les mêmes données au format JSON
+  static void writeJSON(const std::string& fileName);
+};
+
+// Mesure du temps passé dans un bloc (voir PROFILE_SCOPE)
+class ProfileScope
+{
+private:
+  ProfilePhase _phase;
+  ProfileScope* _parent;
+  Profiler::Clock::duration _children;
+  Profiler::Clock::time_point _start;
+
+  // Bloc mesuré le plus interne en cours
+  static ProfileScope* _current;
+
+public:
+  explicit ProfileScope(ProfilePhase phase):
+    _phase(phase), _parent(_current), _children(0), _start(Profiler::Clock::now())
+  {
+    _current = this;
+  };
+
+  ~ProfileScope()
+  {
+    Profiler::Clock::duration elapsed(Profiler::Clock::now() - _start);
+    _current = _parent;
+    if (_parent)
+      _parent->_children += elapsed;
+    Profiler::add(_phase, elapsed - _children);
+  };
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#if PROFILING>0
+#define PROFILE_SCOPE_NAME(line) profileScope##line
+#define PROFILE_SCOPE_LINE(phase, line) ProfileScope PROFILE_SCOPE_NAME(line)(ProfilePhase::phase)
+#define PROFILE_SCOPE(phase) PROFILE_SCOPE_LINE(phase, __LINE__)
+#else
+#define PROFILE_SCOPE(phase)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,123 @@
+/*!
+ * @file SnapshotWriter.cpp
+ *
+ * Defines a class writing the snapshots of the solution in a background thread.
+ *
+ * @authors Gabriel Suau, Remi Pegouret, Lucas Trautmann
+ *
+ * @version 0.1.0
+ *
+ * @copyright © 2021 Gabriel Suau
+ * @copyright © 2021 Remi Pegouret
+ * @copyright © 2021 Lucas Trautmann
+ * 
+ * @copyright This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * @copyright You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "SnapshotWriter.h"
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+SnapshotWriter::SnapshotWriter():
+  _stop(false)
+{
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+  finish();
+}
+
+void SnapshotWriter::start(const std::function<void(const Snapshot&)>& write, int capacity)
+{
+  finish();
+  _write = write;
+  _buffers.resize(capacity);
+  _pending.clear();
+  _free.clear();
+  for (int i(capacity-1) ; i >= 0 ; --i)
+    {
+      _free.push_back(i);
+    }
+  _stop = false;
+  _thread = std::thread(&SnapshotWriter::run, this);
+}
+
+void SnapshotWriter::push(const std::string& fileName, double time, const StateMatrix& Sol)
+{
+  // Attend un buffer libre
+  std::unique_lock<std::mutex> lock(_mutex);
+  _condition.wait(lock, [this] {return !_free.empty();});
+  int i(_free.back());
+  _free.pop_back();
+  lock.unlock();
+
+  // Copie de la solution (sans réallocation si la taille ne change pas)
+  _buffers[i].fileName = fileName;
+  _buffers[i].time = time;
+  _buffers[i].Sol = Sol;
+
+  lock.lock();
+  _pending.push_back(i);
+  lock.unlock();
+  _condition.notify_all();
+}
+
+void SnapshotWriter::run()
+{
+  while (true)
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _condition.wait(lock, [this] {return _stop || !_pending.empty();});
+      if (_pending.empty())
+        {
+          return;
+        }
+      int i(_pending.front());
+      lock.unlock();
+
+      _write(_buffers[i]);
+
+      // Le buffer n'est rendu qu'une fois écrit
+      lock.lock();
+      _pending.pop_front();
+      _free.push_back(i);
+      lock.unlock();
+      _condition.notify_all();
+    }
+}
+
+void SnapshotWriter::wait()
+{
+  std::unique_lock<std::mutex> lock(_mutex);
+  _condition.wait(lock, [this] {return _pending.empty();});
+}
+
+void SnapshotWriter::finish()
+{
+  if (!_thread.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _condition.notify_all();
+  _thread.join();
+}
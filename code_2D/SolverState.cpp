@@ -0,0 +1,45 @@
+/*!
+ * @file SolverState.cpp
+ *
+ * Defines the state of a run, which changes during the time loop.
+ *
+ * @authors Gabriel Suau, Remi Pegouret, Lucas Trautmann
+ *
+ * @version 0.1.0
+ *
+ * @copyright © 2021 Gabriel Suau
+ * @copyright © 2021 Remi Pegouret
+ * @copyright © 2021 Lucas Trautmann
+ * 
+ * @copyright This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * @copyright You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "SolverState.h"
+
+SolverState::SolverState():
+  maxWaveSpeed(0.)
+{
+}
+
+SolverState::SolverState(int nCells):
+  maxWaveSpeed(0.)
+{
+  resize(nCells);
+}
+
+void SolverState::resize(int nCells)
+{
+  source.setZero(nCells, 3);
+  fluxVector.setZero(nCells, 3);
+}
@@ -0,0 +1,56 @@
+/*!
+ * @file SolverState.h
+ *
+ * Defines the state of a run, which changes during the time loop.
+ *
+ * @authors Gabriel Suau, Remi Pegouret, Lucas Trautmann
+ *
+ * @version 0.1.0
+ *
+ * @copyright © 2021 Gabriel Suau
+ * @copyright © 2021 Remi Pegouret
+ * @copyright © 2021 Lucas Trautmann
+ * 
+ * @copyright This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * @copyright You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SOLVER_STATE_H
+#define SOLVER_STATE_H
+
+#include "Layout.h"
+
+// State of a run : the arrays rebuilt at each time step.
+//
+// Physics and FiniteVolume take this state as an argument and do not change
+// once initialized, so several runs can share them, each with its own
+// TimeScheme owning its state (except with PROFILING > 0 : the profiler is
+// global).
+struct SolverState
+{
+  // Source term
+  StateMatrix source;
+  // Flux vector
+  StateMatrix fluxVector;
+  // Largest wave speed |lambda| found during the last flux computation
+  double maxWaveSpeed;
+
+  // Constructors
+  SolverState();
+  SolverState(int nCells);
+
+  // Resize the arrays for a mesh of nCells cells
+  void resize(int nCells);
+};
+
+#endif // SOLVER_STATE_H
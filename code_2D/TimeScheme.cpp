@@ -30,6 +30,9 @@
 #include "Mesh.h"
 #include "Physics.h"
 #include "FiniteVolume.h"
+#include "Checkpoint.h"
+#include "Profiler.h"
+#include "termcolor.h"
 
 #include "Eigen/Eigen/Dense"
 #include "Eigen/Eigen/Sparse"
@@ -38,41 +41,72 @@
 #include <fstream>
 #include <string>
 #include <cmath>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <chrono>
 
 
 //--------------------------------------------------//
 //--------------------Base Class--------------------//
 //--------------------------------------------------//
-TimeScheme::TimeScheme()
+TimeScheme::TimeScheme():
+  _parametersHash(0)
 {
 }
 
-TimeScheme::TimeScheme(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol):
-  _DF(DF), _mesh(mesh), _physics(physics), _finVol(finVol), _Sol(_physics->getInitialCondition()), _timeStep(DF->getTimeStep()), _initialTime(DF->getInitialTime()), _finalTime(DF->getFinalTime()), _currentTime(_initialTime)
+TimeScheme::TimeScheme(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol):
+  _DF(DF), _mesh(mesh), _physics(physics), _finVol(finVol), _plan(DF->getRunPlan()), _Sol(_physics->getInitialCondition()), _state(mesh->getNumberOfCells()), _timeStep(DF->getTimeStep()), _initialTime(DF->getInitialTime()), _finalTime(DF->getFinalTime()), _currentTime(_initialTime), _parametersHash(0)
 {
 }
 
-void TimeScheme::Initialize(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol)
+void TimeScheme::Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol)
 {
   _DF = DF;
   _mesh = mesh;
   _physics = physics;
   _finVol = finVol;
+  _plan = DF->getRunPlan();
   _Sol = _physics->getInitialCondition();
+  _state = SolverState(mesh->getNumberOfCells());
   _timeStep = DF->getTimeStep();
   _initialTime = DF->getInitialTime();
   _finalTime = DF->getFinalTime();
   _currentTime = _initialTime;
 }
 
-void TimeScheme::saveCurrentSolution(std::string& fileName) const
+// Same update as ExplicitEuler::oneStep (the source term is not used yet).
+// out may be U or _Sol, the rows are updated one by one.
+void TimeScheme::sspStage(const StateMatrix& U, double a, double b, double dt, StateMatrix& out)
 {
+  const Eigen::VectorXd& cellsArea(_mesh->getCellsArea());
+  const StateMatrix& fluxVector(_state.fluxVector);
+  if (a == 0.)
+    {
+      for (int i(0) ; i < _Sol.rows() ; ++i)
+        {
+          double cellArea(cellsArea(i));
+          out.row(i) = b * (U.row(i) - dt / cellArea * fluxVector.row(i));
+        }
+    }
+  else
+    {
+      for (int i(0) ; i < _Sol.rows() ; ++i)
+        {
+          double cellArea(cellsArea(i));
+          out.row(i) = a * _Sol.row(i) + b * (U.row(i) - dt / cellArea * fluxVector.row(i));
+        }
+    }
+}
+
+void TimeScheme::saveCurrentSolution(const std::string& fileName, const StateMatrix& Sol) const
+{
+  // Les lignes finissent par "\n" et non std::endl, qui viderait le buffer à chaque ligne
   std::ofstream outputFile(fileName, std::ios::out);
   outputFile.precision(7);
-  Eigen::Matrix<double, Eigen::Dynamic, 2> cellCenters (_mesh->getCellsCenter());
 
   // Vérifications
-  if (_Sol.rows() != _mesh->getNumberOfCells())
+  if (Sol.rows() != _mesh->getNumberOfCells())
     {
       std::cout << termcolor::red << "ERROR::TIMESCHEME : The size of the solution is not the same that the number of cells !" << std::endl;
       std::cout << termcolor::reset << "====================================================================================================" << std::endl;
@@ -80,61 +114,204 @@ void TimeScheme::saveCurrentSolution(std::string& fileName) const
     }
 
   // Informations générales
-  outputFile << "# vtk DataFile Version 3.0 " << std::endl;
-  outputFile << "2D Unstructured Grid" << std::endl;
-  outputFile << "ASCII" << std::endl;
-  outputFile << "DATASET UNSTRUCTURED_GRID" << std::endl;
+  outputFile << "# vtk DataFile Version 3.0 " << "\n";
+  outputFile << "2D Unstructured Grid" << "\n";
+  outputFile << "ASCII" << "\n";
+  outputFile << "DATASET UNSTRUCTURED_GRID" << "\n";
 
   // Sauvegarde des sommets
   int nbVertices(_mesh->getNumberOfVertices());
-  outputFile << "POINTS " << nbVertices << " float " << std::endl;
+  outputFile << "POINTS " << nbVertices << " float " << "\n";
   for (int i(0) ; i < nbVertices ; ++i)
     {
-      outputFile << _mesh->getVertices()[i].getCoordinates()[0] << " " << _mesh->getVertices()[i].getCoordinates()[1] << " 0." << std::endl;
+      outputFile << _mesh->getVertices()[i].getCoordinates()[0] << " " << _mesh->getVertices()[i].getCoordinates()[1] << " 0." << "\n";
     }
-  outputFile << std::endl;
+  outputFile << "\n";
 
   // Sauvegarde des cellules
   int nbCells(_mesh->getNumberOfCells());
   int nbVerticesPCell(_mesh->getNumberOfVerticesPerCell());
-  outputFile << "CELLS " << nbCells << " " << nbCells * (nbVerticesPCell + 1) << std::endl;
+  outputFile << "CELLS " << nbCells << " " << nbCells * (nbVerticesPCell + 1) << "\n";
+  // Les cellules sont écrites dans l'ordre du fichier de maillage
+  const std::vector<int>& fileOrder(_mesh->getCellsFileOrder());
+  const Eigen::VectorXi& cellsVerticesOffsets(_mesh->getCellsVerticesOffsets());
+  const Eigen::VectorXi& cellsVertices(_mesh->getCellsVertices());
   for (int i(0) ; i < nbCells ; ++i)
     {
       outputFile << nbVerticesPCell;
-      for (int j(0) ; j < nbVerticesPCell ; ++j)
+      for (int j(cellsVerticesOffsets(fileOrder[i])) ; j < cellsVerticesOffsets(fileOrder[i]+1) ; ++j)
         {
-          outputFile << " " << _mesh->getCells()[i].getVerticesIndex()[j];
+          outputFile << " " << cellsVertices(j);
         }
-      outputFile << std::endl;
+      outputFile << "\n";
     }
-  outputFile << std::endl;
+  outputFile << "\n";
 
   // Sauvegarde du type de cellules
-  outputFile << "CELL_TYPES " << nbCells << std::endl;
+  outputFile << "CELL_TYPES " << nbCells << "\n";
   for (int i(0) ; i < nbCells ; ++i)
     {
-      outputFile << 5 << std::endl;
+      outputFile << 5 << "\n";
     }
-  outputFile << std::endl;
+  outputFile << "\n";
 
-  outputFile << "CELL_DATA " << nbCells << std::endl;
+  outputFile << "CELL_DATA " << nbCells << "\n";
 
   // Sauvegarde de la hauteur
-  outputFile << "SCALARS h float 1" << std::endl;
-  outputFile << "LOOKUP_TABLE default" << std::endl;
+  outputFile << "SCALARS h float 1" << "\n";
+  outputFile << "LOOKUP_TABLE default" << "\n";
   for (int i(0) ; i < nbCells ; ++i)
     {
-      outputFile << _Sol(i,0) << std::endl;
+      outputFile << Sol(fileOrder[i],0) << "\n";
     }
-  outputFile << std::endl;
+  outputFile << "\n";
 
   // Sauvegarde de la vitesse
-  outputFile << "VECTORS vel float" << std::endl;
-  for (int i(0) ; i < _mesh->getNumberOfCells() ; ++i)
+  outputFile << "VECTORS vel float" << "\n";
+  for (int i(0) ; i < nbCells ; ++i)
+    {
+      int c(fileOrder[i]);
+      outputFile << Sol(c,1)/Sol(c,0) << " " << Sol(c,2)/Sol(c,0) << " 0" << "\n";
+    }
+  outputFile << "\n";
+}
+
+// Sauvegarde numéro nSaves de la solution : la solution est copiée et le
+// fichier est écrit par le thread de sauvegarde (voir writeSnapshot)
+void TimeScheme::saveSnapshot(int nSaves)
+{
+  PROFILE_SCOPE(Output);
+  std::string fileName;
+  if (_plan.outputFormat == OutputFormatType::VTK)
     {
-      outputFile << _Sol(i,1)/_Sol(i,0) << " " << _Sol(i,2)/_Sol(i,0) << " 0" << std::endl;
+      fileName = _DF->getResultsDirectory() + "/solution_" + _finVol->getFluxName() + "_" + std::to_string(nSaves) + ".vtk";
     }
-  outputFile << std::endl;
+  _snapshotWriter.push(fileName, _currentTime, _Sol);
+}
+
+// Writes a snapshot in the chosen format (called by the snapshot writer thread)
+void TimeScheme::writeSnapshot(const Snapshot& snapshot)
+{
+  switch (_plan.outputFormat)
+    {
+    case OutputFormatType::VTK:
+      saveCurrentSolution(snapshot.fileName, snapshot.Sol);
+      break;
+    case OutputFormatType::XDMF:
+      _xdmfWriter.writeSnapshot(snapshot.time, snapshot.Sol);
+      break;
+    }
+}
+
+void TimeScheme::openTimeStepHistory(long long size)
+{
+  std::string fileName(_DF->getResultsDirectory() + "/time_steps.txt");
+  if (size > 0)
+    {
+      // Restart : the file as it was at the checkpoint
+      truncateFile(fileName, size);
+      _timeStepFile.open(fileName, std::ios::out | std::ios::app);
+    }
+  else
+    {
+      _timeStepFile.open(fileName, std::ios::out | std::ios::trunc);
+      _timeStepFile << "# n  t       dt" << std::endl;
+    }
+}
+
+void TimeScheme::recordTimeStep()
+{
+  PROFILE_SCOPE(Output);
+  ++_nAdaptiveSteps;
+  _dtMin = (_nAdaptiveSteps == 1 ? _timeStep : std::min(_dtMin, _timeStep));
+  _dtMax = std::max(_dtMax, _timeStep);
+  _dtSum += _timeStep;
+  _timeStepFile << _nAdaptiveSteps << " " << _currentTime << " " << _timeStep << "\n";
+}
+
+void TimeScheme::closeTimeStepHistory()
+{
+  _timeStepFile.close();
+
+  // Short summary
+  if (_nAdaptiveSteps == 0)
+    return;
+  std::cout << "Adaptive time step : " << _nAdaptiveSteps << " steps, dt min = " << _dtMin << ", dt max = " << _dtMax << ", dt mean = " << _dtSum / _nAdaptiveSteps << std::endl;
+}
+
+// Writes a checkpoint with the whole state of the time loop. The pending
+// snapshots are written first, so that the saved state of the output files
+// matches the solution.
+void TimeScheme::writeCheckpoint(int n, int nSaves)
+{
+  PROFILE_SCOPE(Output);
+  _snapshotWriter.wait();
+
+  Checkpoint checkpoint;
+  checkpoint.put<long long>(_Sol.rows());
+  checkpoint.put(_parametersHash);
+  checkpoint.put<int>(static_cast<int>(_plan.outputFormat));
+  checkpoint.put(_currentTime);
+  checkpoint.put(_timeStep);
+  checkpoint.put(n);
+  checkpoint.put(nSaves);
+  checkpoint.putMatrix(_Sol);
+  _timeStepFile.flush();
+  checkpoint.put(_nAdaptiveSteps);
+  checkpoint.put(_dtMin);
+  checkpoint.put(_dtMax);
+  checkpoint.put(_dtSum);
+  checkpoint.put(fileSize(_DF->getResultsDirectory() + "/time_steps.txt"));
+  if (_plan.outputFormat == OutputFormatType::XDMF)
+    {
+      _xdmfWriter.writeCheckpoint(checkpoint);
+    }
+  checkpoint.save(_DF->getResultsDirectory() + "/checkpoint.bin");
+  std::cout << "Checkpoint at t = " << _currentTime << std::endl;
+}
+
+// Reads a checkpoint and brings the output files back to their state at
+// that time
+void TimeScheme::readCheckpoint(const std::string& fileName, int& n, int& nSaves)
+{
+  Checkpoint checkpoint;
+  checkpoint.load(fileName);
+  if (checkpoint.get<long long>() != _Sol.rows())
+    {
+      std::cout << termcolor::red << "ERROR::TIMESCHEME : The checkpoint " << fileName << " was written with another mesh." << std::endl;
+      std::cout << termcolor::reset << "====================================================================================================" << std::endl;
+      exit(-1);
+    }
+  if (checkpoint.get<unsigned long long>() != _parametersHash)
+    {
+      std::cout << termcolor::yellow << "WARNING::TIMESCHEME : The data file changed since the checkpoint " << fileName << " was written." << std::endl;
+      std::cout << termcolor::reset;
+    }
+  if (checkpoint.get<int>() != static_cast<int>(_plan.outputFormat))
+    {
+      std::cout << termcolor::red << "ERROR::TIMESCHEME : OutputFormat must be the same as in the checkpoint " << fileName << std::endl;
+      std::cout << termcolor::reset << "====================================================================================================" << std::endl;
+      exit(-1);
+    }
+  _currentTime = checkpoint.get<double>();
+  _timeStep = checkpoint.get<double>();
+  n = checkpoint.get<int>();
+  nSaves = checkpoint.get<int>();
+  checkpoint.getMatrix(_Sol);
+  _nAdaptiveSteps = checkpoint.get<int>();
+  _dtMin = checkpoint.get<double>();
+  _dtMax = checkpoint.get<double>();
+  _dtSum = checkpoint.get<double>();
+  long long timeStepsFileSize(checkpoint.get<long long>());
+  if (_plan.isAdaptiveTimeStep)
+    {
+      openTimeStepHistory(timeStepsFileSize);
+    }
+  if (_plan.outputFormat == OutputFormatType::XDMF)
+    {
+      _xdmfWriter.Resume(_mesh, _DF->getResultsDirectory(), "solution_" + _finVol->getFluxName(), checkpoint);
+    }
+  std::cout << "Restarting from t = " << _currentTime << " (" << fileName << ")" << std::endl;
 }
 
 void TimeScheme::solve()
@@ -142,31 +319,158 @@ void TimeScheme::solve()
   // Logs de début
   std::cout << "====================================================================================================" << std::endl;
   std::cout << "Time loop..." << std::endl;
+#if PROFILING>0
+  Profiler::start();
+#endif
 
   // Variables pratiques
   int n(0);
   std::string resultsDir(_DF->getResultsDirectory());
   std::string fluxName(_finVol->getFluxName());
+  std::ifstream parametersFile(_DF->getFileName());
+  std::string parameters((std::istreambuf_iterator<char>(parametersFile)), std::istreambuf_iterator<char>());
+  _parametersHash = stringHash(parameters);
+
+  // With adaptive time stepping, the solution is saved at the same times as
+  // with the fixed time step TimeStep : the time step is shortened to land
+  // exactly on these times and on the final time.
+  int nSaves(0);
+  double tol(1e-6 * _plan.timeStep);
+  // Smallest area/perimeter ratio of the cells, the length scale of the CFL condition
+  double cellSize(0.);
+  if (_plan.isAdaptiveTimeStep)
+    {
+      const Eigen::VectorXd& cellsArea(_mesh->getCellsArea());
+      const Eigen::VectorXd& cellsPerimeter(_mesh->getCellsPerimeter());
+      cellSize = cellsArea(0) / cellsPerimeter(0);
+      for (int i(1) ; i < _mesh->getNumberOfCells() ; ++i)
+        {
+          cellSize = std::min(cellSize, cellsArea(i) / cellsPerimeter(i));
+        }
+      _nAdaptiveSteps = 0;
+      _dtMin = 0.;
+      _dtMax = 0.;
+      _dtSum = 0.;
+    }
+
+  if (_DF->isRestart())
+    {
+      // Restart : state of the time loop and of the output files at the checkpoint
+      readCheckpoint(_DF->getRestartFile(), n, nSaves);
+      _snapshotWriter.start([this](const Snapshot& snapshot) {writeSnapshot(snapshot);});
+    }
+  else
+    {
+      // Sauvegarde la condition initiale
+      if (_plan.outputFormat == OutputFormatType::XDMF)
+        {
+          _xdmfWriter.Initialize(_mesh, resultsDir, "solution_" + fluxName);
+        }
+      // At most two copies of the solution wait to be written
+      _snapshotWriter.start([this](const Snapshot& snapshot) {writeSnapshot(snapshot);});
+      saveSnapshot(0);
+      if (_plan.isAdaptiveTimeStep)
+        {
+          openTimeStepHistory(0);
+        }
+    }
 
-  // Sauvegarde la condition initiale
-  std::string fileName(resultsDir + "/solution_" + fluxName + "_" + std::to_string(n) + ".vtk");
-  saveCurrentSolution(fileName);
+  // Checkpoints every CheckpointInterval seconds
+  std::chrono::steady_clock::duration checkpointInterval(std::chrono::duration_cast<std::chrono::steady_clock::duration>
+                                                         (std::chrono::duration<double>(_plan.checkpointInterval)));
+  std::chrono::steady_clock::time_point nextCheckpoint(std::chrono::steady_clock::now() + checkpointInterval);
+
+#if PROFILING>0
+  Profiler::beginTimeLoop();
+#endif
 
   // Boucle en temps
   while (_currentTime < _finalTime)
     {
-      _physics->buildSourceTerm(_Sol);
-      _finVol->buildFluxVector(_Sol);
-      oneStep();
-      ++n;
-      _currentTime += _timeStep;
-      if (n % _DF->getSaveFrequency() == 0)
+      _physics->buildSourceTerm(_Sol, _state);
+      _finVol->buildFluxVector(_Sol, _state);
+      bool isSaveTime(false);
+      if (_plan.isAdaptiveTimeStep)
+        {
+          // Next time to reach exactly
+          double nextSaveTime(_initialTime + ((nSaves + 1) * _plan.saveFrequency) * _plan.timeStep);
+          double nextEventTime(std::min(_finalTime, nextSaveTime));
+          if (nextEventTime > _finalTime - tol)
+            nextEventTime = _finalTime;
+          // CFL condition with the wave speed of the flux just computed. The
+          // remaining time before the next save is split in two halves rather
+          // than leaving a tiny last step.
+          double timeStep(_plan.CFL * cellSize / _state.maxWaveSpeed);
+          // The time step collapses when the scheme goes unstable (infinite wave
+          // speed, or NaN as soon as one cell is) : the time would not move forward
+          // anymore
+          if (!std::isfinite(timeStep) || !(timeStep > 1e-10 * _plan.timeStep))
+            {
+              std::cout << termcolor::red << "ERROR::TIMESCHEME : The adaptive time step collapsed (dt = " << timeStep << " at t = " << _currentTime
+                        << "), the scheme is probably unstable : reduce the CFL." << std::endl;
+              std::cout << termcolor::reset << "====================================================================================================" << std::endl;
+              exit(-1);
+            }
+          double nextTime(_currentTime + timeStep);
+          if (nextTime > nextEventTime - tol)
+            nextTime = nextEventTime;
+          else if (nextTime + timeStep > nextEventTime)
+            nextTime = 0.5 * (_currentTime + nextEventTime);
+          _timeStep = nextTime - _currentTime;
+
+          oneStep();
+          ++n;
+          _currentTime = nextTime;
+          recordTimeStep();
+          if (_currentTime > nextSaveTime - tol)
+            {
+              ++nSaves;
+              isSaveTime = true;
+            }
+        }
+      else
+        {
+          oneStep();
+          ++n;
+          _currentTime += _timeStep;
+          nSaves = n/_plan.saveFrequency;
+          isSaveTime = (n % _plan.saveFrequency == 0);
+        }
+      if (isSaveTime)
         {
           std::cout << "Saving solution at t = " << _currentTime << std::endl;
-          std::string fileName(resultsDir + "/solution_" + fluxName + "_" + std::to_string(n/_DF->getSaveFrequency()) + ".vtk");
-          saveCurrentSolution(fileName);
+          saveSnapshot(nSaves);
         }
+      if (_plan.checkpointInterval > 0 && std::chrono::steady_clock::now() >= nextCheckpoint)
+        {
+          writeCheckpoint(n, nSaves);
+          nextCheckpoint = std::chrono::steady_clock::now() + checkpointInterval;
+        }
+#if PROFILING>0
+      Profiler::endStep();
+#endif
     }
+  // Wait for the last snapshots to be written
+  {
+    PROFILE_SCOPE(Output);
+    _snapshotWriter.finish();
+  }
+  // Last checkpoint, to be able to extend the run
+  if (_plan.checkpointInterval > 0)
+    {
+      writeCheckpoint(n, nSaves);
+    }
+  if (_plan.isAdaptiveTimeStep)
+    {
+      closeTimeStepHistory();
+    }
+#if PROFILING>0
+  Profiler::stop(_Sol.rows());
+  Profiler::printReport(std::cout);
+#if PROFILING>1
+  Profiler::writeJSON(resultsDir + "/profile.json");
+#endif
+#endif
 
   // Logs de fin
   std::cout << termcolor::green << "SUCCESS::TIMESCHEME : Solved 2D St-Venant equations successfully !" << std::endl;
@@ -182,18 +486,20 @@ ExplicitEuler::ExplicitEuler():
 {
 }
 
-ExplicitEuler::ExplicitEuler(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol):
+ExplicitEuler::ExplicitEuler(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol):
   TimeScheme(DF, mesh, physics, finVol)
 {
 }
 
-void ExplicitEuler::Initialize(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol)
+void ExplicitEuler::Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol)
 {
   _DF = DF;
   _mesh = mesh;
   _physics = physics;
   _finVol = finVol;
+  _plan = DF->getRunPlan();
   _Sol = _physics->getInitialCondition();
+  _state = SolverState(mesh->getNumberOfCells());
   _timeStep = DF->getTimeStep();
   _initialTime = DF->getInitialTime();
   _finalTime = DF->getFinalTime();
@@ -202,11 +508,13 @@ void ExplicitEuler::Initialize(DataFile* DF, Mesh* mesh, Physics* physics, Finit
 
 void ExplicitEuler::oneStep()
 {
+  PROFILE_SCOPE(Update);
+
   // Récupération des trucs importants
   double dt(_timeStep);
   const Eigen::VectorXd& cellsArea(_mesh->getCellsArea());
-  const Eigen::Matrix<double, Eigen::Dynamic, 3>& fluxVector(_finVol->getFluxVector());
-  // const Eigen::Matrix<double, Eigen::Dynamic, 3>& sourceTerm(_physics->getSourceTerm());
+  const StateMatrix& fluxVector(_state.fluxVector);
+  // const StateMatrix& sourceTerm(_state.source);
   
   // Mise à jour de la solution
   for (int i(0) ; i < _Sol.rows() ; ++i)
@@ -215,3 +523,102 @@ void ExplicitEuler::oneStep()
       _Sol.row(i) += - dt / cellArea * fluxVector.row(i);
     }
 }
+
+
+//---------------------------------------------------------//
+//--------------------SSP Runge Kutta 3--------------------//
+//---------------------------------------------------------//
+SSPRK3::SSPRK3():
+  TimeScheme()
+{
+}
+
+SSPRK3::SSPRK3(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol):
+  TimeScheme(DF, mesh, physics, finVol), _stageSol(_Sol.rows(), 3)
+{
+}
+
+void SSPRK3::Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol)
+{
+  _DF = DF;
+  _mesh = mesh;
+  _physics = physics;
+  _finVol = finVol;
+  _plan = DF->getRunPlan();
+  _Sol = _physics->getInitialCondition();
+  _state = SolverState(mesh->getNumberOfCells());
+  _timeStep = DF->getTimeStep();
+  _initialTime = DF->getInitialTime();
+  _finalTime = DF->getFinalTime();
+  _currentTime = _initialTime;
+  _stageSol.resize(mesh->getNumberOfCells(), 3);
+}
+
+void SSPRK3::oneStep()
+{
+  PROFILE_SCOPE(Update);
+
+  double dt(_timeStep);
+
+  // U1 = Sol + dt * L(Sol), the flux of Sol being built by solve
+  sspStage(_Sol, 0., 1., dt, _stageSol);
+  // U2 = 3/4 Sol + 1/4 (U1 + dt * L(U1))
+  _physics->buildSourceTerm(_stageSol, _state);
+  _finVol->buildFluxVector(_stageSol, _state);
+  sspStage(_stageSol, 0.75, 0.25, dt, _stageSol);
+  // Sol = 1/3 Sol + 2/3 (U2 + dt * L(U2))
+  _physics->buildSourceTerm(_stageSol, _state);
+  _finVol->buildFluxVector(_stageSol, _state);
+  sspStage(_stageSol, 1./3., 2./3., dt, _Sol);
+}
+
+
+//-------------------------------------------------------------//
+//--------------------SSP Runge Kutta (s,2)--------------------//
+//-------------------------------------------------------------//
+SSPRKs2::SSPRKs2():
+  TimeScheme()
+{
+}
+
+SSPRKs2::SSPRKs2(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol):
+  TimeScheme(DF, mesh, physics, finVol), _stageSol(_Sol.rows(), 3)
+{
+}
+
+void SSPRKs2::Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol)
+{
+  _DF = DF;
+  _mesh = mesh;
+  _physics = physics;
+  _finVol = finVol;
+  _plan = DF->getRunPlan();
+  _Sol = _physics->getInitialCondition();
+  _state = SolverState(mesh->getNumberOfCells());
+  _timeStep = DF->getTimeStep();
+  _initialTime = DF->getInitialTime();
+  _finalTime = DF->getFinalTime();
+  _currentTime = _initialTime;
+  _stageSol.resize(mesh->getNumberOfCells(), 3);
+}
+
+void SSPRKs2::oneStep()
+{
+  PROFILE_SCOPE(Update);
+
+  int s(_plan.rungeKuttaStages);
+  double subStep(_timeStep / (s - 1));
+
+  // s - 1 explicit Euler stages of dt/(s-1), the flux of Sol being built by solve
+  sspStage(_Sol, 0., 1., subStep, _stageSol);
+  for (int i(1) ; i < s - 1 ; ++i)
+    {
+      _physics->buildSourceTerm(_stageSol, _state);
+      _finVol->buildFluxVector(_stageSol, _state);
+      sspStage(_stageSol, 0., 1., subStep, _stageSol);
+    }
+  // Sol = 1/s Sol + (s-1)/s (U + dt/(s-1) * L(U))
+  _physics->buildSourceTerm(_stageSol, _state);
+  _finVol->buildFluxVector(_stageSol, _state);
+  sspStage(_stageSol, 1. / s, (s - 1.) / s, subStep, _Sol);
+}
@@ -33,47 +33,92 @@
 #include "DataFile.h"
 #include "Mesh.h"
 #include "Physics.h"
+#include "SolverState.h"
 #include "FiniteVolume.h"
+#include "Layout.h"
+#include "XDMFWriter.h"
+#include "SnapshotWriter.h"
+
+#include <fstream>
+#include <vector>
 
 class TimeScheme
 {
 protected:
-  // Pointeur vers les trucs importants
-  DataFile* _DF;
-  Mesh* _mesh;
-  Physics* _physics;
-  FiniteVolume* _finVol;
+  // Pointeur vers les trucs importants (the problem, read only)
+  const DataFile* _DF;
+  const Mesh* _mesh;
+  const Physics* _physics;
+  const FiniteVolume* _finVol;
+
+  // Resolved options of the data file
+  RunPlan _plan;
 
   // Solution
-  Eigen::Matrix<double, Eigen::Dynamic, 3> _Sol;
+  StateMatrix _Sol;
+
+  // State of the run : source term, flux vector... (see SolverState.h)
+  SolverState _state;
   
   // Paramètres de temps
   double _timeStep;
   double _initialTime;
   double _finalTime;
   double _currentTime;
+
+  // Adaptive time stepping : each step is appended to time_steps.txt as the
+  // run goes, only the number of steps, min, max and sum are kept for the summary
+  std::ofstream _timeStepFile;
+  int _nAdaptiveSteps;
+  double _dtMin, _dtMax, _dtSum;
+
+  // XDMF output (OutputFormat = XDMF)
+  XDMFWriter _xdmfWriter;
+
+  // Writes the snapshots in the background, while the time loop goes on
+  SnapshotWriter _snapshotWriter;
+
+  // Hash of the data file (checkpoints)
+  unsigned long long _parametersHash;
+
+  // Explicit Euler stage of the SSP schemes, with the flux vector of U
+  // already built : out = a * Sol + b * (U + dt * L(U))
+  void sspStage(const StateMatrix& U, double a, double b, double dt, StateMatrix& out);
   
 public:
   // Constructeurs
   TimeScheme();
-  TimeScheme(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol);
+  TimeScheme(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
 
   // Initialiseur
-  void Initialize(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol);
+  void Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
   // Destructeur
   virtual ~TimeScheme() = default;
 
   // Getters
-  const Eigen::Matrix<double, Eigen::Dynamic, 3>& getSolution() const {return _Sol;};
+  const StateMatrix& getSolution() const {return _Sol;};
   double getTimeStep() const {return _timeStep;};
   double getInitialTime() const {return _initialTime;};
   double getFinalTime() const {return _finalTime;};
   double getCurrentTime() const {return _currentTime;};
+  // State of the run (source term, flux vector...), built before oneStep
+  SolverState& getState() {return _state;};
   
   // Solve and save solution
   virtual void oneStep() = 0;
-  void saveCurrentSolution(std::string& fileName) const;
+  void saveCurrentSolution(const std::string& fileName, const StateMatrix& Sol) const;
+  void saveSnapshot(int nSaves);
+  void writeSnapshot(const Snapshot& snapshot);
+  // Adaptive time stepping : time_steps.txt (size in bytes on restart, 0 for
+  // a new file), one time step, summary at the end of the run
+  void openTimeStepHistory(long long size);
+  void recordTimeStep();
+  void closeTimeStepHistory();
   void solve();
+
+  // Checkpoint/restart of the time loop
+  void writeCheckpoint(int n, int nSaves);
+  void readCheckpoint(const std::string& fileName, int& n, int& nSaves);
 };
 
 class ExplicitEuler: public TimeScheme
@@ -81,10 +126,53 @@ class ExplicitEuler: public TimeScheme
 public:
   // Constructeurs
   ExplicitEuler();
-  ExplicitEuler(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol);
+  ExplicitEuler(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
+
+  // Initialiseur
+  void Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
+
+  // One time step
+  void oneStep();
+};
+
+// Shu-Osher SSP-RK3 : convex combinations of explicit Euler stages (same
+// CFL as explicit Euler, third order). Only two registers are used, the
+// solution and the intermediate solution.
+class SSPRK3: public TimeScheme
+{
+private:
+  // Intermediate solution, allocated once
+  StateMatrix _stageSol;
+
+public:
+  // Constructeurs
+  SSPRK3();
+  SSPRK3(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
+
+  // Initialiseur
+  void Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
+
+  // One time step
+  void oneStep();
+};
+
+// SSP-RK(s,2) with s stages (RungeKuttaStages), second order : s - 1
+// explicit Euler stages of dt/(s-1), then an average with the solution.
+// The CFL may be s - 1 times the one of explicit Euler, for s flux
+// evaluations per time step, and only two registers are used.
+class SSPRKs2: public TimeScheme
+{
+private:
+  // Intermediate solution, allocated once
+  StateMatrix _stageSol;
+
+public:
+  // Constructeurs
+  SSPRKs2();
+  SSPRKs2(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
 
   // Initialiseur
-  void Initialize(DataFile* DF, Mesh* mesh, Physics* physics, FiniteVolume* finVol);
+  void Initialize(const DataFile* DF, const Mesh* mesh, const Physics* physics, const FiniteVolume* finVol);
 
   // One time step
   void oneStep();
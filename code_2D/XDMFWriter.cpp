@@ -0,0 +1,239 @@
+/*!
+ * @file XDMFWriter.cpp
+ *
+ * Defines an XDMF writer for the solution (raw binary data + XML index).
+ *
+ * @authors Gabriel Suau, Remi Pegouret, Lucas Trautmann
+ *
+ * @version 0.1.0
+ *
+ * @copyright © 2021 Gabriel Suau
+ * @copyright © 2021 Remi Pegouret
+ * @copyright © 2021 Lucas Trautmann
+ * 
+ * @copyright This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * @copyright You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "XDMFWriter.h"
+#include "Mesh.h"
+#include "termcolor.h"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+XDMFWriter::XDMFWriter():
+  _mesh(0), _indexFooterPosition(0), _offset(0), _geometryOffset(0), _topologyOffset(0)
+{
+}
+
+XDMFWriter::XDMFWriter(const Mesh* mesh, const std::string& resultsDir, const std::string& name):
+  _mesh(mesh), _heavyFileName(name + ".bin"), _indexFileName(resultsDir + "/" + name + ".xmf"), _indexFooterPosition(0), _offset(0), _geometryOffset(0), _topologyOffset(0)
+{
+  _heavyFile.open(resultsDir + "/" + _heavyFileName, std::ios::out | std::ios::binary | std::ios::trunc);
+}
+
+void XDMFWriter::Initialize(const Mesh* mesh, const std::string& resultsDir, const std::string& name)
+{
+  _mesh = mesh;
+  _heavyFileName = name + ".bin";
+  _indexFileName = resultsDir + "/" + name + ".xmf";
+  _heavyFile.close();
+  _heavyFile.open(resultsDir + "/" + _heavyFileName, std::ios::out | std::ios::binary | std::ios::trunc);
+  _indexFile.close();
+  _offset = 0;
+  _fieldsOffset.clear();
+  _times.clear();
+}
+
+void XDMFWriter::writeCheckpoint(Checkpoint& checkpoint) const
+{
+  checkpoint.put(_offset);
+  checkpoint.put(_geometryOffset);
+  checkpoint.put(_topologyOffset);
+  checkpoint.putVector(_fieldsOffset);
+  checkpoint.putVector(_times);
+}
+
+void XDMFWriter::Resume(const Mesh* mesh, const std::string& resultsDir, const std::string& name, Checkpoint& checkpoint)
+{
+  _mesh = mesh;
+  _heavyFileName = name + ".bin";
+  _indexFileName = resultsDir + "/" + name + ".xmf";
+  _offset = checkpoint.get<long long>();
+  _geometryOffset = checkpoint.get<long long>();
+  _topologyOffset = checkpoint.get<long long>();
+  checkpoint.getVector(_fieldsOffset);
+  checkpoint.getVector(_times);
+
+  // Snapshots written after the checkpoint are dropped
+  _heavyFile.close();
+  truncateFile(resultsDir + "/" + _heavyFileName, _offset);
+  _heavyFile.open(resultsDir + "/" + _heavyFileName, std::ios::out | std::ios::binary | std::ios::app);
+  _indexFile.close();
+  if (_times.size() > 0)
+    {
+      writeIndex();
+    }
+}
+
+void XDMFWriter::append(const void* data, long long size)
+{
+  _heavyFile.write(static_cast<const char*>(data), size);
+  _offset += size;
+}
+
+// Sommets (x,y) puis connectivité des cellules
+void XDMFWriter::writeMesh()
+{
+  if (!_heavyFile.is_open())
+    {
+      std::cout << termcolor::red << "ERROR::XDMF : Unable to open the file " << _heavyFileName << std::endl;
+      std::cout << termcolor::reset;
+      exit(-1);
+    }
+
+  int nbVertices(_mesh->getNumberOfVertices());
+  std::vector<double> coordinates(2 * nbVertices);
+  for (int i(0) ; i < nbVertices ; ++i)
+    {
+      coordinates[2*i] = _mesh->getVertices()[i].getCoordinates()(0);
+      coordinates[2*i+1] = _mesh->getVertices()[i].getCoordinates()(1);
+    }
+  _geometryOffset = _offset;
+  append(coordinates.data(), coordinates.size() * sizeof(double));
+
+  int nbCells(_mesh->getNumberOfCells());
+  const std::vector<int>& fileOrder(_mesh->getCellsFileOrder());
+  const Eigen::VectorXi& cellsVerticesOffsets(_mesh->getCellsVerticesOffsets());
+  const Eigen::VectorXi& cellsVertices(_mesh->getCellsVertices());
+  std::vector<int> connectivity;
+  connectivity.reserve(cellsVertices.size());
+  for (int i(0) ; i < nbCells ; ++i)
+    {
+      for (int j(cellsVerticesOffsets(fileOrder[i])) ; j < cellsVerticesOffsets(fileOrder[i]+1) ; ++j)
+        {
+          connectivity.push_back(cellsVertices(j));
+        }
+    }
+  _topologyOffset = _offset;
+  append(connectivity.data(), connectivity.size() * sizeof(int));
+}
+
+// Hauteur d'eau puis vitesse (u,v,0) de chaque cellule
+void XDMFWriter::writeSnapshot(double time, const StateMatrix& Sol)
+{
+  if (_times.size() == 0)
+    {
+      writeMesh();
+    }
+
+  int nbCells(_mesh->getNumberOfCells());
+  const std::vector<int>& fileOrder(_mesh->getCellsFileOrder());
+  _buffer.resize(4 * nbCells);
+  for (int i(0) ; i < nbCells ; ++i)
+    {
+      int c(fileOrder[i]);
+      _buffer[i] = Sol(c,0);
+      _buffer[nbCells + 3*i] = Sol(c,1)/Sol(c,0);
+      _buffer[nbCells + 3*i+1] = Sol(c,2)/Sol(c,0);
+      _buffer[nbCells + 3*i+2] = 0.;
+    }
+  _fieldsOffset.push_back(_offset);
+  _times.push_back(time);
+  append(_buffer.data(), _buffer.size() * sizeof(double));
+  _heavyFile.flush();
+
+  if (_indexFile.is_open())
+    {
+      appendToIndex();
+    }
+  else
+    {
+      writeIndex();
+    }
+}
+
+void XDMFWriter::writeIndex()
+{
+  _indexFile.close();
+  _indexFile.open(_indexFileName, std::ios::in | std::ios::out | std::ios::trunc);
+  if (!_indexFile.is_open())
+    {
+      std::cout << termcolor::red << "ERROR::XDMF : Unable to open the file " << _indexFileName << std::endl;
+      std::cout << termcolor::reset;
+      exit(-1);
+    }
+  _indexFile.precision(17);
+  _indexFile << "<?xml version=\"1.0\" ?>\n";
+  _indexFile << "<Xdmf Version=\"3.0\">\n";
+  _indexFile << "<Domain>\n";
+  _indexFile << "<Grid Name=\"TimeSeries\" GridType=\"Collection\" CollectionType=\"Temporal\">\n";
+  for (std::size_t n(0) ; n < _times.size() ; ++n)
+    {
+      writeGrid(n);
+    }
+  writeFooter();
+}
+
+// Les balises fermantes sont écrasées par la nouvelle Grid
+void XDMFWriter::appendToIndex()
+{
+  _indexFile.seekp(_indexFooterPosition);
+  writeGrid(_times.size() - 1);
+  writeFooter();
+}
+
+void XDMFWriter::writeFooter()
+{
+  _indexFooterPosition = _indexFile.tellp();
+  _indexFile << "</Grid>\n";
+  _indexFile << "</Domain>\n";
+  _indexFile << "</Xdmf>\n";
+  _indexFile.flush();
+}
+
+void XDMFWriter::writeGrid(int n)
+{
+  int nbVertices(_mesh->getNumberOfVertices());
+  int nbCells(_mesh->getNumberOfCells());
+  int nbVerticesPCell(_mesh->getNumberOfVerticesPerCell());
+  std::string topologyType(nbVerticesPCell == 3 ? "Triangle" : "Quadrilateral");
+  // Boutisme de la machine (les tableaux sont écrits tels quels)
+  int one(1);
+  std::string endian(*reinterpret_cast<const char*>(&one) == 1 ? "Little" : "Big");
+  std::string binary("Format=\"Binary\" Endian=\"" + endian + "\"");
+
+  std::fstream& index(_indexFile);
+  index << "  <Grid Name=\"solution_" << n << "\" GridType=\"Uniform\">\n";
+  index << "    <Time Value=\"" << _times[n] << "\"/>\n";
+  index << "    <Topology TopologyType=\"" << topologyType << "\" NumberOfElements=\"" << nbCells << "\">\n";
+  index << "      <DataItem Dimensions=\"" << nbCells << " " << nbVerticesPCell << "\" NumberType=\"Int\" Precision=\"4\" "
+        << binary << " Seek=\"" << _topologyOffset << "\">" << _heavyFileName << "</DataItem>\n";
+  index << "    </Topology>\n";
+  index << "    <Geometry GeometryType=\"XY\">\n";
+  index << "      <DataItem Dimensions=\"" << nbVertices << " 2\" NumberType=\"Float\" Precision=\"8\" "
+        << binary << " Seek=\"" << _geometryOffset << "\">" << _heavyFileName << "</DataItem>\n";
+  index << "    </Geometry>\n";
+  index << "    <Attribute Name=\"h\" AttributeType=\"Scalar\" Center=\"Cell\">\n";
+  index << "      <DataItem Dimensions=\"" << nbCells << "\" NumberType=\"Float\" Precision=\"8\" "
+        << binary << " Seek=\"" << _fieldsOffset[n] << "\">" << _heavyFileName << "</DataItem>\n";
+  index << "    </Attribute>\n";
+  index << "    <Attribute Name=\"vel\" AttributeType=\"Vector\" Center=\"Cell\">\n";
+  index << "      <DataItem Dimensions=\"" << nbCells << " 3\" NumberType=\"Float\" Precision=\"8\" "
+        << binary << " Seek=\"" << _fieldsOffset[n] + (long long)nbCells * sizeof(double) << "\">" << _heavyFileName << "</DataItem>\n";
+  index << "    </Attribute>\n";
+  index << "  </Grid>\n";
+}
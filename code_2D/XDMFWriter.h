@@ -0,0 +1,103 @@
+/*!
+ * @file XDMFWriter.h
+ *
+ * Defines an XDMF writer for the solution (raw binary data + XML index).
+ *
+ * @authors Gabriel Suau, Remi Pegouret, Lucas Trautmann
+ *
+ * @version 0.1.0
+ *
+ * @copyright © 2021 Gabriel Suau
+ * @copyright © 2021 Remi Pegouret
+ * @copyright © 2021 Lucas Trautmann
+ * 
+ * @copyright This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * @copyright You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef XDMF_WRITER_H
+#define XDMF_WRITER_H
+
+#include "Mesh.h"
+#include "Layout.h"
+#include "Checkpoint.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Writes the solution as an XDMF time series readable by ParaView :
+//   - <name>.bin : raw binary data. The mesh (vertices and cells) is written
+//     once, then h and the velocity are appended for each snapshot.
+//   - <name>.xmf : small XML index pointing into <name>.bin. It is kept open
+//     and each snapshot overwrites the closing tags with its own <Grid>, so
+//     that the index is always valid, even if the run stops.
+// The cells are written in the order of the mesh file.
+class XDMFWriter
+{
+private:
+  // Maillage
+  const Mesh* _mesh;
+
+  // Fichiers de sortie
+  std::string _heavyFileName;
+  std::string _indexFileName;
+  std::ofstream _heavyFile;
+  std::fstream _indexFile;
+  // Position des balises fermantes dans l'index
+  std::streamoff _indexFooterPosition;
+
+  // Position (en octets) des données dans le fichier binaire
+  long long _offset;
+  long long _geometryOffset;
+  long long _topologyOffset;
+  std::vector<long long> _fieldsOffset;
+  std::vector<double> _times;
+
+  // Buffer des champs d'une sauvegarde
+  std::vector<double> _buffer;
+
+public:
+  // Constructeurs
+  XDMFWriter();
+  XDMFWriter(const Mesh* mesh, const std::string& resultsDir, const std::string& name);
+
+  // Destructeur
+  ~XDMFWriter() = default;
+
+  // Initialisation
+  void Initialize(const Mesh* mesh, const std::string& resultsDir, const std::string& name);
+
+  // Save the solution at time t
+  void writeSnapshot(double time, const StateMatrix& Sol);
+
+  // Checkpoint/restart : state of the output files. Resume reopens the
+  // existing files, brought back to their state at the checkpoint.
+  void writeCheckpoint(Checkpoint& checkpoint) const;
+  void Resume(const Mesh* mesh, const std::string& resultsDir, const std::string& name, Checkpoint& checkpoint);
+
+protected:
+  // Write the mesh in the binary file (first snapshot)
+  void writeMesh();
+  // Write the whole XML index (first snapshot or restart)
+  void writeIndex();
+  // Append the last snapshot to the XML index
+  void appendToIndex();
+  // Write the <Grid> of snapshot n, then the closing tags
+  void writeGrid(int n);
+  void writeFooter();
+  // Append an array to the binary file
+  void append(const void* data, long long size);
+};
+
+#endif // XDMF_WRITER_H
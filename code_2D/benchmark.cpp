@@ -0,0 +1,407 @@
+/*!
+ * @file benchmark.cpp
+ *
+ * Performance benchmarks of the 2D solver (make bench).
+ *
+ * @authors Gabriel Suau, Remi Pegouret, Lucas Trautmann
+ *
+ * @version 0.1.0
+ *
+ * @copyright © 2021 Gabriel Suau
+ * @copyright © 2021 Remi Pegouret
+ * @copyright © 2021 Lucas Trautmann
+ * 
+ * @copyright This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * @copyright This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * @copyright You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "termcolor.h"
+#include "DataFile.h"
+#include "Mesh.h"
+#include "Physics.h"
+#include "FiniteVolume.h"
+#include "TimeScheme.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Banc d'essai des performances du code 2D (make bench).
+//
+// Micro-benchmarks :
+//   - numFlux1D de Rusanov sur des états mouillés et transcritiques tirés au
+//     hasard, avec des normales quelconques, en ns par arête (le flux de
+//     Rusanov 2D ne traite pas les zones sèches),
+//   - buildFluxVector sur un maillage de 10^5 mailles, en ns par arête,
+//   - Mesh::Initialize sur des maillages de rectangle générés (sans le
+//     cache), en ns par maille.
+// Calculs complets, en mailles.pas/s : rupture de barrage à pas de temps
+// fixe de 10^3 à 10^6 mailles, sans aucune sauvegarde, avec Euler
+// explicite (damBreak) et SSP-RK3 (damBreakSSPRK3).
+//
+// Les résultats sont comparés au fichier de référence donné en argument,
+// --save le remplace par les résultats du jour. Les valeurs de référence
+// dépendent de la machine (et du nombre de threads OpenMP).
+//
+// Usage : ./benchmark [fichier_de_référence] [--save] [--max-cells N]
+
+// Working directory of the benchmarks (parameters and mesh files)
+static const std::string benchDir("bench_results");
+
+// Écart toléré avec la référence avant de signaler un changement
+static const double tolerance(0.10);
+
+struct BenchResult
+{
+  std::string name;
+  double value;
+  std::string unit;
+};
+
+// Temps moyen (s) d'un appel de f : meilleure de nRepeats mesures durant
+// chacune au moins minTime secondes
+template<class F>
+double bestTime(F f, double minTime = 0.05, int nRepeats = 5)
+{
+  typedef std::chrono::steady_clock Clock;
+  double best(1e300);
+  f();
+  for (int r(0) ; r < nRepeats ; ++r)
+    {
+      long calls(0);
+      double elapsed(0.);
+      Clock::time_point start(Clock::now());
+      do
+        {
+          f();
+          ++calls;
+          elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        }
+      while (elapsed < minTime);
+      best = std::min(best, elapsed / calls);
+    }
+  return best;
+}
+
+// Empêche le compilateur de supprimer les calculs mesurés
+static volatile double sink(0.);
+
+// Triangulated mesh of the rectangle [-1, 1] x [0, 0.5] with about nCells
+// triangles, written in the Medit format with the references 1 to 4 on the
+// bottom, right, top and left sides. Returns the name of the file.
+static std::string writeRectangleMesh(long nCells)
+{
+  int ny(std::max(1, static_cast<int>(std::round(std::sqrt(nCells / 8.)))));
+  int nx(4 * ny);
+  std::ostringstream name;
+  name << benchDir << "/rectangle_" << nCells << ".mesh";
+  std::ofstream file(name.str());
+  file << std::setprecision(12);
+  file << "MeshVersionFormatted 2\n\nDimension\n3\n\nVertices\n" << (nx + 1) * (ny + 1) << "\n";
+  for (int j(0) ; j <= ny ; ++j)
+    for (int i(0) ; i <= nx ; ++i)
+      file << -1. + 2. * i / nx << " " << 0.5 * j / ny << " 0 0\n";
+  // Numéro (à partir de 1) du sommet (i, j)
+  auto vertex = [nx](int i, int j) {return j * (nx + 1) + i + 1;};
+  file << "\nEdges\n" << 2 * (nx + ny) << "\n";
+  for (int i(0) ; i < nx ; ++i)
+    file << vertex(i, 0) << " " << vertex(i+1, 0) << " 1\n";
+  for (int j(0) ; j < ny ; ++j)
+    file << vertex(nx, j) << " " << vertex(nx, j+1) << " 2\n";
+  for (int i(0) ; i < nx ; ++i)
+    file << vertex(i+1, ny) << " " << vertex(i, ny) << " 3\n";
+  for (int j(0) ; j < ny ; ++j)
+    file << vertex(0, j+1) << " " << vertex(0, j) << " 4\n";
+  file << "\nTriangles\n" << 2 * nx * ny << "\n";
+  for (int j(0) ; j < ny ; ++j)
+    for (int i(0) ; i < nx ; ++i)
+      {
+        file << vertex(i, j) << " " << vertex(i+1, j) << " " << vertex(i+1, j+1) << " 0\n";
+        file << vertex(i, j) << " " << vertex(i+1, j+1) << " " << vertex(i, j+1) << " 0\n";
+      }
+  file << "\nEnd\n";
+  return name.str();
+}
+
+// A complete run : parameters file, mesh, physics, flux and time scheme
+struct Problem
+{
+  std::unique_ptr<DataFile> DF;
+  std::unique_ptr<Mesh> mesh;
+  std::unique_ptr<Physics> physics;
+  std::unique_ptr<FiniteVolume> finVol;
+  std::unique_ptr<TimeScheme> TS;
+};
+
+// Builds a dam break on the given mesh. The options are written in a
+// parameters file, read as in main. The logs are not displayed.
+static void buildProblem(Problem& pb, const std::string& meshFile, bool isFullRun, const std::string& timeScheme = "ExplicitEuler")
+{
+  std::string fileName(benchDir + "/bench_parameters.txt");
+  std::ofstream file(fileName);
+  file << "TimeScheme\n" << timeScheme << "\nNumericalFlux\nRusanov\n";
+  file << "MeshFile\n" << meshFile << "\nMeshRenumbering\nNone\nMeshCache\n0\n";
+  // Pas de temps fixe : CFL d'environ 0.1 sur les plus petits maillages
+  file << "InitialTime\n0.\nFinalTime\n1.\nTimeStep\n1e-5\nCFL\n1.\nAdaptiveStepping\n0\n";
+  file << "GravityAcceleration\n9.81\nResultsDir\n" << benchDir << "\nSaveFrequency\n1\nOutputFormat\nVTK\n";
+  file << "CheckpointInterval\n0\nScenario\nDamBreak\nIsTopography\n0\nTopographyType\nFlatBottom\n";
+  file << "BoundaryConditions\n4\n1 Neumann\n2 Neumann\n3 Neumann\n4 Neumann\n";
+  file.close();
+
+  std::ostringstream logs;
+  std::streambuf* coutBuffer(std::cout.rdbuf(logs.rdbuf()));
+  pb.DF.reset(new DataFile(fileName));
+  pb.DF->readDataFile();
+  pb.mesh.reset(new Mesh(pb.DF.get()));
+  pb.mesh->Initialize();
+  if (isFullRun)
+    {
+      pb.physics.reset(new Physics(pb.DF.get(), pb.mesh.get()));
+      pb.physics->Initialize();
+      pb.finVol.reset(new Rusanov(pb.DF.get(), pb.mesh.get(), pb.physics.get()));
+      if (timeScheme == "SSPRK3")
+        pb.TS.reset(new SSPRK3(pb.DF.get(), pb.mesh.get(), pb.physics.get(), pb.finVol.get()));
+      else
+        pb.TS.reset(new ExplicitEuler(pb.DF.get(), pb.mesh.get(), pb.physics.get(), pb.finVol.get()));
+    }
+  std::cout.rdbuf(coutBuffer);
+}
+
+// Micro-benchmarks of the numerical flux
+static void benchFluxes(std::vector<BenchResult>& results)
+{
+  Problem pb;
+  buildProblem(pb, writeRectangleMesh(100000), true);
+  const FiniteVolume& finVol(*pb.finVol);
+
+  // États tirés au hasard : h dans [0.5, 2], nombre de Froude dans [0, 0.8]
+  // (wet) ou [0.8, 1.2] (transcritical), directions quelconques
+  const int n(4096);
+  const double pi(acos(-1.));
+  const char* distributions[] = {"wet", "transcritical"};
+  for (const char* distribution : distributions)
+    {
+      std::mt19937 generator(12345);
+      std::uniform_real_distribution<double> uniform(0., 1.);
+      std::vector<Eigen::Vector3d> SolG(n), SolD(n);
+      std::vector<Eigen::Vector2d> normals(n);
+      for (int i(0) ; i < n ; ++i)
+        {
+          for (int side(0) ; side < 2 ; ++side)
+            {
+              double h(0.5 + 1.5 * uniform(generator));
+              double Fr(std::string(distribution) == "transcritical" ? 0.8 + 0.4 * uniform(generator) : 0.8 * uniform(generator));
+              double angle(2. * pi * uniform(generator)), u(Fr * sqrt(9.81 * h));
+              (side == 0 ? SolG : SolD)[i] = Eigen::Vector3d(h, h * u * cos(angle), h * u * sin(angle));
+            }
+          double angle(2. * pi * uniform(generator));
+          normals[i] = Eigen::Vector2d(cos(angle), sin(angle));
+        }
+      double t(bestTime([&]()
+                        {
+                          double sum(0.), waveSpeed(0.);
+                          for (int i(0) ; i < n ; ++i)
+                            {
+                              Eigen::Vector3d flux(finVol.numFlux1D(SolG[i], SolD[i], normals[i], waveSpeed));
+                              sum += flux(0) + waveSpeed;
+                            }
+                          sink = sum;
+                        }));
+      results.push_back({std::string("numFlux1D/Rusanov/") + distribution, 1e9 * t / n, "ns/edge"});
+    }
+
+  const StateMatrix& Sol(pb.physics->getInitialCondition());
+  SolverState state(pb.mesh->getNumberOfCells());
+  double t(bestTime([&]() {pb.finVol->buildFluxVector(Sol, state);}));
+  results.push_back({"buildFluxVector/Rusanov", 1e9 * t / pb.mesh->getNumberOfEdges(), "ns/edge"});
+}
+
+// Construction of the mesh from the file
+static void benchMesh(std::vector<BenchResult>& results, long maxCells)
+{
+  for (long nCells(1000) ; nCells <= maxCells ; nCells *= 10)
+    {
+      Problem pb;
+      buildProblem(pb, writeRectangleMesh(nCells), false);
+      int nRepeats(nCells < 1000000 ? 3 : 1);
+      std::ostringstream logs;
+      std::streambuf* coutBuffer(std::cout.rdbuf(logs.rdbuf()));
+      double t(bestTime([&]()
+                        {
+                          Mesh mesh(pb.DF.get());
+                          mesh.Initialize();
+                        }, 0., nRepeats));
+      std::cout.rdbuf(coutBuffer);
+      std::ostringstream name;
+      name << "Mesh::Initialize/1e" << static_cast<int>(std::round(std::log10(nCells)));
+      results.push_back({name.str(), 1e9 * t / pb.mesh->getNumberOfCells(), "ns/cell"});
+    }
+}
+
+// Complete runs : dam break, Rusanov, explicit Euler then SSP-RK3
+static void benchRuns(std::vector<BenchResult>& results, long maxCells)
+{
+  typedef std::chrono::steady_clock Clock;
+  const char* timeSchemes[] = {"ExplicitEuler", "SSPRK3"};
+  for (const char* timeScheme : timeSchemes)
+    for (long nCells(1000) ; nCells <= maxCells ; nCells *= 10)
+      {
+        Problem pb;
+        buildProblem(pb, writeRectangleMesh(nCells), true, timeScheme);
+        int nCellsMesh(pb.mesh->getNumberOfCells());
+        // Environ 5.10^6 mailles.pas par taille, 5 pas au moins. Comme dans
+        // solve, le terme source et le flux sont construits avant oneStep.
+        int nSteps(std::max(5L, 5000000L / nCells));
+        Clock::time_point start(Clock::now());
+        for (int n(0) ; n < nSteps ; ++n)
+          {
+            pb.physics->buildSourceTerm(pb.TS->getSolution(), pb.TS->getState());
+            pb.finVol->buildFluxVector(pb.TS->getSolution(), pb.TS->getState());
+            pb.TS->oneStep();
+          }
+        double elapsed(std::chrono::duration<double>(Clock::now() - start).count());
+        sink = pb.TS->getSolution()(0,0);
+        std::ostringstream name;
+        name << "damBreak" << (std::string(timeScheme) == "ExplicitEuler" ? "" : timeScheme) << "/1e" << static_cast<int>(std::round(std::log10(nCells)));
+        results.push_back({name.str(), nCellsMesh * static_cast<double>(nSteps) / elapsed, "cells.steps/s"});
+      }
+}
+
+// Reads the baseline file : one line "name value unit" per result
+static std::map<std::string, double> readBaseline(const std::string& fileName)
+{
+  std::map<std::string, double> baseline;
+  std::ifstream file(fileName);
+  std::string line;
+  while (std::getline(file, line))
+    {
+      if (line.empty() || line[0] == '#')
+        continue;
+      std::istringstream stream(line);
+      std::string name;
+      double value;
+      if (stream >> name >> value)
+        baseline[name] = value;
+    }
+  return baseline;
+}
+
+static void writeBaseline(const std::string& fileName, const std::vector<BenchResult>& results)
+{
+  std::ofstream file(fileName);
+  file << "# Résultats de référence de make bench (nom valeur unité)." << std::endl;
+  file << "# Ils dépendent de la machine : make bench-baseline pour les régénérer." << std::endl;
+  for (const BenchResult& result : results)
+    file << result.name << " " << std::setprecision(4) << result.value << " " << result.unit << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  std::string baselineFile;
+  bool save(false);
+  long maxCells(1000000);
+  for (int i(1) ; i < argc ; ++i)
+    {
+      std::string arg(argv[i]);
+      if (arg == "--save")
+        save = true;
+      else if (arg == "--max-cells" && i + 1 < argc)
+        maxCells = std::atol(argv[++i]);
+      else if (arg[0] != '-')
+        baselineFile = arg;
+      else
+        {
+          std::cout << termcolor::red << "ERROR::BENCH : Usage : " << argv[0] << " [baseline_file] [--save] [--max-cells N]" << std::endl;
+          std::cout << termcolor::reset;
+          exit(-1);
+        }
+    }
+  if (save && baselineFile.empty())
+    {
+      std::cout << termcolor::red << "ERROR::BENCH : --save needs a baseline file." << std::endl;
+      std::cout << termcolor::reset;
+      exit(-1);
+    }
+
+  system(("mkdir -p ./" + benchDir).c_str());
+
+  std::vector<BenchResult> results;
+  benchFluxes(results);
+  benchMesh(results, maxCells);
+  benchRuns(results, maxCells);
+
+  // Comparaison avec la référence : pour les temps, plus petit est mieux,
+  // pour les débits (par seconde), plus grand est mieux
+  std::map<std::string, double> baseline;
+  if (!baselineFile.empty() && !save)
+    baseline = readBaseline(baselineFile);
+  int nSlower(0), nFaster(0);
+  std::cout << std::left << std::setw(46) << "Benchmark" << std::right << std::setw(14) << "Value"
+            << "  " << std::left << std::setw(15) << "Unit" << std::right << std::setw(14) << "Baseline"
+            << std::setw(10) << "Speedup" << std::endl;
+  for (const BenchResult& result : results)
+    {
+      std::cout << std::left << std::setw(46) << result.name << std::right << std::setw(14) << std::setprecision(4)
+                << result.value << "  " << std::left << std::setw(15) << result.unit << std::right;
+      std::map<std::string, double>::const_iterator it(baseline.find(result.name));
+      if (it == baseline.end())
+        {
+          std::cout << std::setw(14) << "-" << std::setw(10) << "-" << std::endl;
+          continue;
+        }
+      bool isRate(result.unit.find("/s") != std::string::npos);
+      double speedup(isRate ? result.value / it->second : it->second / result.value);
+      std::cout << std::setw(14) << it->second << std::setw(9) << std::fixed << std::setprecision(2) << speedup << "x";
+      std::cout << std::defaultfloat;
+      if (speedup < 1. - tolerance)
+        {
+          std::cout << termcolor::red << "  SLOWER" << termcolor::reset;
+          ++nSlower;
+        }
+      else if (speedup > 1. + tolerance)
+        {
+          std::cout << termcolor::green << "  FASTER" << termcolor::reset;
+          ++nFaster;
+        }
+      std::cout << std::endl;
+    }
+
+  if (save)
+    {
+      writeBaseline(baselineFile, results);
+      std::cout << termcolor::green << "SUCCESS::BENCH : Baseline saved in " << baselineFile << std::endl;
+      std::cout << termcolor::reset;
+    }
+  else if (!baseline.empty())
+    {
+      if (nSlower > 0)
+        std::cout << termcolor::red;
+      else
+        std::cout << termcolor::green;
+      std::cout << nSlower << " benchmark(s) slower and " << nFaster << " faster than the baseline by more than "
+                << 100. * tolerance << " %." << std::endl;
+      std::cout << termcolor::reset;
+    }
+
+  return 0;
+}
@@ -33,6 +33,10 @@
 #include "TimeScheme.h"
 
 #include <iostream>
+#include <string>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 int main(int argc, char** argv)
 {
@@ -45,6 +49,17 @@ int main(int argc, char** argv)
       std::cout << termcolor::reset;
       exit(-1);
     }
+  // Restart from a checkpoint : ./main parameters.txt --restart results/checkpoint.bin
+  std::string restartFile;
+  if (argc > 3 && std::string(argv[2]) == "--restart")
+    {
+      restartFile = argv[3];
+      if (argc > 4)
+        {
+          std::cout << termcolor::yellow << "WARNING::MAIN : Too many arguments : only 3 were expected but " << argc - 1 << " were given..."<< std::endl;
+          std::cout << termcolor::reset;
+        }
+    }
   else if (argc > 2)
     {
       std::cout << termcolor::yellow << "WARNING::MAIN : Too many arguments : only 1 was expected but " << argc - 1 << " were given..."<< std::endl;
@@ -57,6 +72,9 @@ int main(int argc, char** argv)
   //-------------------------------------------------------//
   std::cout << "====================================================================================================" << std::endl;
   std::cout << "Solving 2D St-Venant equations for you !" << std::endl;
+#ifdef _OPENMP
+  std::cout << "OpenMP threads : " << omp_get_max_threads() << std::endl;
+#endif
   std::cout << "====================================================================================================" << std::endl << std::endl;
 
   
@@ -64,6 +82,7 @@ int main(int argc, char** argv)
   //---------------------Fichier de paramètres-------------//
   //-------------------------------------------------------//
   DataFile* DF = new DataFile(argv[1]);
+  DF->setRestartFile(restartFile);
   DF->readDataFile();
   DF->printData();
 
@@ -86,35 +105,32 @@ int main(int argc, char** argv)
   //--------------------------------------------------------//
   //---------------------Flux numérique---------------------//
   //--------------------------------------------------------//
-  FiniteVolume* finVol;
-  if (DF->getNumericalFlux() == "Rusanov")
+  FiniteVolume* finVol(0);
+  switch (DF->getRunPlan().numericalFlux)
     {
+    case NumericalFluxType::Rusanov:
       finVol = new Rusanov(DF, mesh, physics);
-    }
-  else if (DF->getNumericalFlux() == "HLL")
-    {
+      break;
+    case NumericalFluxType::HLL:
       finVol = new HLL(DF, mesh, physics);
-    }
-  else
-    {
-      std::cout << termcolor::red << "ERROR::FINITEVOLUME : Case not implemented." << std::endl;
-      std::cout << termcolor::reset;
-      exit(-1);
+      break;
     }
 
   //---------------------------------------------------------//
   //---------------------Schéma en temps---------------------//
   //---------------------------------------------------------//
-  TimeScheme* TS;
-  if (DF->getTimeScheme() == "ExplicitEuler")
+  TimeScheme* TS(0);
+  switch (DF->getRunPlan().timeScheme)
     {
+    case TimeSchemeType::ExplicitEuler:
       TS = new ExplicitEuler(DF, mesh, physics, finVol);
-    }
-  else
-    {
-      std::cout << termcolor::red << "ERROR::TIMESCHEME : Case not implemented." << std::endl;
-      std::cout << termcolor::reset;
-      exit(-1);
+      break;
+    case TimeSchemeType::SSPRK3:
+      TS = new SSPRK3(DF, mesh, physics, finVol);
+      break;
+    case TimeSchemeType::SSPRKs2:
+      TS = new SSPRKs2(DF, mesh, physics, finVol);
+      break;
     }
   
 